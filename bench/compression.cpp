@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        compression.cpp
+// Purpose:     Benchmark comparing bytes saved to time spent on compression
+// Author:      jay-tux
+// Created:     October 18, 2026 11:40 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <zdict.h>
+#include "protocol/message.hpp"
+#include "protocol/requests.hpp"
+#include "protocol/compression.hpp"
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+using wire = std::vector<tls::bytestream::byte>;
+
+const static std::array<std::string_view, 24> words = {
+    "hello", "there", "I", "think", "we", "should", "meet", "tomorrow", "at", "the", "office", "about", "release",
+    "build", "is", "broken", "again", "can", "you", "check", "logs", "thanks", "lol", "ok"
+};
+
+// a channel's history as the server sends it: `count` messages of a few words each
+wire chat_history(size_t count, std::mt19937 &rng) {
+  responses::channel_msg_response res;
+  for(size_t i = 0; i < count; i++) {
+    std::string cnt;
+    for(size_t n = 4 + rng() % 16; n > 0; n--) {
+      cnt += words[rng() % words.size()];
+      cnt += n == 1 ? "." : " ";
+    }
+    res.msgs.push_back({
+        .sender = static_cast<int32_t>(1 + rng() % 50),
+        .when = static_cast<uint32_t>(1700000000 + 37 * i),
+        .cnt = cnt
+    });
+  }
+  tls::bytestream out;
+  res.to().send_to(out);
+  return { out.read_start(), out.read_start() + out.size() };
+}
+
+// runs `body` `rounds` times (after a few warm-up rounds), and returns the average time per round in microseconds
+template <typename F>
+double measure(size_t rounds, F &&body) {
+  for(size_t i = 0; i < 16; i++) body();
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < rounds; i++) body();
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(rounds);
+}
+
+// compresses and decompresses the payload, and reports the size saved and the time spent on either side
+void report(const std::string &name, wire &payload, size_t rounds) {
+  tls::bytestream strm;
+  tls::bytestream scratch;
+  strm.write(payload);
+  if(!compress(strm, scratch)) {
+    std::cout << "  " << name << ": " << payload.size() << " bytes, not compressed\n";
+    return;
+  }
+  wire frame(strm.read_start(), strm.read_start() + strm.size());
+  strm.cleanse();
+
+  double packing = measure(rounds, [&]() {
+    strm.write(payload);
+    compress(strm, scratch);
+    strm.cleanse();
+  });
+  double unpacking = measure(rounds, [&]() {
+    strm.write(frame);
+    decompress(strm, scratch);
+    strm.cleanse();
+  });
+  std::cout << "  " << name << ": " << payload.size() << " -> " << frame.size() << " bytes ("
+            << 100 * frame.size() / payload.size() << "%), compress " << packing << " us, decompress " << unpacking
+            << " us\n";
+}
+
+// trains a dictionary on other channel histories (like `zstd --train` would), and loads it
+bool train_dictionary(std::mt19937 &rng) {
+  std::vector<tls::bytestream::byte> samples;
+  std::vector<size_t> sizes;
+  for(size_t i = 0; i < 1000; i++) {
+    auto sample = chat_history(20, rng);
+    samples.insert(samples.end(), sample.begin(), sample.end());
+    sizes.push_back(sample.size());
+  }
+  std::vector<char> dict(16 * 1024);
+  size_t got = ZDICT_trainFromBuffer(dict.data(), dict.size(), samples.data(), sizes.data(),
+                                     static_cast<unsigned>(sizes.size()));
+  if(ZDICT_isError(got)) return false;
+
+  auto path = (std::filesystem::temp_directory_path() / "dotchat_compression.dict").string();
+  std::ofstream(path, std::ios::binary).write(dict.data(), static_cast<std::streamsize>(got));
+  bool loaded = load_dictionary(path);
+  std::filesystem::remove(path);
+  return loaded;
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  std::mt19937 rng(42);
+  std::vector<std::pair<std::string, wire>> payloads;
+  for(size_t count : { 5, 20, 50, 200 }) {
+    payloads.emplace_back(std::to_string(count) + " msgs", chat_history(count, rng));
+  }
+
+  for(int level : { 1, 3, 9 }) {
+    compression_level() = level;
+    std::cout << "channel_msg replies, level " << level << ":\n";
+    for(auto &[name, payload] : payloads) report(name, payload, rounds);
+  }
+
+  compression_level() = 3;
+  if(!train_dictionary(rng)) {
+    std::cout << "can't train a dictionary\n";
+    return 1;
+  }
+  std::cout << "channel_msg replies, level 3 with dictionary:\n";
+  for(auto &[name, payload] : payloads) report(name, payload, rounds);
+  return 0;
+}
\ No newline at end of file
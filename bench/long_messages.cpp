@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        long_messages.cpp
+// Purpose:     Check sending long messages through a TLS connection
+// Author:      jay-tux
+// Created:     October 18, 2026 11:05 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <random>
+#include <thread>
+#include <cstdio>
+#include <stdexcept>
+#include <cstdlib>
+#include <iostream>
+#include <filesystem>
+#include "openssl/pem.h"
+#include "openssl/x509.h"
+#include "tls/tls_error.hpp"
+#include "tls/tls_context.hpp"
+#include "tls/tls_server_socket.hpp"
+#include "tls/tls_client_socket.hpp"
+#include "protocol/message.hpp"
+#include "protocol/requests.hpp"
+#include "protocol/compression.hpp"
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+// a throwaway, self-signed certificate (and its key) for localhost, both in the same PEM file
+std::string make_certificate() {
+  auto path = (std::filesystem::temp_directory_path() / "dotchat_long_messages.pem").string();
+  EVP_PKEY *key = EVP_EC_gen("P-256");
+  X509 *cert = X509_new();
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+  X509_set_pubkey(cert, key);
+  auto *name = X509_get_subject_name(cert);
+  const auto *host = reinterpret_cast<const unsigned char *>("localhost");
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, host, -1, -1, 0);
+  X509_set_issuer_name(cert, name);
+  X509_sign(cert, key, EVP_sha256());
+
+  FILE *out = std::fopen(path.c_str(), "w");
+  if(out == nullptr) throw std::runtime_error("Can't write certificate to " + path);
+  PEM_write_PrivateKey(out, key, nullptr, nullptr, 0, nullptr, nullptr);
+  PEM_write_X509(out, cert);
+  std::fclose(out);
+  X509_free(cert);
+  EVP_PKEY_free(key);
+  return path;
+}
+
+// answers each message with the same message, like the server does: in a length frame if (and only if) it came in one
+void echo(const tls::tls_server_socket &sock, size_t count) {
+  auto conn = sock.accept();
+  tls::bytestream in;
+  tls::bytestream out;
+  tls::bytestream scratch;
+  for(size_t i = 0; i < count; i++) {
+    bool framed = conn.read_into(in);
+    decompress(in, scratch);
+    message got(in);
+    got.send_to(out);
+    if(got.uses_compression()) compress(out, scratch);
+    conn.send(out, framed);
+    in.recycle();
+    scratch.recycle();
+  }
+}
+
+// sends a message with the text through the connection, and checks the echoed message still has the same text
+bool round_trip(tls::tls_connection &conn, const std::string &name, const std::string &text) {
+  requests::message_send_request req;
+  req.token = "0123456789abcdef0123456789abcdef";
+  req.chan_id = 1;
+  req.msg_cnt = text;
+  auto msg = req.to();
+  tls::bytestream strm;
+  tls::bytestream scratch;
+  msg.send_to(strm);
+  size_t raw = strm.size();
+  compress(strm, scratch);
+  size_t sent = strm.size();
+  conn.send(strm, msg.uses_length_frames());
+
+  conn.read_into(strm);
+  decompress(strm, scratch);
+  bool ok = requests::message_send_request::from(message(strm)).msg_cnt == text;
+  std::cout << "  " << name << " (" << raw << " bytes, " << sent << " bytes sent): " << (ok ? "ok" : "FAILED") << "\n";
+  return ok;
+}
+
+// a message which doesn't fit in a single TLS record can't be sent without a length frame
+bool rejects_unframed(tls::tls_connection &conn) {
+  tls::bytestream strm;
+  strm.append_space(20 * 1024);
+  bool ok = false;
+  try { conn.send(strm); }
+  catch(const tls::tls_error &) { ok = true; }
+  std::cout << "  20 KiB without length frame: " << (ok ? "rejected" : "FAILED (sent)") << "\n";
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  auto port = static_cast<uint16_t>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 42690);
+  auto pem = make_certificate();
+
+  std::mt19937 rng(42);
+  auto random_text = [&rng](size_t size) {
+    std::string res(size, '\0');
+    for(auto &c : res) c = static_cast<char>(rng());
+    return res;
+  };
+  std::string chatty;
+  while(chatty.size() < 1024 * 1024) chatty += "Hello there, this is a fairly typical chat message. ";
+
+  tls::tls_context server_ctxt(pem, pem);
+  tls::tls_server_socket sock(port, server_ctxt);
+  std::jthread server([&sock]() { echo(sock, 4); });
+
+  tls::tls_context client_ctxt(pem);
+  tls::tls_client_socket client(client_ctxt);
+  auto conn = client.connect("127.0.0.1", port);
+
+  std::cout << "long message round trips:\n";
+  bool ok = round_trip(conn, "short text        ", "Hello!");
+  ok = round_trip(conn, "64 KiB random     ", random_text(64 * 1024)) && ok;
+  ok = round_trip(conn, "4 MiB random      ", random_text(4 * 1024 * 1024)) && ok;
+  ok = round_trip(conn, "1 MiB compressible", chatty) && ok;
+  ok = rejects_unframed(conn) && ok;
+
+  std::filesystem::remove(pem);
+  return ok ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_allocs.cpp
+// Purpose:     Benchmark counting heap allocations while decoding messages
+// Author:      jay-tux
+// Created:     October 18, 2026 10:12 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "protocol/message.hpp"
+#include "protocol/requests.hpp"
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+// every heap allocation in the process goes through these
+std::atomic<size_t> heap_allocations = 0;
+
+void *operator new(size_t size) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if(void *ptr = std::malloc(size == 0 ? 1 : size); ptr != nullptr) return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t align) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  auto alignment = static_cast<size_t>(align);
+  if(void *ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment); ptr != nullptr)
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+struct result {
+  double allocations;
+  double nanoseconds;
+};
+
+// runs `body` `rounds` times (after a few warm-up rounds), and averages the allocations and time per round
+template <typename F>
+result measure(size_t rounds, F &&body) {
+  for(size_t i = 0; i < 16; i++) body();
+  size_t before = heap_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < rounds; i++) body();
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return {
+    static_cast<double>(heap_allocations.load() - before) / static_cast<double>(rounds),
+    elapsed.count() / static_cast<double>(rounds)
+  };
+}
+
+void report(const std::string &name, const result &res) {
+  std::cout << "  " << name << ": " << res.allocations << " heap allocations, " << res.nanoseconds << " ns\n";
+}
+
+// the encoded form of a channel list with 20 channels (a list of 20 sub-objects)
+std::vector<tls::bytestream::byte> channel_list_wire() {
+  responses::channel_list_response res;
+  for(int32_t i = 0; i < 20; i++) res.data.push_back({ .id = i, .name = "channel #" + std::to_string(i) });
+  tls::bytestream out;
+  res.to().send_to(out);
+  return { out.read_start(), out.read_start() + out.size() };
+}
+
+// decoding a message tree, with and without a request arena (see `dotchat::proto::arena_scope`)
+void decode_tree(size_t rounds) {
+  auto wire = channel_list_wire();
+  tls::bytestream in;
+  arena per_request;
+
+  std::cout << "decode channel_list (20 objects, " << wire.size() << " bytes):\n";
+  report("no arena", measure(rounds, [&]() {
+    in.write(wire);
+    message got(in);
+    in.recycle();
+  }));
+  report("arena   ", measure(rounds, [&]() {
+    in.write(wire);
+    {
+      arena_scope scope(per_request);
+      message got(in);
+    }
+    in.recycle();
+  }));
+}
+
+// a request as the connection thread handles it: decode it, build a reply and encode that (see `thread_conn::callback`);
+// the values are read straight from the message (`requests::message_send_request::from` copies into `std::string`s)
+void round_trip(size_t rounds) {
+  requests::message_send_request req;
+  req.token = "0123456789abcdef0123456789abcdef";
+  req.chan_id = 42;
+  req.msg_cnt = "Hello there, this is a fairly typical chat message.";
+  tls::bytestream encoded;
+  req.to().send_to(encoded);
+  std::vector<tls::bytestream::byte> wire(encoded.read_start(), encoded.read_start() + encoded.size());
+
+  auto handle = [&wire](arena &per_request, tls::bytestream &in, tls::bytestream &out) {
+    in.write(wire);
+    {
+      arena_scope scope(per_request);
+      message got(in);
+      responses::id_response reply{ {}, static_cast<int32_t>(got.map().entries().at("chan_id")) };
+      reply.to().send_to(out);
+    }
+  };
+
+  std::cout << "send_msg round trip (" << wire.size() << " bytes in):\n";
+  arena per_request;
+  report("fresh streams ", measure(rounds, [&]() {
+    tls::bytestream in;
+    tls::bytestream out;
+    handle(per_request, in, out);
+  }));
+  tls::bytestream in;
+  tls::bytestream out;
+  report("reused streams", measure(rounds, [&]() {
+    handle(per_request, in, out);
+    in.recycle();
+    out.recycle();
+  }));
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  decode_tree(rounds);
+  round_trip(rounds);
+  return 0;
+}
@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tables.cpp
+// Purpose:     Benchmark comparing lists of objects to columnar tables
+// Author:      jay-tux
+// Created:     October 18, 2026 11:58 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <iostream>
+#include "protocol/message.hpp"
+#include "protocol/requests.hpp"
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+using wire = std::vector<tls::bytestream::byte>;
+
+const static std::array<std::string_view, 12> words = {
+    "hello", "there", "we", "should", "meet", "tomorrow", "the", "build", "is", "broken", "again", "thanks"
+};
+
+// runs `body` `rounds` times (after a few warm-up rounds), and returns the average time per round in microseconds
+template <typename F>
+double measure(size_t rounds, F &&body) {
+  for(size_t i = 0; i < 16; i++) body();
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < rounds; i++) body();
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(rounds);
+}
+
+// encodes the message in version 0.5 (lists of objects) and 0.6 (tables), and reports the size and (de)coding time
+template <typename Res>
+void compare(const std::string &name, const message &msg, size_t rounds) {
+  std::cout << name << ":\n";
+  for(message::byte minor : { message::opcode_minor_version(), message::columnar_minor_version() }) {
+    message versioned = msg;
+    versioned.negotiate(0, minor);
+    tls::bytestream strm;
+    versioned.send_to(strm);
+    wire encoded(strm.read_start(), strm.read_start() + strm.size());
+
+    double encoding = measure(rounds, [&]() {
+      versioned.send_to(strm);
+      strm.cleanse();
+    });
+    arena per_request;
+    double decoding = measure(rounds, [&]() {
+      strm.write(encoded);
+      arena_scope scope(per_request);
+      message got(strm);
+    });
+    double converting = measure(rounds, [&]() {
+      strm.write(encoded);
+      arena_scope scope(per_request);
+      auto res = Res::from(message(strm));
+    });
+    bool table = minor >= message::columnar_minor_version();
+    std::cout << "  0." << static_cast<int>(minor) << (table ? " (table)" : " (list) ") << ": " << encoded.size()
+              << " bytes, encode " << encoding << " us, decode " << decoding << " us, decode + from " << converting
+              << " us\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  std::mt19937 rng(42);
+
+  responses::channel_msg_response history;
+  for(uint32_t i = 0; i < 200; i++) {
+    std::string cnt;
+    for(size_t n = 3 + rng() % 12; n > 0; n--) {
+      cnt += words[rng() % words.size()];
+      cnt += n == 1 ? "." : " ";
+    }
+    history.msgs.push_back({ .sender = static_cast<int32_t>(1 + rng() % 50), .when = 1700000000 + 37 * i, .cnt = cnt });
+  }
+  compare<responses::channel_msg_response>("channel_msg reply (200 messages)", history.to(), rounds);
+
+  responses::channel_list_response channels;
+  for(int32_t i = 0; i < 50; i++) channels.data.push_back({ .id = i, .name = "channel #" + std::to_string(i) });
+  compare<responses::channel_list_response>("channel_list reply (50 channels)", channels.to(), rounds);
+  return 0;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 # usage:    ./build.sh          build both
 #           ./build.sh s        build only server
 #           ./build.sh c        build only client
+#           ./build.sh b        build only benchmarks
 
 function build_server() {
     cd server/cmake-build-debug/
@@ -16,6 +17,12 @@ function build_client() {
     cd ../../
 }
 
+function build_bench() {
+    cd bench/cmake-build-debug/
+    cmake --build .
+    cd ../../
+}
+
 if [ "$#" = 0 ]; then
     build_server
     build_client
@@ -23,6 +30,8 @@ elif [ "$1" = "s" ]; then
     build_server
 elif [ "$1" = "c" ]; then
     build_client
+elif [ "$1" = "b" ]; then
+    build_bench
 else
-    echo 'ERROR: either no arguments (build all), `s` (build server) or `c` (build client) required.' >&1
+    echo 'ERROR: either no arguments (build all), `s` (build server), `c` (build client) or `b` (build benchmarks) required.' >&1
 fi
@@ -18,6 +18,11 @@
 #include "tls/tls_connection.hpp"
 #include "tls/tls_bytestream.hpp"
 #include "protocol/requests.hpp"
+#include "protocol/compression.hpp"
+#include <chrono>
+#include <thread>
+#include <concepts>
+#include <optional>
 #include <stdexcept>
 #include <iostream>
 
@@ -82,14 +87,55 @@ struct cli {
   template <proto::from_message_convertible Res, proto::to_message_convertible Req>
   Res run_boilerplate(const Req &r) {
     tls::bytestream strm;
-    strm << r.to();
-    conn.send(strm);
-    strm = conn.read();
-    proto::message resp(strm);
+    tls::bytestream scratch;
+    proto::message resp;
+    bool retried = false;
+    int throttled = 0;
+    if(!version_known) hello();
+    while(true) {
+      Req sent = r;
+      bool omitted = false;
+      if constexpr(std::derived_from<Req, proto::requests::token_request>) {
+        // once the connection is bound to the token's session, the server doesn't need the token anymore
+        if(server_binds_sessions() && session_token == r.token) {
+          sent.token = proto::requests::token_request::bound_token;
+          omitted = true;
+        }
+      }
+
+      auto req = sent.to();
+      req.negotiate(server_major, server_minor);
+      strm.cleanse();
+      req.send_to(strm, &conn.request_table());
+      if(req.uses_compression()) proto::compress(strm, scratch);
+      conn.send(strm, req.uses_length_frames());
+      strm = conn.read();
+      proto::decompress(strm, scratch);
+      resp = proto::message(strm);
+      // the server dropped the connection's session (e.g. after a password change); present the token once more
+      if(omitted && !retried && resp.get_command() == proto::responses::response_commands::error) {
+        retried = true;
+        session_token.reset();
+        continue;
+      }
+      // a rate limit refused the request; wait as long as the server asks (a few times at most)
+      if(throttled < 3 && resp.get_command() == proto::responses::response_commands::error) {
+        int32_t hint = 0;
+        try { hint = proto::responses::error_response::from(resp).retry_ms; } catch(const proto::proto_error &) {}
+        if(hint > 0) {
+          throttled++;
+          std::this_thread::sleep_for(std::chrono::milliseconds(hint));
+          continue;
+        }
+      }
+      break;
+    }
 
     try {
       if(resp.get_command() == proto::responses::response_commands::okay) {
-        return Res::from(resp);
+        auto res = Res::from(resp);
+        track_session(r, res);
+        return res;
       }
       else {
         std::cout << "Action failed!" << std::endl;
@@ -105,6 +151,45 @@ struct cli {
     }
   }
 
+  /**
+   * \short Learns the server's protocol version, by sending a ping in the version every server understands.
+   *
+   * A server running 0.1 closes the connection on any request with a higher version; so until the server's version is
+   * known, nothing else is sent. A server which doesn't advertise its version in the pong (or doesn't know the `ping`
+   * command at all) only supports the version of its reply.
+   */
+  void hello();
+
+  /**
+   * \short Checks whether the server binds connections to sessions (so token requests may leave out their token).
+   * \returns True if the server's version is known, and at least 0.8; otherwise false.
+   */
+  [[nodiscard]] inline bool server_binds_sessions() const {
+    return version_known && (server_major > 0 || server_minor >= proto::message::bound_session_minor_version());
+  }
+
+  /**
+   * \short Keeps track of the session the server bound the connection to, after a successful request.
+   * \tparam Res The response type.
+   * \tparam Req The request type.
+   * \param r The request which was sent.
+   * \param res The server's response.
+   */
+  template <typename Res, typename Req>
+  void track_session(const Req &r, const Res &res) {
+    if(!server_binds_sessions()) return;
+    if constexpr(std::same_as<Req, proto::requests::login_request>) {
+      session_token = res.token;
+    }
+    else if constexpr(std::same_as<Req, proto::requests::logout_request> ||
+                      std::same_as<Req, proto::requests::change_pass_request>) {
+      session_token.reset();
+    }
+    else if constexpr(std::derived_from<Req, proto::requests::token_request>) {
+      session_token = r.token;
+    }
+  }
+
   /**
    * \short Runs the event/interface loop.
    */
@@ -118,41 +203,41 @@ struct cli {
    * \short Interface and functional code to send a login request.
    * \returns The token obtained from the login process.
    */
-  int32_t send_login();
+  proto::token_t send_login();
   /**
    * \short Interface and functional code to send a log-out request.
    * \param token The token to use in the request.
    */
-  void send_logout(int32_t token);
+  void send_logout(const proto::token_t &token);
   /**
    * \short Interface and functional code to send a channel listing request.
    * \param token The token to use in the request.
    * \returns The parsed response message.
    */
-  proto::responses::channel_list_response send_channel_list(int32_t token);
+  proto::responses::channel_list_response send_channel_list(const proto::token_t &token);
   /**
    * \short Interface and functional code to send a channel message listing request.
    * \param token The token to use in the request.
    * \returns The parsed response message.
    */
-  proto::responses::channel_msg_response send_channel_message_list(int32_t token, int32_t chan_id);
+  proto::responses::channel_msg_response send_channel_message_list(const proto::token_t &token, int32_t chan_id);
   /**
    * \short Interface and functional code to send a channel details request.
    * \param token The token to use in the request.
    * \returns The parsed response message.
    */
-  proto::responses::channel_details_response send_channel_details(int32_t token, int32_t chan_id);
+  proto::responses::channel_details_response send_channel_details(const proto::token_t &token, int32_t chan_id);
   /**
    * \short Interface and functional code to send a message to a channel.
    * \param token The token to use in the request.
    * \param chan_id The ID of the channel to send the message in.
    */
-  void send_send_message(int32_t token, int32_t chan_id);
+  void send_send_message(const proto::token_t &token, int32_t chan_id);
   /**
    * \short Interface and functional code to send a request to create a new channel.
    * \param token The token to use in the request.
    */
-  void send_create_channel(int32_t token);
+  void send_create_channel(const proto::token_t &token);
   /**
    * \short Interface and functional code to send a signup request.
    */
@@ -163,12 +248,12 @@ struct cli {
    * \param uid The ID of the user whose details to request.
    * \returns The parsed response message.
    */
-  proto::responses::user_details_response send_user_details(int32_t token, int32_t uid);
+  proto::responses::user_details_response send_user_details(const proto::token_t &token, int32_t uid);
   /**
    * \short Interface and functional code to send a change password request.
    * \param token The token to use in the request.
    */
-  void send_change_pass(int32_t token);
+  void send_change_pass(const proto::token_t &token);
   /**
    * \short Interface and functional code to invite a user to a channel.
    * \param token The token to use in the request.
@@ -176,7 +261,7 @@ struct cli {
    * \param chan_id The ID of the channel to invite to.
    * \returns The parsed response message.
    */
-  void send_user_invite(int32_t token, int32_t uid, int32_t chan_id);
+  void send_user_invite(const proto::token_t &token, int32_t uid, int32_t chan_id);
 
   /**
    * \short Cleans up all resources used by the CLI.
@@ -195,6 +280,23 @@ struct cli {
    * \short The internal TLS connection.
    */
   tls::tls_connection &conn;
+  /**
+   * \short The major protocol version of the server (as far as known).
+   */
+  proto::message::byte server_major = proto::message::preferred_major_version();
+  /**
+   * \short The minor protocol version of the server (as far as known; until then, the version every server
+   * understands).
+   */
+  proto::message::byte server_minor = proto::message::initial_minor_version();
+  /**
+   * \short Whether the server's protocol version is known (see `hello`).
+   */
+  bool version_known = false;
+  /**
+   * \short The token of the session the server bound the connection to (if any).
+   */
+  std::optional<proto::token_t> session_token;
 };
 }
 
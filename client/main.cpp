@@ -1,6 +1,7 @@
 #include <string>
 #include <algorithm>
 #include "protocol/message.hpp"
+#include "protocol/compression.hpp"
 #include "cli.hpp"
 #include "tls/tls_client_socket.hpp"
 
@@ -11,11 +12,11 @@ using namespace dotchat::proto::requests;
 using namespace dotchat::proto::responses;
 
 void help(const char *invoker) {
-  std::cerr << "Usage: " << invoker << " <certificate PEM file> <IP address> <port number>" << std::endl;
+  std::cerr << "Usage: " << invoker << " <certificate PEM file> <IP address> <port number> [zstd dictionary]" << std::endl;
 }
 
 int main(int argc, const char **argv) {
-  if((argc == 2 && std::string(argv[1]) == "-h") || argc != 4) {
+  if((argc == 2 && std::string(argv[1]) == "-h") || argc < 4 || argc > 5) {
     help(argv[0]);
     return 0;
   }
@@ -23,6 +24,9 @@ int main(int argc, const char **argv) {
   std::cerr << "Attempting to connect..." << std::endl;
 
   uint16_t portno = std::stoi(std::string(argv[3]));
+  if(argc == 5 && !load_dictionary(argv[4])) {
+    std::cerr << "Failed to load compression dictionary... Continuing without dictionary..." << std::endl;
+  }
 
   try {
     auto context = tls_context(std::string(argv[1]));
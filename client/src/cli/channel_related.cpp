@@ -17,25 +17,25 @@ using namespace dotchat::proto::responses;
 using namespace dotchat::tls;
 using namespace dotchat::client;
 
-channel_list_response cli::send_channel_list(int32_t token) {
+channel_list_response cli::send_channel_list(const token_t &token) {
   return run_boilerplate<channel_list_response>(
       channel_list_request{ { .token = token } }
   );
 }
 
-channel_msg_response cli::send_channel_message_list(int32_t token, int32_t chan_id) {
+channel_msg_response cli::send_channel_message_list(const token_t &token, int32_t chan_id) {
   return run_boilerplate<channel_msg_response>(
       channel_msg_request{ { .token = token }, chan_id }
   );
 }
 
-channel_details_response cli::send_channel_details(int32_t token, int32_t chan_id) {
+channel_details_response cli::send_channel_details(const token_t &token, int32_t chan_id) {
   return run_boilerplate<channel_details_response>(
       channel_details_request{ { .token = token }, chan_id }
   );
 }
 
-void cli::send_send_message(int32_t token, int32_t chan_id) {
+void cli::send_send_message(const token_t &token, int32_t chan_id) {
   std::string msg;
   std::cout << "Message to send: ";
   std::getline(std::cin, msg);
@@ -45,7 +45,7 @@ void cli::send_send_message(int32_t token, int32_t chan_id) {
   );
 }
 
-void cli::send_create_channel(int32_t token) {
+void cli::send_create_channel(const token_t &token) {
   std::string name;
   std::string desc;
   std::cout << "Name for the new channel? ";
@@ -17,7 +17,7 @@ using namespace dotchat::proto::responses;
 using namespace dotchat::tls;
 using namespace dotchat::client;
 
-int32_t cli::send_login() {
+token_t cli::send_login() {
   std::string name;
   std::string pass;
   std::cout << "Username: ";
@@ -32,7 +32,7 @@ int32_t cli::send_login() {
   ).token;
 }
 
-void cli::send_logout(int32_t token) {
+void cli::send_logout(const token_t &token) {
   run_boilerplate<logout_response>(
       logout_request{ { .token = token } }
   );
@@ -17,13 +17,13 @@ using namespace dotchat::proto::responses;
 using namespace dotchat::tls;
 using namespace dotchat::client;
 
-user_details_response cli::send_user_details(int32_t token, int32_t uid) {
+user_details_response cli::send_user_details(const token_t &token, int32_t uid) {
   return run_boilerplate<user_details_response>(
       user_details_request{ { .token = token }, uid }
   );
 }
 
-void cli::send_change_pass(int32_t token) {
+void cli::send_change_pass(const token_t &token) {
   std::string pass1;
   std::string pass2;
   do {
@@ -42,7 +42,7 @@ void cli::send_change_pass(int32_t token) {
   );
 }
 
-void cli::send_user_invite(int32_t token, int32_t uid, int32_t chan_id) {
+void cli::send_user_invite(const token_t &token, int32_t uid, int32_t chan_id) {
   run_boilerplate<invite_user_response>(
       invite_user_request{ { .token = token }, uid, chan_id }
   );
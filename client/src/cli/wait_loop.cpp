@@ -19,6 +19,32 @@ using namespace dotchat::tls;
 using namespace dotchat::proto;
 using namespace dotchat::proto::responses;
 
+void cli::hello() {
+  auto req = requests::ping_request{}.to();
+  req.negotiate(server_major, server_minor);
+  bytestream strm;
+  bytestream scratch;
+  req.send_to(strm, &conn.request_table());
+  conn.send(strm, req.uses_length_frames());
+  strm = conn.read();
+  decompress(strm, scratch);
+  message resp(strm);
+
+  server_major = resp.major_version();
+  server_minor = resp.minor_version();
+  if(resp.get_command() == response_commands::pong) {
+    auto pong = pong_response::from(resp);
+    if(pong.major != 0 || pong.minor != 0) {
+      // the highest version both sides support
+      message both;
+      both.negotiate(pong.major, pong.minor);
+      server_major = both.major_version();
+      server_minor = both.minor_version();
+    }
+  }
+  version_known = true;
+}
+
 enum class login_action { LOGIN, SIGNUP, QUIT };
 enum class main_action { LOGOUT, CHAN_LIST, NEW_CHAN, CH_PASS, QUIT };
 enum class chan_action {
@@ -128,7 +154,7 @@ chan_action request_chan_action() {
   }
 }
 
-int32_t choose_user(cli &cli, int32_t token) {
+int32_t choose_user(cli &cli, const token_t &token) {
   int32_t uid;
   bool inv_user = true;
   do {
@@ -146,7 +172,7 @@ int32_t choose_user(cli &cli, int32_t token) {
   return uid;
 }
 
-bool run_in_channel_menu(cli &cli, int32_t token, int32_t chan_id) {
+bool run_in_channel_menu(cli &cli, const token_t &token, int32_t chan_id) {
   try {
     auto chan = cli.send_channel_details(token, chan_id);
 
@@ -193,7 +219,7 @@ bool run_in_channel_menu(cli &cli, int32_t token, int32_t chan_id) {
   }
 }
 
-bool run_channel_menu(cli &cli, int32_t token) {
+bool run_channel_menu(cli &cli, const token_t &token) {
   try {
     while(true) {
       channel_list_response list = cli.send_channel_list(token);
@@ -249,7 +275,7 @@ void cli::run_wait_loop() {
             << " -> Whenever a command is requested, you can also" << std::endl
             << "    enter `.q` to exit." << std::endl << std::endl;
   while(true) {
-    int32_t token;
+    token_t token;
 
     // step one: login or signup
     try {
@@ -0,0 +1,117 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        admin_endpoint.hpp
+// Purpose:     Local plaintext HTTP endpoint for server internals
+// Author:      jay-tux
+// Created:     October 18, 2026 11:20 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Local plaintext HTTP endpoint for server internals.
+ */
+
+#ifndef DOTCHAT_SERVER_ADMIN_ENDPOINT_HPP
+#define DOTCHAT_SERVER_ADMIN_ENDPOINT_HPP
+
+#include <map>
+#include <string>
+#include <thread>
+#include <functional>
+#include <stdexcept>
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Class representing a minimal HTTP/1.0 endpoint, bound to the loopback interface only.
+ *
+ * The endpoint only answers `GET` requests for registered paths. Each path is backed by a function generating the
+ * (plain text) body. It runs on its own thread and never touches the TLS connections.
+ */
+class admin_endpoint {
+public:
+  /**
+   * \short Structure representing an error when setting up the endpoint.
+   * \see `std::logic_error`
+   */
+  struct admin_error : std::logic_error {
+    using std::logic_error::logic_error;
+  };
+
+  /**
+   * \short Type alias for the function type generating a response body.
+   */
+  using route_t = std::function<std::string()>;
+
+  /**
+   * \short Constructs a new endpoint on a certain port (on `127.0.0.1`).
+   * \param port The port number to listen on.
+   * \throws `dotchat::server::admin_endpoint::admin_error` if the socket can't be created, bound or listened to.
+   */
+  explicit admin_endpoint(uint16_t port);
+  /**
+   * \short Admin endpoints can't be copy-initialized.
+   */
+  admin_endpoint(const admin_endpoint &) = delete;
+  /**
+   * \short Admin endpoints can't be move-initialized.
+   */
+  admin_endpoint(admin_endpoint &&) = delete;
+  /**
+   * \short Admin endpoints can't be copy-assigned.
+   */
+  admin_endpoint &operator=(const admin_endpoint &) = delete;
+  /**
+   * \short Admin endpoints can't be move-assigned.
+   */
+  admin_endpoint &operator=(admin_endpoint &&) = delete;
+
+  /**
+   * \short Registers a path. This should happen before calling `start`.
+   * \param path The path (e.g. `/metrics`).
+   * \param content_type The value for the `Content-Type` header.
+   * \param generator The function generating the response body.
+   */
+  void route(const std::string &path, std::string content_type, route_t generator);
+
+  /**
+   * \short Starts serving requests on a separate thread.
+   */
+  void start();
+
+  /**
+   * \short Stops serving requests and closes the socket.
+   */
+  ~admin_endpoint();
+
+private:
+  /**
+   * \short The serving loop.
+   * \param st The stop token for the thread.
+   */
+  void serve(const std::stop_token &st);
+  /**
+   * \short Handles a single client connection.
+   * \param client The client's socket handle.
+   */
+  void answer(int client);
+
+  /**
+   * \short The socket handle.
+   */
+  int handle;
+  /**
+   * \short The registered paths (path -> (content type, generator)).
+   */
+  std::map<std::string, std::pair<std::string, route_t>, std::less<>> routes;
+  /**
+   * \short The serving thread.
+   */
+  std::jthread runner;
+};
+}
+
+#endif //DOTCHAT_SERVER_ADMIN_ENDPOINT_HPP
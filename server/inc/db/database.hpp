@@ -20,6 +20,8 @@
 #include <type_traits>
 #include <filesystem>
 #include "types.hpp"
+#include "profiler.hpp"
+#include "maintenance.hpp"
 #include "sqlite_orm/sqlite_orm.h"
 
 #ifndef SQLITE_ORM_OPTIONAL_SUPPORTED
@@ -196,7 +198,10 @@ inline decltype(_intl_::db::storage) &database() {
   decltype(db::storage) &res = db::storage;
 
   if(!db::init_ran) [[unlikely]] {
-    if(!std::filesystem::exists(std::filesystem::path{path})) {
+    db::storage.on_open = attach_profiler;
+    bool fresh = !std::filesystem::exists(std::filesystem::path{path});
+    configure_database(path, fresh);
+    if(fresh) {
       db::storage.sync_schema();
       int user_id = res.insert(user{-1, "master", "pass"});
       int chan_id = res.insert(channel{-1, "general", user_id, "general main room"});
@@ -0,0 +1,58 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        maintenance.hpp
+// Purpose:     Database maintenance (run as background jobs)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:46 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Database maintenance (run as background jobs).
+ */
+
+#ifndef DOTCHAT_SERVER_MAINTENANCE_HPP
+#define DOTCHAT_SERVER_MAINTENANCE_HPP
+
+/**
+ * \short Namespace for all code related to the database.
+ */
+namespace dotchat::server::db {
+/**
+ * \short Switches the database to write-ahead logging, and (for a new database) to incremental vacuuming.
+ * \param file The database file.
+ * \param fresh Whether the database is new (incremental vacuuming can only be turned on before the first table is
+ * created).
+ * \throws `std::runtime_error` if the database couldn't be opened or configured.
+ *
+ * With write-ahead logging, readers don't block the writer (and vice versa), and commits don't have to sync the whole
+ * database file. The log is checkpointed in the background (see `checkpoint_database`).
+ */
+void configure_database(const char *file, bool fresh);
+
+/**
+ * \short Removes all expired session keys.
+ */
+void purge_session_keys();
+
+/**
+ * \short Updates SQLite's query planner statistics (`ANALYZE`, looking at about 1000 rows per index), and returns free
+ * pages to the file system (`PRAGMA incremental_vacuum`; only for databases created with incremental vacuuming).
+ * \throws `std::runtime_error` if the database couldn't be opened or a statement failed.
+ *
+ * The statistics are read by each connection opened afterwards.
+ */
+void optimize_database();
+
+/**
+ * \short Copies the committed pages from the write-ahead log into the database (without waiting for readers).
+ * \throws `std::runtime_error` if the database couldn't be opened or the checkpoint failed.
+ *
+ * SQLite also checkpoints automatically, but on the connection which commits (so on a request's path); checkpointing
+ * often enough in the background keeps the log below the automatic threshold.
+ */
+void checkpoint_database();
+}
+
+#endif //DOTCHAT_SERVER_MAINTENANCE_HPP
@@ -0,0 +1,169 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_cache.hpp
+// Purpose:     In-memory cache of the most recent messages per channel
+// Author:      jay-tux
+// Created:     October 18, 2026 6:40 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short In-memory cache of the most recent messages per channel.
+ */
+
+#ifndef DOTCHAT_SERVER_MESSAGE_CACHE_HPP
+#define DOTCHAT_SERVER_MESSAGE_CACHE_HPP
+
+#include <map>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <shared_mutex>
+#include "db/message_store.hpp"
+
+/**
+ * \short Namespace for all code related to the database.
+ */
+namespace dotchat::server::db {
+/**
+ * \short Gets the maximum amount of messages cached per channel.
+ * \returns A reference to the ring size (default 512).
+ */
+size_t &message_cache_ring_size();
+
+/**
+ * \short Gets the memory budget for all cached messages together (in bytes).
+ * \returns A reference to the budget (default 32 MiB).
+ */
+size_t &message_cache_budget();
+
+/**
+ * \short Singleton class caching the most recent messages of the busiest channels, in front of the message store.
+ *
+ * A channel's most recent messages are loaded into the cache when it's first read; afterwards, each message sent to it
+ * is added to its ring (dropping the oldest message once the ring is full). A read of at most `message_cache_ring_size`
+ * recent messages (see the `last` key of `channel_msg`) is served from the ring alone; a read of all messages in a
+ * channel with more messages than that still has to go to the message store for the older ones (and is counted as a
+ * `partial` hit). When all rings together exceed the memory budget, the least recently used channels are evicted.
+ */
+class message_cache {
+public:
+  /**
+   * \short Structure representing a cached message (an owned copy of a `dotchat::server::db::message_view`).
+   */
+  struct message_t {
+    int32_t id;             /*!< \short The message's ID. */
+    int32_t sender;         /*!< \short The sender's user ID. */
+    proto::now_t when;      /*!< \short Time stamp of when the message was sent. */
+    std::string content;    /*!< \short The message's contents. */
+  };
+
+  /**
+   * \short Gets the cache.
+   * \returns The singleton instance.
+   */
+  static message_cache &instance();
+
+  /**
+   * \short Appends a message to the store, and to the channel's ring if the channel is cached.
+   * \param store The message store.
+   * \param channel The ID of the channel.
+   * \param sender The sender's user ID.
+   * \param content The message's contents.
+   * \param when The time stamp of when the message was sent.
+   * \returns The message's ID.
+   */
+  int32_t append(message_store &store, int32_t channel, int32_t sender, std::string_view content, proto::now_t when);
+
+  /**
+   * \short Reads the most recent messages in a channel (oldest first), loading the channel into the cache if it's not
+   * cached yet.
+   * \param store The message store.
+   * \param channel The ID of the channel.
+   * \param last The amount of most recent messages to read (0 for all messages).
+   * \param reader The callback to invoke for each message.
+   *
+   * Each message is passed as a view into the store or the ring, without copying it; the view is only valid during
+   * the callback (which runs while the store or the ring is locked, so it shouldn't block).
+   */
+void read(message_store &store, int32_t channel, size_t last, const message_store::reader_t &reader);
+
+  /**
+   * \short Gets the amount of memory used by all cached messages together.
+   * \returns The amount of bytes.
+   */
+  [[nodiscard]] inline size_t bytes() const { return total_bytes.load(std::memory_order_relaxed); }
+
+private:
+  /**
+   * \short The cache is a singleton, so it doesn't support constructing.
+   */
+  message_cache() = default;
+
+  /**
+   * \short Structure representing the cached messages of a single channel.
+   */
+  struct channel_ring {
+    std::shared_mutex lock;               /*!< \short Lock protecting the ring (held while appending to the store). */
+    bool loaded = false;                  /*!< \short Whether the ring holds the channel's most recent messages. */
+    size_t first = 0;                     /*!< \short The index (within the channel) of the first cached message. */
+    std::deque<message_t> ring;           /*!< \short The cached messages (oldest first). */
+    size_t bytes = 0;                     /*!< \short The memory used by the cached messages. */
+    std::list<int32_t>::iterator lru_pos; /*!< \short The channel's position in the LRU list (if loaded). */
+  };
+
+  /**
+   * \short Gets the ring for a channel (creating an empty, unloaded one if needed).
+   * \param channel The ID of the channel.
+   * \returns A reference to the ring.
+   */
+  channel_ring &ring_for(int32_t channel);
+
+  /**
+   * \short Adds a message to the end of a ring, dropping the oldest message if the ring is full.
+   * \param ring The ring (its lock should be held exclusively).
+   * \param msg The message to add.
+   */
+  void push(channel_ring &ring, message_t msg);
+
+  /**
+   * \short Marks a channel as most recently used.
+   * \param channel The ID of the channel.
+   * \param ring The channel's ring (its lock should be held).
+   */
+  void touch(int32_t channel, channel_ring &ring);
+
+  /**
+   * \short Evicts the least recently used channels (except the given one) until the cache fits in its budget.
+   * \param keep The ID of the channel which shouldn't be evicted.
+   */
+  void evict(int32_t keep);
+
+  /**
+   * \short Lock protecting the map of rings.
+   */
+  std::shared_mutex rings_lock;
+  /**
+   * \short The ring for each channel seen so far.
+   */
+  std::map<int32_t, std::unique_ptr<channel_ring>> rings;
+  /**
+   * \short Lock protecting the LRU list.
+   */
+  std::mutex lru_lock;
+  /**
+   * \short The loaded channels, most recently used first.
+   */
+  std::list<int32_t> lru;
+  /**
+   * \short The memory used by all rings together.
+   */
+  std::atomic<size_t> total_bytes = 0;
+};
+}
+
+#endif //DOTCHAT_SERVER_MESSAGE_CACHE_HPP
@@ -0,0 +1,195 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_log.hpp
+// Purpose:     Memory-mapped append-only message log
+// Author:      jay-tux
+// Created:     October 18, 2026 6:12 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Memory-mapped append-only message log.
+ */
+
+#ifndef DOTCHAT_SERVER_MESSAGE_LOG_HPP
+#define DOTCHAT_SERVER_MESSAGE_LOG_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <shared_mutex>
+#include "db/message_store.hpp"
+
+/**
+ * \short Namespace for all code related to the database.
+ */
+namespace dotchat::server::db {
+/**
+ * \short Gets the size of a new log segment (in bytes).
+ * \returns A reference to the segment size (default 8 MiB).
+ */
+size_t &message_log_segment_size();
+
+/**
+ * \short Gets the amount of messages between two entries in a channel's sparse index.
+ * \returns A reference to the index interval (default 64).
+ */
+size_t &message_log_index_interval();
+
+/**
+ * \short Gets the amount of appends to a channel after which the log is synced to disk.
+ * \returns A reference to the amount of appends (default 64).
+ */
+size_t &message_log_sync_batch();
+
+/**
+ * \short Gets the time after which a channel's unsynced appends are synced to disk.
+ * \returns A reference to the interval, in milliseconds (default 200).
+ *
+ * Each append checks the interval, and the server's `message_log_flush` job syncs all channels at the same interval.
+ */
+size_t &message_log_sync_interval_ms();
+
+/**
+ * \short Message storage backend keeping an append-only log per channel, in memory-mapped segment files.
+ *
+ * Each channel has its own directory of segments (named after the index of their first message). Messages are written
+ * using `pwrite` and read back through a read-only shared mapping of the segment, so readers get views into the mapping
+ * instead of copies (though the `dotchat::server::db::message_cache` copies each message it keeps). A sparse index
+ * (one entry every `message_log_index_interval()` messages) is rebuilt when a channel is first used, by scanning its
+ * segments; the scan stops at the first torn or corrupted record. Writes are synced in batches (see
+ * `message_log_sync_batch` and `message_log_sync_interval_ms`), so a crash may lose the last few messages.
+ */
+class message_log : public message_store {
+public:
+  /**
+   * \short Opens (or creates) the log in the given directory.
+   * \param dir The directory to store the log in.
+   */
+  explicit message_log(std::filesystem::path dir);
+
+  /**
+   * \short Copying a log is not supported.
+   */
+  message_log(const message_log &) = delete;
+  /**
+   * \short Copying a log is not supported.
+   */
+  message_log &operator=(const message_log &) = delete;
+
+  /**
+   * \short Appends a message to a channel.
+   * \param channel The ID of the channel.
+   * \param sender The sender's user ID.
+   * \param content The message's contents.
+   * \param when The time stamp of when the message was sent.
+   * \returns The message's ID (its index within the channel).
+   * \throws `std::runtime_error` if the message couldn't be written.
+   */
+  int32_t append(int32_t channel, int32_t sender, std::string_view content, proto::now_t when) override;
+
+  /**
+   * \short Reads a page of messages in a channel (oldest first), as slices of the mapped segments.
+   * \param channel The ID of the channel.
+   * \param first The index (within the channel) of the first message to read.
+   * \param count The maximum amount of messages to read.
+   * \param reader The callback to invoke for each message.
+   */
+  void read(int32_t channel, size_t first, size_t count, const reader_t &reader) override;
+
+  /**
+   * \short Gets the amount of messages in a channel.
+   * \param channel The ID of the channel.
+   * \returns The amount of messages.
+   */
+  size_t count(int32_t channel) override;
+
+  /**
+   * \short Syncs all unsynced appends to disk.
+   */
+  void flush() override;
+
+  /**
+   * \short Gets the name of this backend (for logging).
+   * \returns The backend's name (`"message_log"`).
+   */
+  [[nodiscard]] inline const char *name() const override { return "message_log"; }
+
+  /**
+   * \short Syncs the log, and unmaps and closes all segments.
+   */
+  ~message_log() override;
+
+private:
+  /**
+   * \short Structure representing a single segment file.
+   */
+  struct segment {
+    int fd;                 /*!< \short The segment's file descriptor. */
+    const uint8_t *map;     /*!< \short The read-only mapping of the segment. */
+    size_t capacity;        /*!< \short The size of the segment file (and mapping). */
+    size_t end;             /*!< \short The offset just past the last record. */
+  };
+
+  /**
+   * \short Structure representing the position of a record.
+   */
+  struct location {
+    size_t segment;         /*!< \short The index of the segment. */
+    size_t offset;          /*!< \short The offset within the segment. */
+  };
+
+  /**
+   * \short Structure representing the log of a single channel.
+   */
+  struct channel_log {
+    std::shared_mutex lock;                             /*!< \short Lock protecting the channel's log. */
+    std::filesystem::path dir;                          /*!< \short The channel's directory. */
+    std::vector<segment> segments;                      /*!< \short The channel's segments (oldest first). */
+    std::vector<location> index;                        /*!< \short The sparse index. */
+    int32_t count = 0;                                  /*!< \short The amount of messages in the channel. */
+    size_t unsynced = 0;                                /*!< \short The amount of appends since the last sync. */
+    std::chrono::steady_clock::time_point last_sync;    /*!< \short The moment of the last sync. */
+  };
+
+  /**
+   * \short Gets the log for a channel, recovering it from disk the first time it's used.
+   * \param id The ID of the channel.
+   * \returns A reference to the channel's log.
+   */
+  channel_log &channel(int32_t id);
+
+  /**
+   * \short Scans the existing segments of a channel, rebuilding its sparse index.
+   * \param log The channel's log.
+   */
+  void recover(channel_log &log);
+
+  /**
+   * \short Opens and maps a segment file, and adds it to the channel's segments.
+   * \param log The channel's log.
+   * \param first_id The index of the first message in the segment.
+   * \param capacity The size for a new segment file (0 to open an existing file).
+   * \throws `std::runtime_error` if the segment couldn't be opened or mapped.
+   */
+  void open_segment(channel_log &log, int32_t first_id, size_t capacity);
+
+  /**
+   * \short The log's directory.
+   */
+  std::filesystem::path dir;
+  /**
+   * \short Lock protecting the map of channels.
+   */
+  std::shared_mutex channels_lock;
+  /**
+   * \short The log for each channel which has been used so far.
+   */
+  std::map<int32_t, std::unique_ptr<channel_log>> channels;
+};
+}
+
+#endif //DOTCHAT_SERVER_MESSAGE_LOG_HPP
@@ -0,0 +1,121 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_store.hpp
+// Purpose:     Pluggable storage backend for chat messages
+// Author:      jay-tux
+// Created:     October 18, 2026 6:05 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Pluggable storage backend for chat messages.
+ */
+
+#ifndef DOTCHAT_SERVER_MESSAGE_STORE_HPP
+#define DOTCHAT_SERVER_MESSAGE_STORE_HPP
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include "protocol/requests.hpp"
+
+/**
+ * \short Namespace for all code related to the database.
+ */
+namespace dotchat::server::db {
+/**
+ * \short Structure representing a stored message, without copying its contents.
+ */
+struct message_view {
+  /**
+   * \short The message's ID.
+   */
+  int32_t id;
+  /**
+   * \short The sender's user ID.
+   */
+  int32_t sender;
+  /**
+   * \short Time stamp of when the message was sent.
+   */
+  proto::now_t when;
+  /**
+   * \short The message's contents (only valid during the callback it's passed to).
+   */
+  std::string_view content;
+};
+
+/**
+ * \short Interface for the storage backend holding the messages in each channel.
+ *
+ * Users, channels and their members always live in the database; only the messages (by far the most written data) can
+ * be moved to another backend (see `dotchat::server::db::use_message_log`).
+ */
+class message_store {
+public:
+  /**
+   * \short The callback type used to read messages.
+   */
+  using reader_t = std::function<void(const message_view &)>;
+
+  /**
+   * \short Appends a message to a channel.
+   * \param channel The ID of the channel.
+   * \param sender The sender's user ID.
+   * \param content The message's contents.
+   * \param when The time stamp of when the message was sent.
+   * \returns The message's ID.
+   */
+  virtual int32_t append(int32_t channel, int32_t sender, std::string_view content, proto::now_t when) = 0;
+
+  /**
+   * \short Reads a page of messages in a channel (oldest first).
+   * \param channel The ID of the channel.
+   * \param first The index (within the channel) of the first message to read.
+   * \param count The maximum amount of messages to read.
+   * \param reader The callback to invoke for each message.
+   */
+  virtual void read(int32_t channel, size_t first, size_t count, const reader_t &reader) = 0;
+
+  /**
+   * \short Gets the amount of messages in a channel.
+   * \param channel The ID of the channel.
+   * \returns The amount of messages.
+   */
+  virtual size_t count(int32_t channel) = 0;
+
+  /**
+   * \short Makes sure all appended messages are durable.
+   */
+  virtual void flush() {}
+
+  /**
+   * \short Gets the name of this backend (for logging).
+   * \returns The backend's name.
+   */
+  [[nodiscard]] virtual const char *name() const = 0;
+
+  /**
+   * \short Destroys the backend.
+   */
+  virtual ~message_store() = default;
+};
+
+/**
+ * \short Gets the message storage backend in use (the database, unless `use_message_log` was called).
+ * \returns A reference to the backend.
+ */
+message_store &messages();
+
+/**
+ * \short Switches the message storage backend to a memory-mapped append-only log (see `dotchat::server::db::message_log`).
+ * \param dir The directory to store the log in.
+ *
+ * Should be called once, at startup, before any message is stored or read.
+ */
+void use_message_log(const std::string &dir);
+}
+
+#endif //DOTCHAT_SERVER_MESSAGE_STORE_HPP
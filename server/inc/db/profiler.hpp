@@ -0,0 +1,79 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        profiler.hpp
+// Purpose:     Statement profiling for the SQLite connections
+// Author:      jay-tux
+// Created:     October 18, 2026 11:52 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Statement profiling for the SQLite connections.
+ */
+
+#ifndef DOTCHAT_SERVER_PROFILER_HPP
+#define DOTCHAT_SERVER_PROFILER_HPP
+
+#include <sqlite3.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * \short Namespace for all code related to the database.
+ */
+namespace dotchat::server::db {
+/**
+ * \short Installs the statement profiler on a (freshly opened) SQLite connection.
+ * \param handle The connection handle.
+ *
+ * The profiler is invoked by SQLite itself each time a statement finishes, so it covers every query sqlite_orm runs
+ * without wrapping the individual calls in the handlers.
+ */
+void attach_profiler(sqlite3 *handle);
+
+/**
+ * \short Gets the threshold above which statements are logged as slow queries (default: 25 ms).
+ * \returns A reference to the threshold, in milliseconds.
+ *
+ * Slow queries are logged (with their query plan, and their bound parameters if `slow_query_parameters` is set) from
+ * a background thread, so logging them doesn't slow down the request any further.
+ */
+size_t &slow_query_ms_threshold();
+
+/**
+ * \short Gets whether slow queries are logged with their bound parameters filled in (default: false).
+ * \returns A reference to the flag.
+ *
+ * Even when set, statements on the `user` and `session_key` tables are logged with placeholders only, so password
+ * hashes and session keys never end up in the log.
+ */
+bool &slow_query_parameters();
+
+/**
+ * \short Structure holding the aggregate statistics for a single query shape (SQL text without bound parameters).
+ */
+struct query_stats {
+  std::string sql;                   /*!< \short The SQL text of the query (with placeholders). */
+  uint64_t count;                    /*!< \short The amount of times the query ran. */
+  uint64_t slow;                     /*!< \short The amount of times the query exceeded the slow query threshold. */
+  std::chrono::nanoseconds total;    /*!< \short The total time spent in the query. */
+  std::chrono::nanoseconds max;      /*!< \short The longest single execution of the query. */
+  std::string plan;                  /*!< \short The query plan (only known once the query was slow). */
+};
+
+/**
+ * \short Gets the statistics for each query shape seen so far.
+ * \returns The statistics, sorted by total time spent (descending).
+ */
+std::vector<query_stats> query_shapes();
+
+/**
+ * \short Formats the statistics for each query shape as a plain-text report.
+ * \returns The report.
+ */
+std::string query_report();
+}
+
+#endif //DOTCHAT_SERVER_PROFILER_HPP
@@ -23,11 +23,16 @@
  */
 namespace dotchat::server {
 /**
- * \short Reads a message from the byte stream, then chooses the correct handler and returns a response.
+ * \short Reads a message from the byte stream, then chooses the correct handler and writes its response.
  * \param in The stream to read from.
- * \returns The response message.
+ * \param out The stream to write the response frame to (compressed if the peer supports it and it's worth it).
+ * \param scratch A stream used as buffer (its contents are discarded).
+ * \param table The header table of the connection the request was read from.
+ *
+ * Responses to read-mostly commands (`channel_list` and `channel_details`) are served from the
+ * `dotchat::server::response_cache` when possible, skipping both the database and the encoding.
  */
-proto::message handle(tls::bytestream &in);
+void handle(tls::bytestream &in, tls::bytestream &out, tls::bytestream &scratch, proto::header_table &table);
 }
 
 #endif //DOTCHAT_SERVER_HANDLE_HPP
@@ -15,8 +15,11 @@
 #ifndef DOTCHAT_CLIENT_HANDLERS_HPP
 #define DOTCHAT_CLIENT_HANDLERS_HPP
 
+#include <array>
 #include "protocol/message.hpp"
 #include "protocol/requests.hpp"
+#include "protocol/commands.hpp"
+#include "threading/admission.hpp"
 
 /**
  * \short Namespace for all code related to the server.
@@ -88,6 +91,10 @@ struct handlers {
    * \short Callback for user invitation requests.
    */
   static callback_t invite_user;
+  /**
+   * \short Callback for keep-alive requests.
+   */
+  static callback_t ping;
 
   /**
    * \short Multiplexer mapping commands to their correct callbacks.
@@ -96,9 +103,43 @@ struct handlers {
 #define ADD(command) pair_t{ cmd_coll::command, command }
       ADD(login), ADD(logout), ADD(channel_list), ADD(channel_msg),
       ADD(send_msg), ADD(channel_details), ADD(new_channel),
-      ADD(new_user), ADD(change_pass), ADD(user_details), ADD(invite_user)
+      ADD(new_user), ADD(change_pass), ADD(user_details), ADD(invite_user),
+      ADD(ping)
 #undef ADD
   };
+
+  /**
+   * \short Dispatch table mapping each command opcode to (a pointer to) its callback, or `nullptr` for non-requests.
+   *
+   * Indexed by `dotchat::proto::message::get_opcode`, so dispatching a request costs one perfect hash and one table
+   * lookup, whether the client sent the command as opcode or (before protocol version 0.5) as string.
+   */
+  const static inline std::array<const callback_t *, 256> by_opcode = []() {
+    std::array<const callback_t *, 256> res{};
+#define X(id, str, val) res[val] = &id;
+    DOTCHAT_REQUEST_COMMANDS(X)
+#undef X
+    return res;
+  }();
+
+  /**
+   * \short Table mapping each command opcode to its priority lane in the admission gate (`NORMAL` for other opcodes).
+   *
+   * Cheap requests a user is waiting on are interactive; reads which load a whole channel history (`channel_msg`) or
+   * run a query per channel (`user_details`) are heavy; requests which hash a password (`login`, `new_user` and
+   * `change_pass`) wait for the hash pool, so they get a lane limited to its size.
+   */
+  const static inline std::array<request_lane, 256> lanes = []() {
+    std::array<request_lane, 256> res{};
+    res.fill(request_lane::NORMAL);
+    for(auto cmd: { proto::opcode::send_msg, proto::opcode::ping, proto::opcode::logout })
+      res[static_cast<uint8_t>(cmd)] = request_lane::INTERACTIVE;
+    for(auto cmd: { proto::opcode::channel_msg, proto::opcode::user_details })
+      res[static_cast<uint8_t>(cmd)] = request_lane::HEAVY;
+    for(auto cmd: { proto::opcode::login, proto::opcode::new_user, proto::opcode::change_pass })
+      res[static_cast<uint8_t>(cmd)] = request_lane::CREDENTIALS;
+    return res;
+  }();
 };
 }
 
@@ -19,9 +19,12 @@
 #include <exception>
 #include "protocol/message.hpp"
 #include "handlers/handlers.hpp"
+#include "handlers/session.hpp"
+#include "handlers/tokens.hpp"
 #include "db/types.hpp"
 #include "db/database.hpp"
 #include "protocol/helpers.hpp"
+#include "logging/logging.hpp"
 
 /**
  * \short Namespace for all code related to the server.
@@ -38,16 +41,43 @@ inline proto::message exc_to_message(const std::exception &e) {
 
 /**
  * \short Checks the session key.
- * \param key The session key to check.
+ * \param key The session key to check (or `dotchat::proto::requests::token_request::bound_token`).
  * \returns The user associated with the session key.
  * \throws `dotchat::proto::proto_error` if the token is invalid.
+ *
+ * If the connection is bound to a session (see `dotchat::server::connection_session`), and the key is that session's
+ * token or the bound token, nothing has to be checked. Signed tokens (see `dotchat::server::token_signer`) are checked
+ * without accessing the database; only 32-bit keys (handed out to clients before protocol version 0.9) are looked up.
+ * Either way, a valid key binds the connection to its session.
  */
-inline db::user check_session_key(int key) {
-  if(auto tmp = db::database().get_optional<db::session_key>(key); tmp.has_value() && tmp.value().valid_until >= db::now()) {
-    return db::database().get_optional<db::user>(tmp.value().user).value();
+inline session_user check_session_key(const proto::token_t &key) {
+  if(auto *session = valid_session();
+     session != nullptr && (key == proto::requests::token_request::bound_token || key == session->token)) {
+    logging::context::current().user = session->user;
+    return { session->user };
   }
+  if(key == proto::requests::token_request::bound_token)
+    throw proto_error("This connection isn't logged in (anymore). Please log-in again.");
 
-  throw proto_error("Token `" + std::to_string(key) + "` is invalid or has expired. Please log-in again.");
+  if(!proto::is_legacy_token(key)) {
+    auto claims = token_signer::instance().verify(key);
+    if(!claims.has_value()) throw proto_error("Token is invalid or has expired. Please log-in again.");
+
+    logging::context::current().user = claims->user;
+    auto left = proto::clock_t::from_time_t(claims->expires) - proto::clock_t::now();
+    bind_session(key, claims->user, db::now_plus_uncut(left));
+    return { claims->user };
+  }
+
+  auto legacy = proto::legacy_key(key);
+  if(auto tmp = db::database().get_optional<db::session_key>(legacy);
+     tmp.has_value() && tmp.value().valid_until >= db::now_uncut()) {
+    logging::context::current().user = tmp.value().user;
+    bind_session(key, tmp.value().user, tmp.value().valid_until);
+    return { tmp.value().user };
+  }
+
+  throw proto_error("Token `" + std::to_string(legacy) + "` is invalid or has expired. Please log-in again.");
 }
 
 /**
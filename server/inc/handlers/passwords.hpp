@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        passwords.hpp
+// Purpose:     Password hashing (scrypt, on the hash pool)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:31 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Password hashing (scrypt, on the hash pool).
+ */
+
+#ifndef DOTCHAT_SERVER_PASSWORDS_HPP
+#define DOTCHAT_SERVER_PASSWORDS_HPP
+
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Gets the scrypt cost parameter for new hashes, as a power of two (N = 2^log_n).
+ * \returns A reference to log2(N) (default 15).
+ */
+size_t &scrypt_log_n();
+
+/**
+ * \short Gets the scrypt block size parameter (r) for new hashes; each hash uses 128 * r * N bytes of memory.
+ * \returns A reference to r (default 8, so 32 MiB per hash by default).
+ */
+size_t &scrypt_block_size();
+
+/**
+ * \short Gets the scrypt parallelization parameter (p) for new hashes.
+ * \returns A reference to p (default 1).
+ */
+size_t &scrypt_parallelism();
+
+/**
+ * \short Hashes a password (with a random salt) on the hash pool.
+ * \param pass The password to hash.
+ * \returns The hash, in the form `$scrypt$ln=<log_n>,r=<r>,p=<p>$<salt>$<hash>` (salt and hash in base64).
+ * \throws `dotchat::proto::proto_error` if the hash pool is too busy.
+ * \throws `std::runtime_error` if generating the salt or hashing fails.
+ */
+std::string hash_password(std::string_view pass);
+
+/**
+ * \short Checks a password against a stored hash (on the hash pool).
+ * \param pass The password to check.
+ * \param stored The stored hash (or, for users created before passwords were hashed, the password itself).
+ * \returns True if the password matches, otherwise false.
+ * \throws `dotchat::proto::proto_error` if the hash pool is too busy.
+ * \throws `std::runtime_error` if hashing fails.
+ */
+bool check_password(std::string_view pass, const std::string &stored);
+
+/**
+ * \short Checks whether a stored hash should be replaced (after a successful login).
+ * \param stored The stored hash.
+ * \returns True if the password isn't hashed, or hashed with other cost parameters; otherwise false.
+ */
+bool password_outdated(const std::string &stored);
+}
+
+#endif //DOTCHAT_SERVER_PASSWORDS_HPP
@@ -0,0 +1,160 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        rate_limits.hpp
+// Purpose:     Token-bucket rate limits per connection, user and command
+// Author:      jay-tux
+// Created:     October 18, 2026 9:21 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Token-bucket rate limits per connection, user and command.
+ */
+
+#ifndef DOTCHAT_SERVER_RATE_LIMITS_HPP
+#define DOTCHAT_SERVER_RATE_LIMITS_HPP
+
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "protocol/commands.hpp"
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Structure representing a single rate limit (for a token bucket).
+ */
+struct rate_limit {
+  double per_second = 0; /*!< \short The amount of requests allowed per second, on average (0 for no limit). */
+  double burst = 0;      /*!< \short The amount of requests allowed at once (the bucket's size; at least 1). */
+};
+
+/**
+ * \short Gets the limit on all requests on a single connection.
+ * \returns A reference to the limit (default 50 per second, bursts of 100).
+ */
+rate_limit &connection_rate_limit();
+
+/**
+ * \short Gets the limit on all requests by a single user (over all of their connections).
+ * \returns A reference to the limit (default 100 per second, bursts of 200).
+ *
+ * A request only counts for its user if its connection is bound to a session (see
+ * `dotchat::server::connection_session`), so the user is known without checking the request's token.
+ */
+rate_limit &user_rate_limit();
+
+/**
+ * \short Gets the limit on a single command, per user (or per connection, for a connection without a session).
+ * \param cmd The command.
+ * \returns A reference to the limit (by default only set for commands which write to the database, or read a lot of
+ * it; `login` is limited to 1 per second, bursts of 5, to slow down guessing passwords).
+ *
+ * `login` is also limited per user name it tries, so reconnecting doesn't give a password guesser new tokens.
+ */
+rate_limit &command_rate_limit(proto::opcode cmd);
+
+/**
+ * \short Singleton class holding the token buckets for all rate limits.
+ *
+ * Each bucket holds up to `burst` tokens, and is refilled with `per_second` tokens per second; each request takes a
+ * token from each bucket it counts for (its connection, its user, its command and the account it targets). Buckets
+ * aren't refilled by a timer: a bucket is topped up (for the time since it was last used) whenever it's used. The
+ * buckets are spread over a fixed amount of shards, each with its own lock, so requests only contend when their buckets
+ * share a shard.
+ */
+class rate_limiter {
+public:
+  /**
+   * \short Gets the rate limiter.
+   * \returns The singleton instance.
+   */
+  static rate_limiter &instance();
+
+  /**
+   * \short Checks a request against all limits it counts for, and takes a token from each bucket if it's allowed.
+   * \param cmd The command of the request.
+   * \param connection The connection the request came in on.
+   * \param user The user whose session the connection is bound to (0 if it isn't bound).
+   * \param target The account the request acts on, if it's not the session's (e.g. the user name in a `login`), or
+   * empty; the command's limit then also applies per target, over all connections.
+   * \returns 0 if the request is allowed, otherwise the time after which it would be allowed.
+   *
+   * A request which is refused doesn't take any tokens.
+   */
+  std::chrono::milliseconds admit(proto::opcode cmd, uint64_t connection, int32_t user, std::string_view target = {});
+
+  /**
+   * \short Removes all buckets which have been full for a while (run as a background job).
+   * \returns The amount of removed buckets.
+   */
+  size_t purge();
+
+private:
+  /**
+   * \short The rate limiter is a singleton, so it doesn't support constructing.
+   */
+  rate_limiter() = default;
+
+  /**
+   * \short Type alias for the clock used (`std::chrono::steady_clock`).
+   */
+  using clock_t = std::chrono::steady_clock;
+
+  /**
+   * \short Structure representing a single token bucket.
+   */
+  struct bucket {
+    double tokens;            /*!< \short The amount of tokens in the bucket (at the last refill). */
+    clock_t::time_point last; /*!< \short The moment of the last refill. */
+    const rate_limit *limit;  /*!< \short The limit for the bucket. */
+  };
+
+  /**
+   * \short Structure representing a shard of the buckets.
+   */
+  struct alignas(64) shard {
+    std::mutex lock;                            /*!< \short The lock for the shard. */
+    std::unordered_map<uint64_t, bucket> table; /*!< \short The buckets in the shard. */
+  };
+
+  /**
+   * \short Takes a token from a bucket (creating a full bucket if it doesn't exist yet).
+   * \param key The key of the bucket.
+   * \param limit The limit for the bucket.
+   * \param now The current time.
+   * \returns 0 if a token was taken, otherwise the time until one is available.
+   */
+  std::chrono::milliseconds take(uint64_t key, const rate_limit &limit, clock_t::time_point now);
+
+  /**
+   * \short Puts a token back into a bucket (if another limit refused the request after all).
+   * \param key The key of the bucket.
+   */
+  void refund(uint64_t key);
+
+  /**
+   * \short Gets the shard for a bucket.
+   * \param key The key of the bucket.
+   * \returns A reference to the shard.
+   */
+  shard &shard_for(uint64_t key);
+
+  /**
+   * \short The amount of shards.
+   */
+  constexpr const static size_t shard_count = 64;
+  /**
+   * \short The shards.
+   */
+  std::array<shard, shard_count> shards;
+};
+}
+
+#endif //DOTCHAT_SERVER_RATE_LIMITS_HPP
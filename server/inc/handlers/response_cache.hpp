@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        response_cache.hpp
+// Purpose:     Cache of encoded responses for read-mostly commands
+// Author:      jay-tux
+// Created:     October 18, 2026 7:10 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Cache of encoded responses for read-mostly commands.
+ */
+
+#ifndef DOTCHAT_SERVER_RESPONSE_CACHE_HPP
+#define DOTCHAT_SERVER_RESPONSE_CACHE_HPP
+
+#include <map>
+#include <span>
+#include <memory>
+#include <vector>
+#include <compare>
+#include <cstdint>
+#include <shared_mutex>
+#include "tls/tls_bytestream.hpp"
+#include "protocol/commands.hpp"
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Gets the maximum amount of cached responses.
+ * \returns A reference to the capacity (default 4096).
+ */
+size_t &response_cache_capacity();
+
+/**
+ * \short Singleton class caching fully encoded (and possibly compressed) response frames.
+ *
+ * Each response is cached for a command, a subject (the user for `channel_list`, the channel for `channel_details`)
+ * and the protocol version it was encoded in. Each (command, subject) pair has a version number, which is bumped by
+ * `invalidate` whenever the data behind the response changes; responses cached under an older version are ignored.
+ *
+ * The cache is checked before the admission gate, so only requests whose token can be checked without the database (a
+ * signed token, or the token of the session the connection is bound to) use it; others go through the handler.
+ */
+class response_cache {
+public:
+  /**
+   * \short Structure representing the key for a cached response.
+   */
+  struct key {
+    proto::opcode cmd;  /*!< \short The command of the request. */
+    int32_t subject;    /*!< \short The user or channel the response is about. */
+    uint8_t major;      /*!< \short The major protocol version of the response. */
+    uint8_t minor;      /*!< \short The minor protocol version of the response. */
+
+    /**
+     * \short Compares two keys.
+     * \returns The ordering of both keys.
+     */
+    auto operator<=>(const key &) const = default;
+  };
+
+  /**
+   * \short Gets the cache.
+   * \returns The singleton instance.
+   */
+  static response_cache &instance();
+
+  /**
+   * \short Gets the current version of the data behind a response.
+   * \param cmd The command of the request.
+   * \param subject The user or channel the response is about.
+   * \returns The current version (should be read before reading the data the response is built from).
+   */
+  uint64_t version(proto::opcode cmd, int32_t subject);
+
+  /**
+   * \short Looks up a response, and writes it to the stream if it's cached and up-to-date.
+   * \param k The key of the response.
+   * \param user The user requesting the response (has to be in the response's audience, if it has one).
+   * \param out The stream to write the response frame to.
+   * \returns True if the response was written, otherwise false.
+   */
+  bool lookup(const key &k, int32_t user, tls::bytestream &out);
+
+  /**
+   * \short Caches a response frame.
+   * \param k The key of the response.
+   * \param version The version of the data the response was built from (see `version`).
+   * \param frame The encoded (and possibly compressed) response frame.
+   * \param audience The users who may get this response (empty if the key already decides that).
+   */
+  void store(const key &k, uint64_t version, std::span<const uint8_t> frame, std::vector<int32_t> audience);
+
+  /**
+   * \short Bumps the version of the data behind a response, invalidating all cached responses for it.
+   * \param cmd The command of the request.
+   * \param subject The user or channel the response is about.
+   *
+   * Should be called after the data is changed.
+   */
+  void invalidate(proto::opcode cmd, int32_t subject);
+
+private:
+  /**
+   * \short The cache is a singleton, so it doesn't support constructing.
+   */
+  response_cache() = default;
+
+  /**
+   * \short Structure representing a cached response.
+   */
+  struct entry {
+    uint64_t version;                                   /*!< \short The version the response was built from. */
+    std::shared_ptr<const std::vector<uint8_t>> frame;  /*!< \short The encoded response frame. */
+    std::vector<int32_t> audience;                      /*!< \short The users who may get this response (sorted). */
+  };
+
+  /**
+   * \short Lock protecting the versions and entries.
+   */
+  std::shared_mutex lock;
+  /**
+   * \short The current version for each (command, subject) pair which has been invalidated at least once.
+   */
+  std::map<std::pair<proto::opcode, int32_t>, uint64_t> versions;
+  /**
+   * \short The cached responses.
+   */
+  std::map<key, entry> entries;
+};
+}
+
+#endif //DOTCHAT_SERVER_RESPONSE_CACHE_HPP
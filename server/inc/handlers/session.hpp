@@ -0,0 +1,120 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        session.hpp
+// Purpose:     Sessions bound to connections (connection-level authentication)
+// Author:      jay-tux
+// Created:     October 18, 2026 7:58 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Sessions bound to connections (connection-level authentication).
+ */
+
+#ifndef DOTCHAT_SERVER_SESSION_HPP
+#define DOTCHAT_SERVER_SESSION_HPP
+
+#include <cstdint>
+#include "db/types.hpp"
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Structure representing the session a connection is authenticated with.
+ *
+ * A connection is bound to a session once it logs in, or once it presents a valid token; afterwards, its requests may
+ * leave out the token (see `dotchat::proto::requests::token_request::bound_token`). The binding is dropped when any
+ * connection of the same user logs out or changes the password (see `invalidate_sessions`).
+ */
+struct connection_session {
+  bool bound = false;                                     /*!< \short Whether the connection is bound to a session. */
+  proto::token_t token;                                   /*!< \short The token of the session. */
+  int32_t user = 0;                                       /*!< \short The ID of the user the session belongs to. */
+  decltype(db::session_key::valid_until) valid_until = 0; /*!< \short The moment the session expires. */
+  uint64_t generation = 0;                                /*!< \short The user's generation when it was bound. */
+  uint64_t epoch = 0;                                     /*!< \short The invalidation epoch when last checked. */
+};
+
+/**
+ * \short Structure representing the user a request is authenticated as.
+ */
+struct session_user {
+  int32_t id; /*!< \short The ID of the user. */
+};
+
+/**
+ * \short Class representing the scope in which a connection's session is the current one (for the current thread).
+ *
+ * While the scope is alive, `current_session` returns the connection's session; afterwards, the previous one.
+ */
+class session_scope {
+public:
+  /**
+   * \short Makes the session the current one.
+   * \param target The connection's session.
+   */
+  explicit session_scope(connection_session &target);
+  /**
+   * \short Session scopes can't be copied.
+   */
+  session_scope(const session_scope &) = delete;
+  /**
+   * \short Session scopes can't be moved.
+   */
+  session_scope(session_scope &&) = delete;
+  /**
+   * \short Session scopes can't be copied.
+   * \returns Nothing, session scopes can't be copied.
+   */
+  session_scope &operator=(const session_scope &) = delete;
+  /**
+   * \short Session scopes can't be moved.
+   * \returns Nothing, session scopes can't be moved.
+   */
+  session_scope &operator=(session_scope &&) = delete;
+
+  /**
+   * \short Restores the previous session.
+   */
+  ~session_scope();
+
+private:
+  /**
+   * \short The session which was current before this scope.
+   */
+  connection_session *previous;
+};
+
+/**
+ * \short Gets the session of the connection whose request is being handled on this thread.
+ * \returns A pointer to the session, or `nullptr` outside of a `session_scope`.
+ */
+connection_session *current_session();
+
+/**
+ * \short Binds the current connection (if any) to a session.
+ * \param token The token of the session.
+ * \param user The ID of the user the session belongs to.
+ * \param valid_until The moment the session expires.
+ */
+void bind_session(const proto::token_t &token, int32_t user, decltype(db::session_key::valid_until) valid_until);
+
+/**
+ * \short Checks whether the current connection is bound to a session which is still valid.
+ * \returns A pointer to the session if it's still valid, otherwise `nullptr` (and the session is unbound).
+ *
+ * As long as no session was invalidated since the last check, this only costs one atomic load (and a clock read).
+ */
+connection_session *valid_session();
+
+/**
+ * \short Drops the binding of all connections bound to a session for the given user.
+ * \param user The ID of the user (e.g. who logged out or changed their password).
+ */
+void invalidate_sessions(int32_t user);
+}
+
+#endif //DOTCHAT_SERVER_SESSION_HPP
@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tokens.hpp
+// Purpose:     Signed (stateless) session tokens
+// Author:      jay-tux
+// Created:     October 18, 2026 8:17 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Signed (stateless) session tokens.
+ */
+
+#ifndef DOTCHAT_SERVER_TOKENS_HPP
+#define DOTCHAT_SERVER_TOKENS_HPP
+
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <openssl/types.h>
+#include "protocol/requests.hpp"
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Gets how long a token stays valid after logging in.
+ * \returns A reference to the lifetime (default 24 hours).
+ */
+std::chrono::seconds &token_lifetime();
+
+/**
+ * \short Structure representing the claims carried by a signed token.
+ */
+struct token_claims {
+  int32_t user;         /*!< \short The ID of the user the token was issued to. */
+  uint32_t expires;     /*!< \short The moment the token expires (in seconds since the UNIX epoch). */
+  uint32_t serial;      /*!< \short The serial number of the token (tokens are numbered in the order they're issued). */
+};
+
+/**
+ * \short Singleton class issuing and verifying signed tokens.
+ *
+ * A signed token holds its claims (see `token_claims`) and the generation of the key it was signed with, followed by
+ * an HMAC-SHA256 (truncated to 16 bytes) over all of those. Verifying a token doesn't need the database; the only
+ * state is a small revocation list, holding the first serial number which isn't revoked for each user who logged out
+ * (or changed their password) while some of their tokens were still valid. The signing keys are generated when the
+ * server starts, so restarting the server invalidates all tokens.
+ */
+class token_signer {
+public:
+  /**
+   * \short Gets the signer.
+   * \returns The singleton instance.
+   * \throws `std::runtime_error` if the first signing key can't be set up (on first use, which the server does at
+   * startup).
+   */
+  static token_signer &instance();
+
+  /**
+   * \short Issues a new token.
+   * \param user The ID of the user to issue the token to.
+   * \returns The new token (valid for `token_lifetime`).
+   * \throws `std::runtime_error` if the token can't be signed.
+   */
+  proto::token_t issue(int32_t user);
+
+  /**
+   * \short Verifies a token.
+   * \param token The token to verify.
+   * \returns The token's claims if it's authentic, not expired and not revoked; otherwise `std::nullopt`.
+   *
+   * If the MAC can't be computed, the token is rejected.
+   */
+  std::optional<token_claims> verify(const proto::token_t &token);
+
+  /**
+   * \short Revokes all tokens issued to a user so far.
+   * \param user The ID of the user (e.g. who logged out).
+   */
+  void revoke(int32_t user);
+
+  /**
+   * \short Starts signing with a new key; tokens signed with the previous key stay valid, older ones don't.
+   * \throws `std::runtime_error` if the new key can't be set up (the current key stays in use).
+   */
+  void rotate();
+
+  /**
+   * \short Removes the users from the revocation list whose revoked tokens have all expired.
+   * \returns The amount of users removed.
+   */
+  size_t purge();
+
+private:
+  /**
+   * \short The signer is a singleton, so it doesn't support constructing.
+   */
+  token_signer();
+
+  /**
+   * \short Structure representing a signing key.
+   */
+  struct signing_key {
+    uint8_t generation;               /*!< \short The generation of the key (sent in each token). */
+    std::shared_ptr<EVP_MAC_CTX> mac; /*!< \short The HMAC context, initialized with the (random) secret key. */
+  };
+
+  /**
+   * \short Structure representing a user on the revocation list.
+   */
+  struct revocation {
+    uint32_t first_valid; /*!< \short The first serial number which isn't revoked. */
+    uint32_t until;       /*!< \short The moment the last revoked token expires (in seconds since the UNIX epoch). */
+  };
+
+  /**
+   * \short Lock protecting the keys and the revocation list.
+   */
+  std::shared_mutex lock;
+  /**
+   * \short The key new tokens are signed with.
+   */
+  signing_key current;
+  /**
+   * \short The key used before the last rotation (if any).
+   */
+  std::optional<signing_key> previous;
+  /**
+   * \short The revocation list.
+   */
+  std::unordered_map<int32_t, revocation> revoked;
+  /**
+   * \short The serial number for the next token.
+   */
+  std::atomic<uint32_t> next_serial = 0;
+};
+}
+
+#endif //DOTCHAT_SERVER_TOKENS_HPP
@@ -0,0 +1,399 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        metrics.hpp
+// Purpose:     Lock-free metric types and their registry
+// Author:      jay-tux
+// Created:     October 18, 2026 10:03 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Lock-free metric types and their registry.
+ */
+
+#ifndef DOTCHAT_SERVER_METRICS_HPP
+#define DOTCHAT_SERVER_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \short Namespace containing the server's metrics (counters, gauges and histograms).
+ *
+ * All metrics can be updated concurrently from any thread without locking. Only registration (which happens once, at
+ * start-up) and exposition take a lock.
+ */
+namespace dotchat::server::metrics {
+/**
+ * \short Base class for all metrics; takes care of registering the metric.
+ */
+class metric {
+public:
+  /**
+   * \short Metrics can't be copied (the registry holds a pointer to them).
+   */
+  metric(const metric &) = delete;
+  /**
+   * \short Metrics can't be moved (the registry holds a pointer to them).
+   */
+  metric(metric &&) = delete;
+  /**
+   * \short Metrics can't be copy-assigned.
+   */
+  metric &operator=(const metric &) = delete;
+  /**
+   * \short Metrics can't be move-assigned.
+   */
+  metric &operator=(metric &&) = delete;
+
+  /**
+   * \short Gets the name of this metric.
+   * \returns The name of this metric.
+   */
+  [[nodiscard]] inline const std::string &name() const { return _name; }
+
+  /**
+   * \short Writes this metric (including its `# HELP` and `# TYPE` lines) in the text exposition format.
+   * \param out The string to append to.
+   */
+  void expose(std::string &out) const;
+
+  /**
+   * \short Unregisters this metric.
+   */
+  virtual ~metric();
+
+protected:
+  /**
+   * \short Constructs and registers a new metric.
+   * \param name The name of the metric.
+   * \param help The help string for the metric.
+   * \param type The metric type (as used in the `# TYPE` line).
+   * \param do_register Whether to add the metric to the registry (false for children of a family).
+   */
+  metric(std::string name, std::string help, const char *type, bool do_register = true);
+
+  /**
+   * \short Writes the samples of this metric (without `# HELP` and `# TYPE` lines).
+   * \param out The string to append to.
+   * \param labels The label set to add to each sample (formatted as `key="value"`, or empty).
+   */
+  virtual void expose_samples(std::string &out, std::string_view labels) const = 0;
+
+  template <typename T> friend class family;
+
+private:
+  /**
+   * \short The name of the metric.
+   */
+  std::string _name;
+  /**
+   * \short The help string of the metric.
+   */
+  std::string _help;
+  /**
+   * \short The type of the metric.
+   */
+  const char *_type;
+  /**
+   * \short Whether this metric is in the registry.
+   */
+  bool registered;
+};
+
+/**
+ * \short Class representing a monotonically increasing counter.
+ */
+class counter : public metric {
+public:
+  /**
+   * \short Constructs and registers a new counter.
+   * \param name The name of the counter (should end in `_total`).
+   * \param help The help string of the counter.
+   * \param do_register Whether to add the counter to the registry.
+   */
+  inline counter(std::string name, std::string help, bool do_register = true) :
+      metric(std::move(name), std::move(help), "counter", do_register) {}
+
+  /**
+   * \short Increments the counter.
+   * \param by The amount to increment by.
+   */
+  inline void inc(uint64_t by = 1) { value.fetch_add(by, std::memory_order_relaxed); }
+  /**
+   * \short Gets the current value of the counter.
+   * \returns The current value.
+   */
+  [[nodiscard]] inline uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+protected:
+  void expose_samples(std::string &out, std::string_view labels) const override;
+
+private:
+  /**
+   * \short The actual value.
+   */
+  std::atomic<uint64_t> value = 0;
+};
+
+/**
+ * \short Class representing a value which can go up and down.
+ */
+class gauge : public metric {
+public:
+  /**
+   * \short Constructs and registers a new gauge.
+   * \param name The name of the gauge.
+   * \param help The help string of the gauge.
+   * \param do_register Whether to add the gauge to the registry.
+   */
+  inline gauge(std::string name, std::string help, bool do_register = true) :
+      metric(std::move(name), std::move(help), "gauge", do_register) {}
+
+  /**
+   * \short Increments the gauge.
+   * \param by The amount to increment by.
+   */
+  inline void inc(int64_t by = 1) { value.fetch_add(by, std::memory_order_relaxed); }
+  /**
+   * \short Decrements the gauge.
+   * \param by The amount to decrement by.
+   */
+  inline void dec(int64_t by = 1) { value.fetch_sub(by, std::memory_order_relaxed); }
+  /**
+   * \short Sets the gauge to a certain value.
+   * \param v The new value.
+   */
+  inline void set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+  /**
+   * \short Gets the current value of the gauge.
+   * \returns The current value.
+   */
+  [[nodiscard]] inline int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+protected:
+  void expose_samples(std::string &out, std::string_view labels) const override;
+
+private:
+  /**
+   * \short The actual value.
+   */
+  std::atomic<int64_t> value = 0;
+};
+
+/**
+ * \short Class representing a histogram with fixed buckets.
+ */
+class histogram : public metric {
+public:
+  /**
+   * \short The default buckets for latencies (in seconds; from 50us up to 10s).
+   */
+  const inline static std::initializer_list<double> latency_buckets = {
+      0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 10.0
+  };
+
+  /**
+   * \short Constructs and registers a new histogram.
+   * \param name The name of the histogram.
+   * \param help The help string of the histogram.
+   * \param bounds The upper bounds of the buckets (in ascending order; the `+Inf` bucket is added automatically).
+   * \param do_register Whether to add the histogram to the registry.
+   */
+  histogram(std::string name, std::string help, std::initializer_list<double> bounds = latency_buckets,
+            bool do_register = true);
+
+  /**
+   * \short Records a single observation.
+   * \param v The observed value.
+   */
+  void observe(double v);
+  /**
+   * \short Records a single duration (in seconds).
+   * \param d The observed duration.
+   */
+  template <typename R, typename P>
+  inline void observe(std::chrono::duration<R, P> d) {
+    observe(std::chrono::duration_cast<std::chrono::duration<double>>(d).count());
+  }
+
+  /**
+   * \short Gets the amount of observations.
+   * \returns The amount of observations so far.
+   */
+  [[nodiscard]] inline uint64_t count() const { return total.load(std::memory_order_relaxed); }
+  /**
+   * \short Gets the sum of all observations.
+   * \returns The sum of all observations so far.
+   */
+  [[nodiscard]] inline double sum() const { return _sum.load(std::memory_order_relaxed); }
+
+protected:
+  void expose_samples(std::string &out, std::string_view labels) const override;
+
+private:
+  /**
+   * \short The upper bounds of the buckets.
+   */
+  std::vector<double> bounds;
+  /**
+   * \short The (non-cumulative) counts per bucket; the last one is the `+Inf` bucket.
+   */
+  std::vector<std::atomic<uint64_t>> buckets;
+  /**
+   * \short The total amount of observations.
+   */
+  std::atomic<uint64_t> total = 0;
+  /**
+   * \short The sum of all observations.
+   */
+  std::atomic<double> _sum = 0.0;
+};
+
+/**
+ * \short Class representing a set of metrics which only differ in the value of a single label.
+ * \tparam T The metric type (`counter`, `gauge` or `histogram`).
+ *
+ * The set of label values is fixed on construction, so looking up a child is lock-free. Unknown values are mapped to
+ * the `other` child.
+ */
+template <typename T>
+class family : public metric {
+public:
+  /**
+   * \short Constructs and registers a new family.
+   * \tparam Args The types of the extra arguments for each child (e.g. histogram buckets).
+   * \param name The name of the family (and all of its children).
+   * \param help The help string.
+   * \param label The name of the label which distinguishes the children.
+   * \param values The values for the label.
+   * \param args Extra arguments passed to the constructor of each child.
+   */
+  template <typename ... Args>
+  family(const std::string &name, const std::string &help, std::string label, const std::vector<std::string> &values,
+         Args &&... args) : metric(name, help, type_of(), true), label{std::move(label)} {
+    for(const auto &v: values)
+      children.try_emplace(v, name, help, std::forward<Args>(args)..., false);
+    children.try_emplace("other", name, help, std::forward<Args>(args)..., false);
+  }
+
+  /**
+   * \short Gets the child for a certain label value.
+   * \param value The label value.
+   * \returns A reference to the child for the value (or the `other` child if the value is unknown).
+   */
+  inline T &operator[](std::string_view value) {
+    if(auto it = children.find(value); it != children.end()) return it->second;
+    return children.find("other")->second;
+  }
+
+protected:
+  void expose_samples(std::string &out, std::string_view) const override {
+    for(const auto &[value, child]: children) {
+      static_cast<const metric &>(child).expose_samples(out, label + "=\"" + value + "\"");
+    }
+  }
+
+private:
+  /**
+   * \short Gets the metric type of the children.
+   * \returns The type string for `T`.
+   */
+  static const char *type_of() {
+    if constexpr(std::same_as<T, counter>) return "counter";
+    else if constexpr(std::same_as<T, gauge>) return "gauge";
+    else return "histogram";
+  }
+
+  /**
+   * \short The name of the label.
+   */
+  std::string label;
+  /**
+   * \short The children, by label value.
+   */
+  std::map<std::string, T, std::less<>> children;
+};
+
+/**
+ * \short Singleton class holding all registered metrics.
+ */
+class registry {
+public:
+  /**
+   * \short Gets the instance.
+   * \returns The singleton instance.
+   */
+  static registry &instance();
+
+  /**
+   * \short Adds a metric to the registry.
+   * \param m The metric to add.
+   */
+  void add(const metric *m);
+  /**
+   * \short Removes a metric from the registry.
+   * \param m The metric to remove.
+   */
+  void remove(const metric *m);
+
+  /**
+   * \short Writes all metrics in the text exposition format.
+   * \returns A string containing all metrics.
+   */
+  [[nodiscard]] std::string expose();
+
+private:
+  /**
+   * \short The registry is a singleton, so it doesn't support constructing.
+   */
+  registry() = default;
+
+  /**
+   * \short A mutex protecting the set of metrics.
+   */
+  std::mutex protector;
+  /**
+   * \short All registered metrics, in order of registration.
+   */
+  std::list<const metric *> metrics;
+};
+
+/**
+ * \short RAII helper which observes the time between its construction and destruction in a histogram.
+ */
+class scoped_timer {
+public:
+  /**
+   * \short Starts the timer.
+   * \param target The histogram to record into.
+   */
+  inline explicit scoped_timer(histogram &target) : target{target}, start{std::chrono::steady_clock::now()} {}
+  /**
+   * \short Stops the timer and records the elapsed time.
+   */
+  inline ~scoped_timer() { target.observe(std::chrono::steady_clock::now() - start); }
+
+private:
+  /**
+   * \short The histogram to record into.
+   */
+  histogram &target;
+  /**
+   * \short The moment the timer was started.
+   */
+  std::chrono::steady_clock::time_point start;
+};
+}
+
+#endif //DOTCHAT_SERVER_METRICS_HPP
@@ -0,0 +1,193 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        server_metrics.hpp
+// Purpose:     The metrics exported by the server
+// Author:      jay-tux
+// Created:     October 18, 2026 11:02 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short The metrics exported by the server.
+ */
+
+#ifndef DOTCHAT_SERVER_SERVER_METRICS_HPP
+#define DOTCHAT_SERVER_SERVER_METRICS_HPP
+
+#include "metrics/metrics.hpp"
+
+/**
+ * \short Namespace containing the server's metrics (counters, gauges and histograms).
+ */
+namespace dotchat::server::metrics {
+/**
+ * \short Makes sure all server metrics are registered (so they show up before they're first used).
+ */
+void init();
+
+/**
+ * \short The amount of requests handled, per command.
+ * \returns A reference to the metric.
+ */
+family<counter> &requests();
+/**
+ * \short The time spent in the handlers, per command.
+ * \returns A reference to the metric.
+ */
+family<histogram> &handler_latency();
+/**
+ * \short The time spent executing SQL statements.
+ * \returns A reference to the metric.
+ */
+histogram &db_query_latency();
+/**
+ * \short The amount of bytes read from the TLS connections.
+ * \returns A reference to the metric.
+ */
+counter &bytes_in();
+/**
+ * \short The amount of bytes written to the TLS connections.
+ * \returns A reference to the metric.
+ */
+counter &bytes_out();
+/**
+ * \short The amount of connections currently managed by the thread manager.
+ * \returns A reference to the metric.
+ */
+gauge &active_connections();
+/**
+ * \short The time spent on the TLS handshake of new connections.
+ * \returns A reference to the metric.
+ */
+histogram &handshake_latency();
+/**
+ * \short The amount of allocations made from the arena while handling a single request.
+ * \returns A reference to the metric.
+ */
+histogram &request_allocations();
+/**
+ * \short The size of responses before compression, per command (only for responses which were compressed).
+ * \returns A reference to the metric.
+ */
+family<counter> &compression_bytes_raw();
+/**
+ * \short The size of responses after compression, per command (only for responses which were compressed).
+ * \returns A reference to the metric.
+ */
+family<counter> &compression_bytes_sent();
+/**
+ * \short The time spent compressing responses, per command (including attempts which didn't pay off).
+ * \returns A reference to the metric.
+ */
+family<histogram> &compression_latency();
+/**
+ * \short The time spent syncing the message log to disk (only when the message log is used).
+ * \returns A reference to the metric.
+ */
+histogram &message_log_sync_latency();
+/**
+ * \short The amount of channel message reads, per outcome (`hit` if the ring of the cached channel held all requested
+ * messages, `partial` if older messages were read from the message store, otherwise `miss`).
+ * \returns A reference to the metric.
+ */
+family<counter> &message_cache_requests();
+/**
+ * \short The memory used by the cached messages.
+ * \returns A reference to the metric.
+ */
+gauge &message_cache_bytes();
+/**
+ * \short The amount of cacheable requests, per outcome (`hit` if served from the response cache, otherwise `miss`).
+ * \returns A reference to the metric.
+ */
+family<counter> &response_cache_requests();
+/**
+ * \short The amount of signed token checks, per outcome (`valid`, `invalid`, `expired` or `revoked`).
+ * \returns A reference to the metric.
+ */
+family<counter> &token_checks();
+/**
+ * \short The amount of users on the token revocation list.
+ * \returns A reference to the metric.
+ */
+gauge &token_revocations();
+/**
+ * \short The amount of jobs waiting in the hash pool's queue.
+ * \returns A reference to the metric.
+ */
+gauge &hash_queue_depth();
+/**
+ * \short The time jobs spent waiting in the hash pool's queue.
+ * \returns A reference to the metric.
+ */
+histogram &hash_queue_wait();
+/**
+ * \short The time spent running password hashes (on the hash pool).
+ * \returns A reference to the metric.
+ */
+histogram &hash_latency();
+/**
+ * \short The amount of password hashes rejected because the hash pool's queue was full.
+ * \returns A reference to the metric.
+ */
+counter &hash_rejected();
+/**
+ * \short The time spent running background jobs, per job (see `dotchat::server::scheduler`).
+ * \returns A reference to the metric.
+ */
+family<histogram> &job_latency();
+/**
+ * \short The amount of background job runs which failed (threw an exception), per job.
+ * \returns A reference to the metric.
+ */
+family<counter> &job_failures();
+/**
+ * \short The amount of armed timeouts (see `dotchat::server::timeouts`).
+ * \returns A reference to the metric.
+ */
+gauge &pending_timeouts();
+/**
+ * \short The amount of connections closed because a deadline passed, per kind (`handshake` or `idle`).
+ * \returns A reference to the metric.
+ */
+family<counter> &connection_timeouts();
+/**
+ * \short The amount of requests refused by a rate limit, per command.
+ * \returns A reference to the metric.
+ */
+family<counter> &rate_limited();
+/**
+ * \short The amount of token buckets held by the rate limiter (as of the last purge).
+ * \returns A reference to the metric.
+ */
+gauge &rate_limit_buckets();
+/**
+ * \short The amount of requests being handled (see `dotchat::server::admission`).
+ * \returns A reference to the metric.
+ */
+gauge &admission_in_flight();
+/**
+ * \short The amount of requests waiting to be handled.
+ * \returns A reference to the metric.
+ */
+gauge &admission_queue_depth();
+/**
+ * \short The time requests waited before being handled (or shed), per priority lane (`interactive`, `normal`,
+ * `heavy` or `credentials`).
+ * \returns A reference to the metric.
+ */
+family<histogram> &admission_wait();
+/**
+ * \short The amount of requests shed, per reason (`queue_full`, `codel` or `deadline`).
+ * \returns A reference to the metric.
+ */
+family<counter> &admission_shed();
+/**
+ * \short The amount of errors, per kind (`protocol`, `invalid_command`, `tls` or `internal`).
+ * \returns A reference to the metric.
+ */
+family<counter> &errors();
+}
+
+#endif //DOTCHAT_SERVER_SERVER_METRICS_HPP
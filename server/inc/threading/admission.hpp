@@ -0,0 +1,308 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        admission.hpp
+// Purpose:     Admission control (load shedding) for request handlers
+// Author:      jay-tux
+// Created:     October 18, 2026 9:37 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Admission control (load shedding) for request handlers.
+ */
+
+#ifndef DOTCHAT_SERVER_ADMISSION_HPP
+#define DOTCHAT_SERVER_ADMISSION_HPP
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <condition_variable>
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Enumeration of the priority lanes requests are scheduled in (see `dotchat::server::handlers::lanes`).
+ */
+enum class request_lane : uint8_t {
+  INTERACTIVE, /*!< \short Cheap requests a user waits for (sending messages, pings, logging out). */
+  NORMAL,      /*!< \short Other requests. */
+  HEAVY,       /*!< \short Expensive reads (full channel histories, user details). */
+  CREDENTIALS  /*!< \short Requests which hash a password on the hash pool (logging in, new users, new passwords). */
+};
+
+/**
+ * \short The amount of priority lanes.
+ */
+constexpr const size_t lane_count = 4;
+
+/**
+ * \short Gets the name of a priority lane.
+ * \param lane The lane.
+ * \returns The name (`interactive`, `normal`, `heavy` or `credentials`).
+ */
+std::string lane_name(request_lane lane);
+
+/**
+ * \short Gets the weight of a priority lane: when lanes compete for slots, each gets slots in proportion to its weight.
+ * \param lane The lane.
+ * \returns A reference to the weight (default 8 for interactive, 4 for normal and credentials, and 1 for heavy
+ * requests).
+ */
+double &lane_weight(request_lane lane);
+
+/**
+ * \short Gets the maximum amount of requests of a priority lane handled at the same time (only read when the gate is
+ * first used).
+ * \param lane The lane.
+ * \returns A reference to the amount of requests (0 for no limit besides `admission_concurrency`; by default, heavy
+ * requests are limited to 2, and credentials requests to `hash_pool_threads`, so requests waiting for the hash pool
+ * don't hold slots other requests could use).
+ */
+size_t &lane_concurrency(request_lane lane);
+
+/**
+ * \short Gets the maximum amount of requests handled at the same time (only read when the gate is first used).
+ * \returns A reference to the amount of requests (default 8).
+ */
+size_t &admission_concurrency();
+
+/**
+ * \short Gets the maximum amount of requests waiting to be handled.
+ * \returns A reference to the amount of requests (default 64); further requests are refused right away.
+ */
+size_t &admission_queue_limit();
+
+/**
+ * \short Gets the target for the time a request waits before it's handled.
+ * \returns A reference to the target, in milliseconds (default 5).
+ */
+size_t &admission_target_ms();
+
+/**
+ * \short Gets the interval over which the waiting time has to stay above the target before requests are shed.
+ * \returns A reference to the interval, in milliseconds (default 100).
+ */
+size_t &admission_interval_ms();
+
+/**
+ * \short Gets the longest time a request waits before it's refused anyway.
+ * \returns A reference to the deadline, in milliseconds (default 1000).
+ */
+size_t &admission_deadline_ms();
+
+/**
+ * \short Singleton class limiting how many requests are handled at once, and shedding requests under overload.
+ *
+ * Each connection has its own thread, so without a limit every request runs its handler (and its queries) right away,
+ * and all of them slow down together when the database can't keep up. The gate lets at most `admission_concurrency`
+ * handlers run at once; other requests wait in the queue of their priority lane.
+ *
+ * When a slot frees up, it goes to a waiting request using (self-clocked) weighted fair queueing: each request is
+ * tagged with its lane's previous tag (or the tag of the last admitted request, if that's later) plus the inverse of
+ * its lane's weight, and the request with the lowest tag is admitted first. So a busy lane gets slots in proportion to
+ * its weight, an idle lane doesn't save up slots, and cheap requests don't queue behind a backlog of expensive ones.
+ * A lane with a concurrency limit (`lane_concurrency`) is skipped while it's at its limit, so heavy reads can't take
+ * all slots either.
+ *
+ * Requests are shed (refused with a "server busy" reply) in CoDel-style, separately for each lane:
+ *  - when a slot is handed out, and the waiting time of requests has been above `admission_target_ms` for at least
+ *    `admission_interval_ms`, the request at the front is shed instead; while this lasts, requests are shed more often
+ *    (the interval divided by the square root of the amount of requests shed so far), until a request has waited less
+ *    than the target; new requests still queue up meanwhile, so only the paced requests are shed;
+ *  - a request is refused right away when the queues are full (`admission_queue_limit`, over all lanes), and after
+ *    waiting for `admission_deadline_ms`.
+ */
+class admission {
+public:
+  /**
+   * \short The gate is a singleton, so it doesn't support copying.
+   */
+  admission(const admission &) = delete;
+  /**
+   * \short The gate is a singleton, so it doesn't support moving.
+   */
+  admission(admission &&) = delete;
+  /**
+   * \short The gate is a singleton, so it doesn't support copying.
+   * \returns Nothing, the gate can't be copied.
+   */
+  admission &operator=(const admission &) = delete;
+  /**
+   * \short The gate is a singleton, so it doesn't support moving.
+   * \returns Nothing, the gate can't be moved.
+   */
+  admission &operator=(admission &&) = delete;
+
+  /**
+   * \short Gets the gate.
+   * \returns The singleton instance.
+   */
+  static admission &instance();
+
+  /**
+   * \short Waits for a slot to handle a request.
+   * \param lane The request's priority lane.
+   * \returns True if the request was admitted (it should call `leave` when it's done), false if it was shed.
+   */
+  bool enter(request_lane lane);
+
+  /**
+   * \short Frees a slot, handing it to the next waiting request (or shedding waiting requests).
+   * \param lane The request's priority lane.
+   */
+  void leave(request_lane lane);
+
+private:
+  /**
+   * \short The gate is a singleton, so it doesn't support constructing.
+   */
+  admission();
+
+  /**
+   * \short Type alias for the clock used (`std::chrono::steady_clock`).
+   */
+  using clock_t = std::chrono::steady_clock;
+
+  /**
+   * \short Enumeration of the states of a waiting request.
+   */
+  enum class outcome {
+    WAITING,  /*!< \short The request is waiting for a slot. */
+    ADMITTED, /*!< \short The request was handed a slot. */
+    SHED      /*!< \short The request was shed. */
+  };
+
+  /**
+   * \short Structure representing a waiting request (lives on the waiting thread's stack).
+   */
+  struct waiter {
+    clock_t::time_point since;    /*!< \short The moment the request started waiting. */
+    double tag;                   /*!< \short The request's tag for fair queueing. */
+    std::condition_variable wake; /*!< \short Signalled when the request is admitted or shed. */
+    outcome state;                /*!< \short The state of the request. */
+  };
+
+  /**
+   * \short Structure representing the state of a priority lane.
+   */
+  struct lane_state {
+    std::deque<waiter *> queue;        /*!< \short The waiting requests (oldest first). */
+    size_t running = 0;                /*!< \short The amount of requests being handled. */
+    size_t limit = 0;                  /*!< \short The maximum of `running` (0 for no limit). */
+    double last_tag = 0;               /*!< \short The tag of the last request queued. */
+    clock_t::time_point above_since{}; /*!< \short When waiting will have been above target for an interval. */
+    bool dropping = false;             /*!< \short Whether requests are being shed. */
+    clock_t::time_point drop_next{};   /*!< \short The moment the next request will be shed. */
+    size_t drop_count = 0;             /*!< \short The amount of requests shed since shedding started. */
+  };
+
+  /**
+   * \short Checks whether a lane may start handling another request (the lock should be held).
+   * \param lane The lane.
+   * \returns True if a slot is free and the lane is below its limit, otherwise false.
+   */
+  [[nodiscard]] bool can_run(const lane_state &lane) const;
+
+  /**
+   * \short Hands free slots to waiting requests, in fair order (the lock should be held).
+   */
+  void dispatch();
+
+  /**
+   * \short Refuses a request (the lock should be held).
+   * \param reason The reason (`queue_full`, `codel` or `deadline`).
+   * \returns False.
+   */
+  bool shed(const std::string &reason);
+
+  /**
+   * \short Decides whether the request at the front of a lane should be shed (CoDel; the lock should be held).
+   * \param lane The lane.
+   * \param sojourn The time the request waited.
+   * \param now The current time.
+   * \returns True if the request should be shed, otherwise false.
+   */
+  bool should_shed(lane_state &lane, clock_t::duration sojourn, clock_t::time_point now);
+
+  /**
+   * \short Lock protecting the slots and the lanes.
+   */
+  std::mutex lock;
+  /**
+   * \short The amount of free slots.
+   */
+  size_t slots_free;
+  /**
+   * \short The amount of waiting requests (over all lanes).
+   */
+  size_t waiting = 0;
+  /**
+   * \short The tag of the last admitted request (the virtual time for fair queueing).
+   */
+  double virtual_time = 0;
+  /**
+   * \short The priority lanes.
+   */
+  std::array<lane_state, lane_count> lanes;
+};
+
+/**
+ * \short Class representing a slot in the admission gate for a request, for the duration of a scope.
+ */
+class admission_scope {
+public:
+  /**
+   * \short Waits for a slot (see `dotchat::server::admission::enter`).
+   * \param lane The request's priority lane.
+   */
+  explicit admission_scope(request_lane lane);
+  /**
+   * \short Admission scopes can't be copied.
+   */
+  admission_scope(const admission_scope &) = delete;
+  /**
+   * \short Admission scopes can't be moved.
+   */
+  admission_scope(admission_scope &&) = delete;
+  /**
+   * \short Admission scopes can't be copied.
+   * \returns Nothing, admission scopes can't be copied.
+   */
+  admission_scope &operator=(const admission_scope &) = delete;
+  /**
+   * \short Admission scopes can't be moved.
+   * \returns Nothing, admission scopes can't be moved.
+   */
+  admission_scope &operator=(admission_scope &&) = delete;
+
+  /**
+   * \short Checks whether the request was admitted.
+   * \returns True if the request was admitted, false if it was shed.
+   */
+  inline explicit operator bool() const { return admitted; }
+
+  /**
+   * \short Frees the slot (if the request was admitted).
+   */
+  ~admission_scope();
+
+private:
+  /**
+   * \short The request's priority lane.
+   */
+  request_lane lane;
+  /**
+   * \short Whether the request was admitted.
+   */
+  bool admitted;
+};
+}
+
+#endif //DOTCHAT_SERVER_ADMISSION_HPP
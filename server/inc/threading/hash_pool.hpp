@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        hash_pool.hpp
+// Purpose:     Bounded thread pool for CPU-heavy work (password hashing)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:31 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Bounded thread pool for CPU-heavy work (password hashing).
+ */
+
+#ifndef DOTCHAT_SERVER_HASH_POOL_HPP
+#define DOTCHAT_SERVER_HASH_POOL_HPP
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Gets the amount of worker threads in the hash pool (only read when the pool is first used).
+ * \returns A reference to the amount of threads (default 2).
+ */
+size_t &hash_pool_threads();
+
+/**
+ * \short Gets the maximum amount of jobs waiting in the hash pool's queue.
+ * \returns A reference to the queue capacity (default 64).
+ */
+size_t &hash_pool_queue_capacity();
+
+/**
+ * \short Singleton class representing the pool of threads running password hashes.
+ *
+ * Memory-hard password hashes take tens of milliseconds each. Running them on the connection threads would let a burst
+ * of logins take all CPU time (and memory) from the other requests; instead, they're queued for a small, fixed set of
+ * workers. A connection thread waits for its own job only, and a full queue rejects new jobs immediately.
+ */
+class hash_pool {
+public:
+  /**
+   * \short The hash pool is a singleton, so it doesn't support copying.
+   */
+  hash_pool(const hash_pool &) = delete;
+  /**
+   * \short The hash pool is a singleton, so it doesn't support moving.
+   */
+  hash_pool(hash_pool &&) = delete;
+  /**
+   * \short The hash pool is a singleton, so it doesn't support copying.
+   * \returns Nothing, the hash pool can't be copied.
+   */
+  hash_pool &operator=(const hash_pool &) = delete;
+  /**
+   * \short The hash pool is a singleton, so it doesn't support moving.
+   * \returns Nothing, the hash pool can't be moved.
+   */
+  hash_pool &operator=(hash_pool &&) = delete;
+
+  /**
+   * \short Gets the pool (starting its workers the first time).
+   * \returns The singleton instance.
+   */
+  static hash_pool &instance();
+
+  /**
+   * \short Runs a job on one of the workers, and waits for it to finish.
+   * \param job The job to run.
+   * \throws `dotchat::proto::proto_error` if the queue is full (the server is too busy).
+   * \throws Any exception thrown by the job.
+   */
+  void run(std::function<void()> job);
+
+  /**
+   * \short Stops the workers (jobs which are still queued are abandoned).
+   */
+  ~hash_pool() = default;
+
+private:
+  /**
+   * \short The hash pool is a singleton, so it doesn't support constructing.
+   */
+  hash_pool();
+
+  /**
+   * \short The loop run by each worker.
+   * \param st The worker's stop token.
+   */
+  void work(const std::stop_token &st);
+
+  /**
+   * \short Structure representing a queued job.
+   */
+  struct queued_job {
+    std::packaged_task<void()> task;                /*!< \short The job (completes the waiting thread's future). */
+    std::chrono::steady_clock::time_point queued;   /*!< \short The moment the job was queued. */
+  };
+
+  /**
+   * \short Lock protecting the queue.
+   */
+  std::mutex lock;
+  /**
+   * \short Condition variable signalling the workers that a job was queued.
+   */
+  std::condition_variable_any ready;
+  /**
+   * \short The queued jobs (oldest first).
+   */
+  std::deque<queued_job> queue;
+  /**
+   * \short The worker threads (declared last, so they're stopped before the queue is destroyed).
+   */
+  std::vector<std::jthread> workers;
+};
+}
+
+#endif //DOTCHAT_SERVER_HASH_POOL_HPP
@@ -0,0 +1,210 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        scheduler.hpp
+// Purpose:     Scheduler for background (periodic or delayed) jobs
+// Author:      jay-tux
+// Created:     October 18, 2026 8:46 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Scheduler for background (periodic or delayed) jobs.
+ */
+
+#ifndef DOTCHAT_SERVER_SCHEDULER_HPP
+#define DOTCHAT_SERVER_SCHEDULER_HPP
+
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+#include "threading/timer_wheel.hpp"
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Gets the amount of worker threads running background jobs (only read when the scheduler is first used).
+ * \returns A reference to the amount of threads (default 2).
+ */
+size_t &scheduler_threads();
+
+/**
+ * \short Gets the resolution of the scheduler (only read when the scheduler is first used).
+ * \returns A reference to the length of a tick, in milliseconds (default 10).
+ */
+size_t &scheduler_tick_ms();
+
+/**
+ * \short Singleton class running named background jobs, either periodically or once after a delay.
+ *
+ * A single timer thread advances a `timer_wheel` each tick; jobs which are due are handed to a small pool of workers,
+ * so a slow job only delays other jobs (never requests). A periodic job is never run twice at the same time: if it's
+ * still running when it's due again, that run is skipped. Each job's runtime is recorded per name (see
+ * `dotchat::server::metrics::job_latency`).
+ */
+class scheduler {
+public:
+  /**
+   * \short Type alias for a job (`std::function<void()>`).
+   */
+  using job_t = std::function<void()>;
+
+  /**
+   * \short The scheduler is a singleton, so it doesn't support copying.
+   */
+  scheduler(const scheduler &) = delete;
+  /**
+   * \short The scheduler is a singleton, so it doesn't support moving.
+   */
+  scheduler(scheduler &&) = delete;
+  /**
+   * \short The scheduler is a singleton, so it doesn't support copying.
+   * \returns Nothing, the scheduler can't be copied.
+   */
+  scheduler &operator=(const scheduler &) = delete;
+  /**
+   * \short The scheduler is a singleton, so it doesn't support moving.
+   * \returns Nothing, the scheduler can't be moved.
+   */
+  scheduler &operator=(scheduler &&) = delete;
+
+  /**
+   * \short Gets the scheduler (starting its threads the first time).
+   * \returns The singleton instance.
+   */
+  static scheduler &instance();
+
+  /**
+   * \short Schedules a periodic job (replacing any job with the same name).
+   * \param name The name of the job.
+   * \param interval The time between two runs (the first run is after one interval).
+   * \param job The job to run.
+   */
+  void every(const std::string &name, std::chrono::milliseconds interval, job_t job);
+
+  /**
+   * \short Schedules a job to run once (replacing any job with the same name).
+   * \param name The name of the job.
+   * \param delay The time after which the job runs.
+   * \param job The job to run.
+   *
+   * A job may schedule itself again (under the same name) while it's running.
+   */
+  void after(const std::string &name, std::chrono::milliseconds delay, job_t job);
+
+  /**
+   * \short Cancels a job (a run which already started still finishes).
+   * \param name The name of the job.
+   * \returns True if a job with that name was scheduled, otherwise false.
+   */
+  bool cancel(const std::string &name);
+
+  /**
+   * \short Stops the timer thread and the workers (waiting for running jobs to finish).
+   */
+  void stop();
+
+  /**
+   * \short Stops the scheduler (see `stop`).
+   */
+  ~scheduler();
+
+private:
+  /**
+   * \short The scheduler is a singleton, so it doesn't support constructing.
+   */
+  scheduler();
+
+  /**
+   * \short Structure representing a scheduled job.
+   */
+  struct entry {
+    std::string name;                       /*!< \short The name of the job. */
+    std::chrono::milliseconds interval;     /*!< \short The time between two runs (0 for a job which runs once). */
+    std::shared_ptr<const job_t> run;       /*!< \short The job itself. */
+    timer_wheel::id_t timer = 0;            /*!< \short The timer for the job's next run. */
+    bool running = false;                   /*!< \short Whether the job is running. */
+  };
+
+  /**
+   * \short Adds a job (the lock should be held).
+   * \param name The name of the job.
+   * \param interval The time between two runs (0 for a job which runs once).
+   * \param delay The time before the first run.
+   * \param job The job to run.
+   */
+  void add(const std::string &name, std::chrono::milliseconds interval, std::chrono::milliseconds delay, job_t job);
+
+  /**
+   * \short Converts a duration to an amount of ticks (rounded up).
+   * \param d The duration.
+   * \returns The amount of ticks (at least 1).
+   */
+  [[nodiscard]] uint64_t to_ticks(std::chrono::milliseconds d) const;
+
+  /**
+   * \short The loop run by the timer thread.
+   * \param st The thread's stop token.
+   */
+  void tick(const std::stop_token &st);
+
+  /**
+   * \short The loop run by each worker.
+   * \param st The worker's stop token.
+   */
+  void work(const std::stop_token &st);
+
+  /**
+   * \short Lock protecting the wheel, the jobs and the queue.
+   */
+  std::mutex lock;
+  /**
+   * \short Condition variable signalling the workers that a job is due.
+   */
+  std::condition_variable_any ready;
+  /**
+   * \short The timer wheel (one timer per scheduled job).
+   */
+  timer_wheel wheel;
+  /**
+   * \short The length of a tick.
+   */
+  std::chrono::milliseconds tick_length;
+  /**
+   * \short The ID for the next job.
+   */
+  uint64_t next_id = 1;
+  /**
+   * \short The scheduled jobs, by ID.
+   */
+  std::unordered_map<uint64_t, entry> jobs;
+  /**
+   * \short The ID of the scheduled job for each name.
+   */
+  std::map<std::string, uint64_t, std::less<>> names;
+  /**
+   * \short The IDs of the jobs which are due (oldest first).
+   */
+  std::deque<uint64_t> queue;
+  /**
+   * \short The worker threads.
+   */
+  std::vector<std::jthread> workers;
+  /**
+   * \short The timer thread (declared last, so it's stopped first).
+   */
+  std::jthread ticker;
+};
+}
+
+#endif //DOTCHAT_SERVER_SCHEDULER_HPP
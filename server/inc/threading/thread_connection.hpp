@@ -15,8 +15,12 @@
 #ifndef DOTCHAT_SERVER_THREAD_CONNECTION_HPP
 #define DOTCHAT_SERVER_THREAD_CONNECTION_HPP
 
+#include <mutex>
+#include <atomic>
 #include <thread>
 #include "tls/tls_connection.hpp"
+#include "handlers/session.hpp"
+#include "threading/timeouts.hpp"
 
 /**
  * \short Namespace for all code related to the server.
@@ -35,16 +39,17 @@ enum class thread_state {
 
 /**
  * \short Class representing a connection running on a separate thread.
+ *
+ * The thread sleeps until the peer sends something; deadlines (for the handshake, and for idle connections) are armed
+ * with `dotchat::server::timeouts`, which wakes the thread up when one passes.
  */
-class thread_conn {
+class thread_conn : private timeout_target {
 public:
   /**
    * \short Constructs a new threaded connection from a normal connection.
-   * \param conn The connection to work with.
+   * \param conn The connection to work with (its TLS handshake is done on the new thread, if it wasn't yet).
    */
-  inline explicit thread_conn(tls::tls_connection &&conn) : conn{std::move(conn)} {
-    id = thread_id_next++;
-  }
+  inline explicit thread_conn(tls::tls_connection &&conn) : conn{std::move(conn)}, id{thread_id_next++} {}
   /**
    * \short Threaded connections can't be copy-constructed.
    */
@@ -52,7 +57,7 @@ public:
   /**
    * \short Threaded connections can't be move-constructed.
    */
-  thread_conn(thread_conn &&other) = default;
+  thread_conn(thread_conn &&other) = delete;
 
   /**
    * \short Threaded connections can't be copy-assigned.
@@ -61,7 +66,7 @@ public:
   /**
    * \short Threaded connections can't be move-assigned.
    */
-  thread_conn &operator=(thread_conn &&other) = default;
+  thread_conn &operator=(thread_conn &&other) = delete;
 
   /**
    * \short Returns whether the thread is running or not.
@@ -74,7 +79,9 @@ public:
    * \short Request the thread to stop running (asynchronously).
    */
   inline void request_stop() {
-    if(is_running()) state = thread_state::STOPPING;
+    if(!is_running()) return;
+    state = thread_state::STOPPING;
+    wake();
   }
 
   /**
@@ -112,6 +119,22 @@ private:
    */
   void callback();
 
+  /**
+   * \short Flags the connection as timed out, and wakes up its thread (called by `dotchat::server::timeouts`).
+   */
+  void expire() override;
+
+  /**
+   * \short Wakes up the thread if it's waiting for the peer (see `dotchat::tls::tls_connection::interrupt`).
+   */
+  void wake();
+
+  /**
+   * \short Disarms the connection's deadline, and closes the connection.
+   * \param end The state to end in (`FINISHED` or `STOPPED`).
+   */
+  void finish(thread_state end);
+
   /**
    * \short The next thread ID to be given.
    */
@@ -121,17 +144,35 @@ private:
    */
   tls::tls_connection conn;
   /**
-   * \short The actual internal thread (`std::jthread`).
+   * \short The session this connection is bound to (if any); must be initialized before the thread starts.
    */
-  std::jthread runner = std::jthread([this](){ this->callback(); });
+  connection_session session;
+  /**
+   * \short Lock protecting the connection against being woken up while it's closed.
+   */
+  std::mutex wake_lock;
+  /**
+   * \short The connection's current deadline (0 if none is armed).
+   */
+  timeouts::id_t deadline = 0;
   /**
-   * \short The current state for this thread.
+   * \short Whether a deadline passed; deadlines are only armed while waiting, and the connection is closed as soon as
+   * the thread sees this.
+   */
+  std::atomic<bool> expired = false;
+  /**
+   * \short The current state for this thread; must be initialized before the thread starts.
    */
   thread_state state = thread_state::WAITING;
   /**
-   * \short This thread's ID.
+   * \short This thread's ID; must be initialized before the thread starts.
    */
-  size_t id = 0;
+  size_t id;
+  /**
+   * \short The actual internal thread (`std::jthread`); declared last, so it starts once all other members are
+   * initialized (and is joined before any of them is destroyed).
+   */
+  std::jthread runner = std::jthread([this](){ this->callback(); });
 };
 }
 
@@ -60,7 +60,8 @@ public:
   static thread_mgr &manager();
   /**
    * \short Adds a new connection to the set.
-   * \param conn The `dotchat::tls::tls_connection` on which a new thread should be created.
+   * \param conn The `dotchat::tls::tls_connection` on which a new thread should be created (its TLS handshake is done
+   * on that thread, if it wasn't yet).
    */
   void enlist(tls::tls_connection &&conn);
 
@@ -81,37 +82,71 @@ public:
   ~thread_mgr() = default;
 
   /**
-   * \short Gets or sets the delay for the cleanup-thread (in ms).
+   * \short Gets or sets the delay between two cleanups of stopped connections (in ms).
    * \returns A reference to the internal value.
    */
   inline size_t &cleanup_ms_delay() { return delay; };
 
+  /**
+   * \short Gets or sets the idle timeout for connections (in ms).
+   * \returns A reference to the internal value.
+   *
+   * Connections which don't send a request for this long are closed (and their thread is reclaimed). Clients can send
+   * `ping` requests to keep their connection open. A value of 0 disables the idle timeout.
+   */
+  inline size_t &idle_ms_timeout() { return idle_timeout; }
+
+  /**
+   * \short Gets or sets the deadline for the TLS handshake of new connections (in ms).
+   * \returns A reference to the internal value.
+   *
+   * Connections which don't complete their handshake in time are closed. A value of 0 disables the deadline.
+   */
+  inline size_t &handshake_ms_timeout() { return handshake_timeout; }
+
+  /**
+   * \short Gets or sets the read/write timeout for connections (in ms).
+   * \returns A reference to the internal value.
+   *
+   * A single read or write which takes longer than this (e.g. a peer which stopped halfway through a message) fails,
+   * causing the connection to be closed. A value of 0 disables the timeout.
+   */
+  inline size_t &read_ms_timeout() { return read_timeout; }
+
 private:
   /**
    * \short The thread manager is a singleton, so it doesn't support constructing.
    */
-  thread_mgr() = default;
+  thread_mgr();
   /**
-   * \short The internal cleanup function.
+   * \short Schedules the next cleanup of stopped connections (as the `connection_cleanup` background job).
    */
-  void cleanup(const std::stop_token &st);
+  void schedule_cleanup();
 
   /**
    * \short A mutex to avoid race conditions between enlist/cleanup.
    */
   std::mutex protector;
-  /**
-   * \short The cleanup thread.
-   */
-  std::jthread cleaner = std::jthread([this](const std::stop_token &st){ this->cleanup(st); });
   /**
    * \short The thread set.
    */
   thread_set_t threads;
   /**
-   * \short The delay for the cleanup thread (in ms).
+   * \short The delay between two cleanups (in ms).
    */
   size_t delay = 100;
+  /**
+   * \short The idle timeout for connections (in ms; 30 minutes by default).
+   */
+  size_t idle_timeout = 30 * 60 * 1000;
+  /**
+   * \short The deadline for the TLS handshake (in ms).
+   */
+  size_t handshake_timeout = 10 * 1000;
+  /**
+   * \short The read/write timeout for connections (in ms).
+   */
+  size_t read_timeout = 10 * 1000;
 };
 }
 
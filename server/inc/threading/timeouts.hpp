@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        timeouts.hpp
+// Purpose:     Shared timeouts (driven by the accept loop)
+// Author:      jay-tux
+// Created:     October 18, 2026 9:04 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Shared timeouts (driven by the accept loop).
+ */
+
+#ifndef DOTCHAT_SERVER_TIMEOUTS_HPP
+#define DOTCHAT_SERVER_TIMEOUTS_HPP
+
+#include <mutex>
+#include <chrono>
+#include "threading/timer_wheel.hpp"
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Gets the resolution of the timeouts (only read when the timeouts are first used).
+ * \returns A reference to the length of a tick, in milliseconds (default 100).
+ */
+size_t &timeout_tick_ms();
+
+/**
+ * \short Base class for anything a timeout can expire (e.g. a connection).
+ *
+ * The target is embedded in its owner, so arming a timeout doesn't allocate anything.
+ */
+class timeout_target {
+public:
+  /**
+   * \short Called (on the thread driving the timeouts) when a timeout armed for this target expires.
+   *
+   * This runs while the timeouts are locked: it should only flag its owner (or wake it up), and it can't arm or disarm
+   * timeouts itself.
+   */
+  virtual void expire() = 0;
+
+protected:
+  /**
+   * \short Targets are never destroyed through a pointer to their base.
+   */
+  ~timeout_target() = default;
+};
+
+/**
+ * \short Singleton class holding all timeouts (idle connections, handshake deadlines, ...) in a single timer wheel.
+ *
+ * Arming, re-arming and disarming a timeout are O(1), and a timeout doesn't need its own thread (or allocation). The
+ * wheel doesn't have a thread of its own either: it's advanced by the accept loop (see `tick`), which wakes up at least
+ * once per tick anyway.
+ */
+class timeouts {
+public:
+  /**
+   * \short Type alias for the handle to a timeout (`dotchat::server::timer_wheel::id_t`; 0 is never armed).
+   */
+  using id_t = timer_wheel::id_t;
+
+  /**
+   * \short The timeouts are a singleton, so they don't support copying.
+   */
+  timeouts(const timeouts &) = delete;
+  /**
+   * \short The timeouts are a singleton, so they don't support moving.
+   */
+  timeouts(timeouts &&) = delete;
+  /**
+   * \short The timeouts are a singleton, so they don't support copying.
+   * \returns Nothing, the timeouts can't be copied.
+   */
+  timeouts &operator=(const timeouts &) = delete;
+  /**
+   * \short The timeouts are a singleton, so they don't support moving.
+   * \returns Nothing, the timeouts can't be moved.
+   */
+  timeouts &operator=(timeouts &&) = delete;
+
+  /**
+   * \short Gets the timeouts.
+   * \returns The singleton instance.
+   */
+  static timeouts &instance();
+
+  /**
+   * \short Arms a timeout (replacing an earlier one).
+   * \param previous The handle to the timeout to replace (0 if there is none).
+   * \param after The time after which the timeout expires (rounded up to a whole tick).
+   * \param target The target to expire; it must outlive the timeout (or disarm it first).
+   * \returns A handle to the new timeout.
+   */
+  id_t arm(id_t previous, std::chrono::milliseconds after, timeout_target &target);
+
+  /**
+   * \short Disarms a timeout.
+   * \param id The handle to the timeout (0 is ignored).
+   * \returns True if the timeout was disarmed, false if it already expired (or was disarmed).
+   *
+   * After this returns, the timeout's target is never expired (by that timeout); even if it was about to.
+   */
+  bool disarm(id_t id);
+
+  /**
+   * \short Expires all timeouts which are due (called by the accept loop).
+   */
+  void tick();
+
+private:
+  /**
+   * \short The timeouts are a singleton, so they don't support constructing.
+   */
+  timeouts();
+
+  /**
+   * \short Lock protecting the wheel (held while expiring targets).
+   */
+  std::mutex lock;
+  /**
+   * \short The timer wheel (the payloads are the targets).
+   */
+  timer_wheel wheel;
+  /**
+   * \short The moment the wheel was at tick 0.
+   */
+  std::chrono::steady_clock::time_point start;
+  /**
+   * \short The length of a tick.
+   */
+  std::chrono::milliseconds tick_length;
+};
+}
+
+#endif //DOTCHAT_SERVER_TIMEOUTS_HPP
@@ -0,0 +1,187 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        timer_wheel.hpp
+// Purpose:     Hierarchical timer wheel (O(1) timers)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:46 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Hierarchical timer wheel (O(1) timers).
+ */
+
+#ifndef DOTCHAT_SERVER_TIMER_WHEEL_HPP
+#define DOTCHAT_SERVER_TIMER_WHEEL_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * \short Namespace for all code related to the server.
+ */
+namespace dotchat::server {
+/**
+ * \short Class representing a hierarchical timer wheel.
+ *
+ * Time is counted in ticks; the owner advances the wheel (see `advance`). The wheel has 4 levels of 256 slots: a timer
+ * due within 256 ticks is kept in the first level, in the slot for its deadline; later timers are kept in a coarser
+ * level (each slot covering 256 slots of the level below), and are moved down a level when the wheel reaches their
+ * slot. So scheduling and cancelling a timer are O(1), each tick only looks at a single slot (and, once every 256
+ * ticks, moves down the timers of a single coarser slot), and no timer is ever looked at just to count down. Timers
+ * more than 2^32 ticks away are kept in the last level until they're close enough. The timers themselves live in a
+ * single vector (reused through a free list), so no allocation is made per timer once the wheel has grown.
+ *
+ * The wheel is not thread-safe; its owner has to synchronize access.
+ */
+class timer_wheel {
+public:
+  /**
+   * \short Type alias for the handle to a timer (`uint64_t`; 0 is never a valid handle).
+   */
+  using id_t = uint64_t;
+
+  /**
+   * \short Constructs a new, empty timer wheel.
+   */
+  timer_wheel();
+
+  /**
+   * \short Schedules a new timer.
+   * \param ticks The amount of ticks after which the timer expires (at least 1).
+   * \param payload The value handed back when the timer expires.
+   * \returns A handle to the timer (to cancel it).
+   */
+  id_t schedule(uint64_t ticks, uint64_t payload);
+
+  /**
+   * \short Cancels a timer.
+   * \param id The handle to the timer.
+   * \returns True if the timer was cancelled, false if it already expired (or was cancelled).
+   */
+  bool cancel(id_t id);
+
+  /**
+   * \short Advances the wheel by a number of ticks, handing each expired timer's payload to a callback.
+   * \tparam Fun The type of the callback (callable as `void(uint64_t)`).
+   * \param ticks The amount of ticks to advance.
+   * \param expired The callback; it may schedule (or cancel) timers.
+   */
+  template <typename Fun>
+  void advance(uint64_t ticks, Fun &&expired) {
+    for(uint64_t i = 0; i < ticks; i++) {
+      current++;
+      // on a level's wrap-around, the next slot of the level above moves down
+      for(size_t level = 1; level < levels && ((current >> (bits * (level - 1))) & mask) == 0; level++) {
+        cascade(level, (current >> (bits * level)) & mask);
+      }
+      collect(current & mask);
+      for(uint64_t payload: due) expired(payload);
+      due.clear();
+    }
+  }
+
+  /**
+   * \short Gets the amount of ticks the wheel has advanced.
+   * \returns The current tick.
+   */
+  [[nodiscard]] inline uint64_t now() const { return current; }
+
+  /**
+   * \short Gets the amount of pending timers.
+   * \returns The amount of timers which haven't expired or been cancelled.
+   */
+  [[nodiscard]] inline size_t size() const { return pending; }
+
+private:
+  /**
+   * \short Value for "no timer" (in the slot lists and the free list).
+   */
+  constexpr const static uint32_t none = UINT32_MAX;
+  /**
+   * \short The amount of levels.
+   */
+  constexpr const static size_t levels = 4;
+  /**
+   * \short The amount of bits of a deadline covered by each level.
+   */
+  constexpr const static size_t bits = 8;
+  /**
+   * \short Mask for the slot within a level.
+   */
+  constexpr const static uint64_t mask = (1u << bits) - 1;
+
+  /**
+   * \short Structure representing a single timer.
+   */
+  struct node {
+    uint64_t payload = 0;   /*!< \short The value handed back on expiry. */
+    uint64_t deadline = 0;  /*!< \short The tick at which the timer expires. */
+    uint32_t prev = none;   /*!< \short The previous timer in the same slot. */
+    uint32_t next = none;   /*!< \short The next timer in the same slot (or in the free list). */
+    uint32_t slot = 0;      /*!< \short The slot the timer is in (over all levels). */
+    uint32_t serial = 0;    /*!< \short Bumped each time the node is reused (so stale handles are ignored). */
+    bool used = false;      /*!< \short Whether the node holds a pending timer. */
+  };
+
+  /**
+   * \short Links a timer into the slot for its deadline.
+   * \param index The index of the node.
+   */
+  void link(uint32_t index);
+
+  /**
+   * \short Unlinks a timer from its slot.
+   * \param index The index of the node.
+   */
+  void unlink(uint32_t index);
+
+  /**
+   * \short Moves all timers in a slot of a coarser level down to the slots for their deadlines.
+   * \param level The level (at least 1).
+   * \param slot The slot within the level.
+   */
+  void cascade(size_t level, size_t slot);
+
+  /**
+   * \short Moves the payloads of the timers in a slot of the first level (which all expire now) to `due`.
+   * \param slot The slot within the first level.
+   */
+  void collect(size_t slot);
+
+  /**
+   * \short Unlinks a timer, and puts its node on the free list.
+   * \param index The index of the node.
+   */
+  void release(uint32_t index);
+
+  /**
+   * \short The first timer in each slot (the slots of all levels, finest first).
+   */
+  std::vector<uint32_t> heads;
+  /**
+   * \short All timer nodes (pending or free).
+   */
+  std::vector<node> nodes;
+  /**
+   * \short The payloads of the timers expiring in the current tick.
+   */
+  std::vector<uint64_t> due;
+  /**
+   * \short The first free node.
+   */
+  uint32_t free_head = none;
+  /**
+   * \short The current tick.
+   */
+  uint64_t current = 0;
+  /**
+   * \short The amount of pending timers.
+   */
+  size_t pending = 0;
+};
+}
+
+#endif //DOTCHAT_SERVER_TIMER_WHEEL_HPP
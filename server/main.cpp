@@ -5,24 +5,50 @@
 #include "tls/tls_error.hpp"
 #include "threading/thread_mgr.hpp"
 #include "db/database.hpp"
+#include "db/message_store.hpp"
+#include "db/message_log.hpp"
+#include "db/maintenance.hpp"
+#include "handlers/tokens.hpp"
+#include "handlers/rate_limits.hpp"
+#include "threading/scheduler.hpp"
+#include "threading/timeouts.hpp"
+#include "metrics/server_metrics.hpp"
+#include "admin/admin_endpoint.hpp"
+#include "tracing/tracing.hpp"
+#include "logging/logging.hpp"
+#include "protocol/byte_order.hpp"
+#include "protocol/compression.hpp"
 #include <csignal>
+#include <ctime>
 #include <atomic>
 #include <iostream>
 
 using namespace dotchat;
 using namespace dotchat::tls;
 using namespace dotchat::server;
+using namespace std::chrono_literals;
 
 volatile std::sig_atomic_t flag = 0;
+volatile std::sig_atomic_t dump_trace = 0;
 const static int milli_delay = 100;
+const static uint16_t admin_port = 42070;
 
 void help(const char *invoker) {
-  std::cerr << "Usage: " << invoker << " <private key PEM file> <certificate PEM file>" << std::endl;
+  std::cerr << "Usage: " << invoker << " <private key PEM file> <certificate PEM file> [zstd dictionary] [message log directory]" << std::endl;
 }
 
 extern "C" void sig_int(int sig) {
-  std::cerr << std::endl << "Signal " << sig << " thrown... Shutting down server..." << std::endl;
-  flag = 1;
+  flag = sig;
+}
+
+extern "C" void sig_usr1(int) {
+  dump_trace = 1;
+}
+
+void write_trace() {
+  auto file = "dotchat-trace-" + std::to_string(std::time(nullptr)) + ".json";
+  if(tracing::dump_to_file(file)) logging::info("Trace written", { { "file", file } });
+  else logging::error("Failed to write trace", { { "file", file } });
 }
 
 int main(int argc, const char **argv) {
@@ -31,28 +57,75 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
-  std::cerr << "Starting server..." << std::endl;
-  std::cerr << "Setting up signal handler..." << std::endl;
+  logging::flusher flusher(std::cerr);
+  logging::info("Starting server...", { { "list_codec", proto::swap_copy_isa() } });
+  logging::info("Setting up signal handler...");
   struct sigaction params{};
   params.sa_flags = 0;
   params.sa_handler = sig_int;
   sigemptyset(&params.sa_mask);
   if(sigaction(SIGINT, &params, nullptr) == -1) {
-    std::cerr << "Failed to install signal handler... Continuing without handler..." << std::endl;
+    logging::warn("Failed to install signal handler... Continuing without handler...");
+  }
+  params.sa_handler = sig_usr1;
+  if(sigaction(SIGUSR1, &params, nullptr) == -1) {
+    logging::warn("Failed to install trace dump handler... Continuing without handler...");
+  }
+
+  if(argc > 3 && argv[3][0] != '\0') {
+    if(proto::load_dictionary(argv[3])) logging::info("Loaded compression dictionary", { { "file", argv[3] } });
+    else logging::warn("Failed to load compression dictionary... Continuing without dictionary...", { { "file", argv[3] } });
   }
 
-  std::cerr << "Starting database service..." << std::endl;
+  logging::info("Starting database service...");
   db::database();
+  if(argc > 4) db::use_message_log(argv[4]);
+  logging::info("Using message store", { { "backend", db::messages().name() } });
+  metrics::init();
+  try {
+    // without a working signing key, no signed token could be issued or verified
+    token_signer::instance();
+  }
+  catch(const std::exception &exc) {
+    logging::error("Failed to set up token signing", { { "what", exc.what() } });
+    return 1;
+  }
+
+  logging::info("Starting background workers...", { { "threads", std::to_string(scheduler_threads()) } });
+  auto &jobs = scheduler::instance();
+  jobs.every("session_key_purge", 10min, db::purge_session_keys);
+  jobs.every("token_revocation_purge", 10min, [](){ token_signer::instance().purge(); });
+  jobs.every("token_key_rotation", token_lifetime(), [](){ token_signer::instance().rotate(); });
+  jobs.every("db_optimize", 1h, db::optimize_database);
+  jobs.every("wal_checkpoint", 30s, db::checkpoint_database);
+  jobs.every("rate_limit_purge", 1min, [](){ rate_limiter::instance().purge(); });
+  // appends only sync a quiet channel's log when its next message arrives; this bounds how long one stays unsynced
+  if(argc > 4) {
+    jobs.every("message_log_flush", db::message_log_sync_interval_ms() * 1ms, [](){ db::messages().flush(); });
+  }
 
   try {
+    logging::info("Starting admin endpoint...", { { "address", "127.0.0.1:" + std::to_string(admin_port) } });
+    admin_endpoint admin(admin_port);
+    admin.route("/metrics", "text/plain; version=0.0.4", [](){ return metrics::registry::instance().expose(); });
+    admin.route("/trace", "application/json", [](){ return tracing::dump_chrome_json(); });
+    admin.route("/queries", "text/plain", [](){ return db::query_report(); });
+    admin.start();
+
     auto context = tls_context(std::string(argv[1]), std::string(argv[2]));
     auto socket = tls_server_socket(42069, context);
-    std::cerr << "Waiting for connections..." << std::endl;
+    logging::info("Waiting for connections...");
     while(flag == 0) {
-      if(auto is_ready = socket.accept_nonblock(milli_delay); is_ready.has_value())
+      // the handshake is done on the connection's own thread, so a slow peer can't hold up the accept loop
+      if(auto is_ready = socket.accept_pending(milli_delay); is_ready.has_value())
         thread_mgr::manager().enlist(std::move(is_ready.value()));
+      timeouts::instance().tick();
+      if(dump_trace != 0) {
+        dump_trace = 0;
+        write_trace();
+      }
     }
-    std::cerr << "Detected shutdown request..." << std::endl;
+    logging::info("Detected shutdown request...", { { "signal", std::to_string(flag) } });
     for(auto &v: thread_mgr::manager()) {
       v.request_stop();
     }
@@ -60,17 +133,15 @@ int main(int argc, const char **argv) {
     for(auto &v: thread_mgr::manager()) {
       v.stop_sync();
     }
+    db::messages().flush();
   }
   catch(const tls::tls_error &err) {
-    std::cerr << "An error occurred:" << std::endl;
-    std::cerr << "  " << err.what() << std::endl;
-    std::cerr << "OpenSSL error queue: ";
-    tls_context::dump_error_queue([](){ std::cerr << std::endl << "  "; }, std::cerr);
-    std::cerr << std::endl;
+    logging::error("An error occurred", { { "what", err.what() }, { "openssl", tls_context::error_queue() } });
   }
   catch(const std::exception &exc) {
-    std::cerr << "An error occurred:" << std::endl;
-    std::cerr << "  " << exc.what() << std::endl;
+    logging::error("An error occurred", { { "what", exc.what() } });
   }
+  // before any static is destroyed (the jobs use the thread manager and the database)
+  scheduler::instance().stop();
   return 0;
 }
@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        admin_endpoint.cpp
+// Purpose:     Local plaintext HTTP endpoint for server internals (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 11:34 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <string_view>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include "admin/admin_endpoint.hpp"
+
+using namespace dotchat::server;
+
+const static int poll_ms_delay = 100;
+
+admin_endpoint::admin_endpoint(uint16_t port) {
+  sockaddr_in addr = {
+      .sin_family = AF_INET,
+      .sin_port = htons(port),
+      .sin_addr = {
+          .s_addr = htonl(INADDR_LOOPBACK)
+      },
+      .sin_zero = {}
+  };
+  handle = socket(AF_INET, SOCK_STREAM, 0);
+  if(handle < 0) {
+    throw admin_error("Can't create socket for admin port " + std::to_string(port) + ".");
+  }
+
+  int reuse = 1;
+  setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if(bind(handle, (sockaddr *)(&addr), sizeof(addr)) < 0) {
+    close(handle);
+    throw admin_error("Can't bind socket to admin port " + std::to_string(port) + ".");
+  }
+
+  if(listen(handle, 4) < 0) {
+    close(handle);
+    throw admin_error("Unable to listen to admin socket.");
+  }
+}
+
+void admin_endpoint::route(const std::string &path, std::string content_type, route_t generator) {
+  routes[path] = { std::move(content_type), std::move(generator) };
+}
+
+void admin_endpoint::start() {
+  runner = std::jthread([this](const std::stop_token &st){ this->serve(st); });
+}
+
+void admin_endpoint::serve(const std::stop_token &st) {
+  while(!st.stop_requested()) {
+    pollfd fd = { .fd = handle, .events = POLLIN, .revents = 0 };
+    if(poll(&fd, 1, poll_ms_delay) <= 0 || (fd.revents & POLLIN) == 0) continue;
+
+    int client = ::accept(handle, nullptr, nullptr);
+    if(client < 0) continue;
+    answer(client);
+    close(client);
+  }
+}
+
+void send_all(int client, std::string_view data) {
+  while(!data.empty()) {
+    auto sent = ::send(client, data.data(), data.size(), MSG_NOSIGNAL);
+    if(sent <= 0) return;
+    data.remove_prefix(static_cast<size_t>(sent));
+  }
+}
+
+void admin_endpoint::answer(int client) {
+  timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  std::string request;
+  std::array<char, 1024> buf = {};
+  while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+    auto got = recv(client, buf.data(), buf.size(), 0);
+    if(got <= 0) break;
+    request.append(buf.data(), static_cast<size_t>(got));
+  }
+
+  // request line: GET <path> HTTP/1.x
+  std::string_view line = request;
+  line = line.substr(0, line.find("\r\n"));
+  std::string_view path;
+  if(line.starts_with("GET ")) {
+    path = line.substr(4);
+    path = path.substr(0, path.find(' '));
+    path = path.substr(0, path.find('?'));
+  }
+
+  std::string response;
+  if(auto it = routes.find(path); it != routes.end()) {
+    auto body = it->second.second();
+    response = "HTTP/1.0 200 OK\r\nContent-Type: " + it->second.first +
+               "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+  }
+  else {
+    response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+  }
+  send_all(client, response);
+}
+
+admin_endpoint::~admin_endpoint() {
+  runner.request_stop();
+  if(runner.joinable()) runner.join();
+  close(handle);
+}
\ No newline at end of file
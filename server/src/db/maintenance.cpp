@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        maintenance.cpp
+// Purpose:     Database maintenance (run as background jobs; impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:46 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "db/maintenance.hpp"
+#include "db/database.hpp"
+#include <sqlite3.h>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+using namespace sqlite_orm;
+using namespace dotchat::server;
+using namespace dotchat::server::db;
+
+// maintenance uses its own connection (so it's not traced by the profiler, and doesn't hold up the ORM's connection)
+std::unique_ptr<sqlite3, decltype(&sqlite3_close)> open_maintenance(const char *file) {
+  sqlite3 *handle = nullptr;
+  int res = sqlite3_open_v2(file, &handle, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+  std::unique_ptr<sqlite3, decltype(&sqlite3_close)> conn(handle, sqlite3_close);
+  if(res != SQLITE_OK)
+    throw std::runtime_error(std::string("Failed to open database: ") + sqlite3_errstr(res));
+  sqlite3_busy_timeout(conn.get(), 1000);
+  return conn;
+}
+
+void exec_maintenance(sqlite3 *handle, const char *sql) {
+  char *error = nullptr;
+  if(sqlite3_exec(handle, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+    std::string what = std::string("Failed to run `") + sql + "`: " + (error == nullptr ? "unknown error" : error);
+    sqlite3_free(error);
+    throw std::runtime_error(what);
+  }
+}
+
+void db::configure_database(const char *file, bool fresh) {
+  auto conn = open_maintenance(file);
+  if(fresh) exec_maintenance(conn.get(), "PRAGMA auto_vacuum = INCREMENTAL;");
+  exec_maintenance(conn.get(), "PRAGMA journal_mode = WAL;");
+}
+
+void db::purge_session_keys() {
+  database().remove_all<session_key>(where(c(&session_key::valid_until) < now_uncut()));
+}
+
+void db::optimize_database() {
+  auto conn = open_maintenance(path);
+  // `PRAGMA optimize` only analyzes the tables its own connection queried, and neither this connection nor the ORM's
+  // (which sqlite_orm opens for each operation) lives long enough; so analyze everything, sampling large indices
+  exec_maintenance(conn.get(), "PRAGMA analysis_limit = 1000;");
+  exec_maintenance(conn.get(), "ANALYZE;");
+  exec_maintenance(conn.get(), "PRAGMA incremental_vacuum;");
+}
+
+void db::checkpoint_database() {
+  auto conn = open_maintenance(path);
+  if(int res = sqlite3_wal_checkpoint_v2(conn.get(), nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+     res != SQLITE_OK)
+    throw std::runtime_error(std::string("Failed to checkpoint the database: ") + sqlite3_errstr(res));
+}
\ No newline at end of file
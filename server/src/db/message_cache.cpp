@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_cache.cpp
+// Purpose:     In-memory cache of the most recent messages per channel (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 6:40 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "db/message_cache.hpp"
+#include "metrics/server_metrics.hpp"
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::server;
+using namespace dotchat::server::db;
+
+size_t cached_size(const message_cache::message_t &msg) {
+  return sizeof(msg) + msg.content.size();
+}
+
+message_cache::message_t to_cached(const message_view &msg) {
+  return { .id = msg.id, .sender = msg.sender, .when = msg.when, .content = std::string(msg.content) };
+}
+
+// the `last` most recent messages (or all, if `last` is 0): the ones older than the ring come straight from the store,
+// the others from the ring; returns whether the store had to be read
+bool read_cached(message_store &store, int32_t channel, size_t first, const std::deque<message_cache::message_t> &ring,
+                 size_t last, const message_store::reader_t &reader) {
+  size_t total = first + ring.size();
+  size_t from = last == 0 ? 0 : total - std::min(last, total);
+  if(from < first) store.read(channel, from, first - from, reader);
+  for(size_t i = std::max(from, first) - first; i < ring.size(); i++) {
+    const auto &msg = ring[i];
+    reader({ .id = msg.id, .sender = msg.sender, .when = msg.when, .content = msg.content });
+  }
+  return from < first;
+}
+
+size_t &db::message_cache_ring_size() {
+  static size_t size = 512;
+  return size;
+}
+
+size_t &db::message_cache_budget() {
+  static size_t budget = 32 * 1024 * 1024;
+  return budget;
+}
+
+message_cache &message_cache::instance() {
+  static message_cache cache;
+  return cache;
+}
+
+message_cache::channel_ring &message_cache::ring_for(int32_t channel) {
+  {
+    std::shared_lock guard { rings_lock };
+    if(auto it = rings.find(channel); it != rings.end()) return *it->second;
+  }
+
+  std::unique_lock guard { rings_lock };
+  auto &res = rings[channel];
+  if(res == nullptr) res = std::make_unique<channel_ring>();
+  return *res;
+}
+
+void message_cache::push(channel_ring &ring, message_t msg) {
+  size_t added = cached_size(msg);
+  ring.ring.push_back(std::move(msg));
+  ring.bytes += added;
+  total_bytes.fetch_add(added, std::memory_order_relaxed);
+
+  if(ring.ring.size() > message_cache_ring_size()) {
+    size_t removed = cached_size(ring.ring.front());
+    ring.ring.pop_front();
+    ring.first++;
+    ring.bytes -= removed;
+    total_bytes.fetch_sub(removed, std::memory_order_relaxed);
+  }
+}
+
+void message_cache::touch(int32_t channel, channel_ring &ring) {
+  std::unique_lock guard { lru_lock };
+  if(ring.loaded) {
+    lru.splice(lru.begin(), lru, ring.lru_pos);
+  }
+  else {
+    lru.push_front(channel);
+    ring.lru_pos = lru.begin();
+  }
+}
+
+void message_cache::evict(int32_t keep) {
+  while(total_bytes.load(std::memory_order_relaxed) > message_cache_budget()) {
+    int32_t victim;
+    {
+      std::unique_lock guard { lru_lock };
+      auto it = std::find_if(lru.rbegin(), lru.rend(), [keep](int32_t id) { return id != keep; });
+      if(it == lru.rend()) break;
+      victim = *it;
+    }
+
+    // the LRU position is only changed while holding the ring's lock, so take that first
+    auto &ring = ring_for(victim);
+    std::unique_lock guard { ring.lock };
+    if(!ring.loaded) continue;
+    {
+      std::unique_lock lru_guard { lru_lock };
+      lru.erase(ring.lru_pos);
+    }
+    total_bytes.fetch_sub(ring.bytes, std::memory_order_relaxed);
+    ring.ring.clear();
+    ring.bytes = 0;
+    ring.first = 0;
+    ring.loaded = false;
+  }
+  metrics::message_cache_bytes().set(static_cast<int64_t>(total_bytes.load(std::memory_order_relaxed)));
+}
+
+int32_t message_cache::append(message_store &store, int32_t channel, int32_t sender, std::string_view content,
+                              proto::now_t when) {
+  auto &ring = ring_for(channel);
+  int32_t id;
+  bool cached;
+  {
+    // holding the ring's lock while appending keeps the ring in the same order as the store
+    std::unique_lock guard { ring.lock };
+    id = store.append(channel, sender, content, when);
+    cached = ring.loaded;
+    if(cached) {
+      push(ring, { .id = id, .sender = sender, .when = when, .content = std::string(content) });
+      touch(channel, ring);
+    }
+  }
+
+  if(cached) evict(channel);
+  return id;
+}
+
+void message_cache::read(message_store &store, int32_t channel, size_t last, const message_store::reader_t &reader) {
+  auto &ring = ring_for(channel);
+  {
+    std::shared_lock guard { ring.lock };
+    if(ring.loaded) {
+      bool partial = read_cached(store, channel, ring.first, ring.ring, last, reader);
+      metrics::message_cache_requests()[partial ? "partial" : "hit"].inc();
+      touch(channel, ring);
+      return;
+    }
+  }
+
+  {
+    std::unique_lock guard { ring.lock };
+    if(ring.loaded) {
+      bool partial = read_cached(store, channel, ring.first, ring.ring, last, reader);
+      metrics::message_cache_requests()[partial ? "partial" : "hit"].inc();
+      touch(channel, ring);
+      return;
+    }
+
+    // only the most recent messages are loaded into the ring; older ones are read from the store when requested
+    metrics::message_cache_requests()["miss"].inc();
+    size_t count = store.count(channel);
+    size_t keep = std::min(count, message_cache_ring_size());
+    ring.first = count - keep;
+    store.read(channel, ring.first, keep, [this, &ring](const message_view &msg) { push(ring, to_cached(msg)); });
+    touch(channel, ring);
+    ring.loaded = true;
+    read_cached(store, channel, ring.first, ring.ring, last, reader);
+  }
+
+  evict(channel);
+}
\ No newline at end of file
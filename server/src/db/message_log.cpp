@@ -0,0 +1,298 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_log.cpp
+// Purpose:     Memory-mapped append-only message log (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 6:12 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "db/message_log.hpp"
+#include "metrics/server_metrics.hpp"
+#include "logging/logging.hpp"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+
+using namespace dotchat;
+using namespace dotchat::server;
+using namespace dotchat::server::db;
+
+// records are stored in host byte order (the log never leaves the server); a zeroed (never written) region has no
+// magic number, which marks the end of a segment
+struct record_header {
+  uint32_t magic;
+  uint32_t length;
+  uint32_t check;
+  int32_t id;
+  int32_t sender;
+  uint32_t when;
+};
+
+const static uint32_t record_magic = 0x474F4C2E; // ".LOG"
+const static size_t record_header_size = sizeof(record_header);
+
+uint32_t record_checksum(const record_header &h, std::string_view content) {
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](const void *data, size_t n) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for(size_t i = 0; i < n; i++) {
+      hash ^= bytes[i];
+      hash *= 16777619u;
+    }
+  };
+  mix(&h.length, sizeof(h.length));
+  mix(&h.id, sizeof(h.id));
+  mix(&h.sender, sizeof(h.sender));
+  mix(&h.when, sizeof(h.when));
+  mix(content.data(), content.size());
+  return hash;
+}
+
+std::runtime_error log_error(const std::string &what, const std::filesystem::path &file) {
+  return std::runtime_error("Message log: " + what + " `" + file.string() + "` (" + std::strerror(errno) + ")");
+}
+
+std::string segment_name(int32_t first_id) {
+  char buf[16];
+  std::snprintf(buf, sizeof(buf), "%010d.seg", first_id);
+  return buf;
+}
+
+void sync_segment(int fd) {
+  metrics::scoped_timer timer(metrics::message_log_sync_latency());
+  if(::fdatasync(fd) != 0) logging::warn("Failed to sync message log segment", { { "error", std::strerror(errno) } });
+}
+
+size_t &db::message_log_segment_size() {
+  static size_t size = 8 * 1024 * 1024;
+  return size;
+}
+
+size_t &db::message_log_index_interval() {
+  static size_t interval = 64;
+  return interval;
+}
+
+size_t &db::message_log_sync_batch() {
+  static size_t batch = 64;
+  return batch;
+}
+
+size_t &db::message_log_sync_interval_ms() {
+  static size_t interval = 200;
+  return interval;
+}
+
+message_log::message_log(std::filesystem::path dir): dir{std::move(dir)} {
+  std::filesystem::create_directories(this->dir);
+}
+
+message_log::channel_log &message_log::channel(int32_t id) {
+  {
+    std::shared_lock guard { channels_lock };
+    if(auto it = channels.find(id); it != channels.end()) return *it->second;
+  }
+
+  std::unique_lock guard { channels_lock };
+  auto &res = channels[id];
+  if(res == nullptr) {
+    res = std::make_unique<channel_log>();
+    res->dir = dir / std::to_string(id);
+    res->last_sync = std::chrono::steady_clock::now();
+    recover(*res);
+  }
+  return *res;
+}
+
+void message_log::recover(channel_log &log) {
+  if(!std::filesystem::exists(log.dir)) return;
+
+  std::vector<int32_t> firsts;
+  for(const auto &entry: std::filesystem::directory_iterator(log.dir)) {
+    if(entry.path().extension() != ".seg") continue;
+    try { firsts.push_back(std::stoi(entry.path().stem().string())); }
+    catch(const std::exception &) { /* not a segment */ }
+  }
+  std::sort(firsts.begin(), firsts.end());
+
+  for(auto first: firsts) {
+    // segments have to continue where the previous one stopped; anything after a gap is unreachable
+    if(first != log.count) break;
+    open_segment(log, first, 0);
+    auto &seg = log.segments.back();
+
+    size_t offset = 0;
+    while(offset + record_header_size <= seg.capacity) {
+      record_header h;
+      std::memcpy(&h, seg.map + offset, record_header_size);
+      if(h.magic != record_magic || h.id != log.count || h.length > seg.capacity - offset - record_header_size) break;
+      std::string_view content { reinterpret_cast<const char *>(seg.map + offset + record_header_size), h.length };
+      if(h.check != record_checksum(h, content)) break;
+
+      if(static_cast<size_t>(log.count) % message_log_index_interval() == 0)
+        log.index.push_back({ log.segments.size() - 1, offset });
+      offset += record_header_size + h.length;
+      log.count++;
+    }
+    seg.end = offset;
+
+    // a torn or corrupted record ends the log; zero the rest of the segment (by truncating and re-extending it), so the
+    // next append doesn't leave stale bytes behind
+    if(offset + record_header_size <= seg.capacity) {
+      uint32_t magic;
+      std::memcpy(&magic, seg.map + offset, sizeof(magic));
+      if(magic != 0) {
+        logging::warn("Message log ends in a torn or corrupted record", {
+            { "segment", (log.dir / segment_name(first)).string() }, { "offset", std::to_string(offset) }
+        });
+        if(::ftruncate(seg.fd, static_cast<off_t>(offset)) != 0 ||
+           ::ftruncate(seg.fd, static_cast<off_t>(seg.capacity)) != 0)
+          throw log_error("can't repair segment", log.dir / segment_name(first));
+        break;
+      }
+    }
+  }
+}
+
+void message_log::open_segment(channel_log &log, int32_t first_id, size_t capacity) {
+  auto file = log.dir / segment_name(first_id);
+  int fd;
+  if(capacity == 0) {
+    fd = ::open(file.c_str(), O_RDWR | O_CLOEXEC);
+    struct stat info{};
+    if(fd < 0 || ::fstat(fd, &info) != 0) throw log_error("can't open segment", file);
+    capacity = static_cast<size_t>(info.st_size);
+  }
+  else {
+    std::filesystem::create_directories(log.dir);
+    fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0 || ::ftruncate(fd, static_cast<off_t>(capacity)) != 0) throw log_error("can't create segment", file);
+    // make the new file itself durable
+    if(int dir_fd = ::open(log.dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); dir_fd >= 0) {
+      ::fsync(dir_fd);
+      ::close(dir_fd);
+    }
+  }
+
+  void *map = capacity == 0 ? nullptr : ::mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+  if(map == MAP_FAILED) {
+    ::close(fd);
+    throw log_error("can't map segment", file);
+  }
+  log.segments.push_back({ fd, static_cast<const uint8_t *>(map), capacity, 0 });
+}
+
+int32_t message_log::append(int32_t channel_id, int32_t sender, std::string_view content, proto::now_t when) {
+  auto &log = channel(channel_id);
+  size_t size = record_header_size + content.size();
+  int sync_fd = -1;
+  int32_t id;
+
+  {
+    std::unique_lock guard { log.lock };
+    if(log.segments.empty() || log.segments.back().end + size > log.segments.back().capacity) {
+      if(!log.segments.empty()) sync_segment(log.segments.back().fd);
+      open_segment(log, log.count, std::max(message_log_segment_size(), size));
+    }
+
+    auto &seg = log.segments.back();
+    id = log.count;
+    record_header h { record_magic, static_cast<uint32_t>(content.size()), 0, id, sender, when };
+    h.check = record_checksum(h, content);
+
+    std::array<iovec, 2> parts {
+        iovec{ &h, record_header_size }, iovec{ const_cast<char *>(content.data()), content.size() }
+    };
+    if(::pwritev(seg.fd, parts.data(), 2, static_cast<off_t>(seg.end)) != static_cast<ssize_t>(size))
+      throw log_error("can't write to segment", log.dir / segment_name(log.count));
+
+    if(static_cast<size_t>(id) % message_log_index_interval() == 0)
+      log.index.push_back({ log.segments.size() - 1, seg.end });
+    seg.end += size;
+    log.count++;
+
+    auto now = std::chrono::steady_clock::now();
+    if(++log.unsynced >= message_log_sync_batch() ||
+       now - log.last_sync >= std::chrono::milliseconds(message_log_sync_interval_ms())) {
+      sync_fd = seg.fd;
+      log.unsynced = 0;
+      log.last_sync = now;
+    }
+  }
+
+  // segments are only closed when the log is destroyed, so the descriptor stays valid without the lock
+  if(sync_fd >= 0) sync_segment(sync_fd);
+  return id;
+}
+
+void message_log::read(int32_t channel_id, size_t first, size_t count, const reader_t &reader) {
+  auto &log = channel(channel_id);
+  std::shared_lock guard { log.lock };
+  if(first >= static_cast<size_t>(log.count) || count == 0) return;
+
+  size_t interval = message_log_index_interval();
+  auto [seg_idx, offset] = log.index[first / interval];
+  size_t id = first / interval * interval;
+  size_t last = std::min(static_cast<size_t>(log.count), first + std::min(count, static_cast<size_t>(log.count)));
+
+  while(id < last) {
+    const auto *seg = &log.segments[seg_idx];
+    if(offset >= seg->end) {
+      seg_idx++;
+      offset = 0;
+      continue;
+    }
+
+    record_header h;
+    std::memcpy(&h, seg->map + offset, record_header_size);
+    if(id >= first) {
+      reader({
+          .id = h.id, .sender = h.sender, .when = h.when,
+          .content = { reinterpret_cast<const char *>(seg->map + offset + record_header_size), h.length }
+      });
+    }
+    offset += record_header_size + h.length;
+    id++;
+  }
+}
+
+size_t message_log::count(int32_t channel_id) {
+  auto &log = channel(channel_id);
+  std::shared_lock guard { log.lock };
+  return static_cast<size_t>(log.count);
+}
+
+void message_log::flush() {
+  std::shared_lock guard { channels_lock };
+  for(auto &[_, log]: channels) {
+    int sync_fd = -1;
+    {
+      std::unique_lock log_guard { log->lock };
+      if(log->unsynced != 0 && !log->segments.empty()) {
+        sync_fd = log->segments.back().fd;
+        log->unsynced = 0;
+        log->last_sync = std::chrono::steady_clock::now();
+      }
+    }
+    if(sync_fd >= 0) sync_segment(sync_fd);
+  }
+}
+
+message_log::~message_log() {
+  flush();
+  for(auto &[_, log]: channels) {
+    for(auto &seg: log->segments) {
+      if(seg.map != nullptr) ::munmap(const_cast<uint8_t *>(seg.map), seg.capacity);
+      ::close(seg.fd);
+    }
+  }
+}
\ No newline at end of file
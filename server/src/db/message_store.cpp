@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        message_store.cpp
+// Purpose:     Pluggable storage backend for chat messages (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 6:05 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "db/message_store.hpp"
+#include "db/message_log.hpp"
+#include "db/database.hpp"
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+using namespace sqlite_orm;
+using namespace dotchat;
+using namespace dotchat::server;
+using namespace dotchat::server::db;
+
+// the original backend: the `message` table in the database
+class database_message_store : public message_store {
+public:
+  int32_t append(int32_t channel, int32_t sender, std::string_view content, proto::now_t when) override {
+    db::message add = {
+        .id = -1,
+        .sender = sender,
+        .channel = channel,
+        .content = std::string(content),
+        .when = when,
+        .replies_to = std::nullopt
+    };
+    return database().insert(add);
+  }
+
+  void read(int32_t channel, size_t first, size_t count, const reader_t &reader) override {
+    constexpr const auto max = static_cast<size_t>(std::numeric_limits<int>::max());
+    auto res = database().get_all<db::message>(
+        where(c(&db::message::channel) == channel), order_by(&db::message::id),
+        limit(static_cast<int>(std::min(count, max)), offset(static_cast<int>(std::min(first, max))))
+    );
+
+    for(const auto &msg: res) {
+      reader({ .id = msg.id, .sender = msg.sender, .when = msg.when, .content = msg.content });
+    }
+  }
+
+  size_t count(int32_t channel) override {
+    return static_cast<size_t>(database().count<db::message>(where(c(&db::message::channel) == channel)));
+  }
+
+  [[nodiscard]] const char *name() const override { return "database"; }
+};
+
+std::unique_ptr<message_store> &active_message_store() {
+  static std::unique_ptr<message_store> store = std::make_unique<database_message_store>();
+  return store;
+}
+
+message_store &db::messages() {
+  return *active_message_store();
+}
+
+void db::use_message_log(const std::string &dir) {
+  active_message_store() = std::make_unique<message_log>(dir);
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        profiler.cpp
+// Purpose:     Statement profiling for the SQLite connections (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 11:58 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <cctype>
+#include <algorithm>
+#include <unordered_map>
+#include <condition_variable>
+#include "db/profiler.hpp"
+#include "metrics/server_metrics.hpp"
+#include "tracing/tracing.hpp"
+#include "logging/logging.hpp"
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+const static size_t shard_count = 16;
+const static size_t max_pending_slow = 64;
+
+struct string_hash {
+  using is_transparent = void;
+  size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+};
+
+struct shape_shard {
+  std::mutex lock;
+  std::unordered_map<std::string, db::query_stats, string_hash, std::equal_to<>> shapes;
+};
+
+std::array<shape_shard, shard_count> &shards() {
+  static std::array<shape_shard, shard_count> res;
+  return res;
+}
+
+shape_shard &shard_for(std::string_view sql) {
+  return shards()[string_hash{}(sql) % shard_count];
+}
+
+// returns true if the query plan for this shape is still unknown
+bool record_shape(std::string_view sql, std::chrono::nanoseconds elapsed, bool slow) {
+  auto &shard = shard_for(sql);
+  std::unique_lock guard { shard.lock };
+  auto it = shard.shapes.find(sql);
+  if(it == shard.shapes.end()) {
+    it = shard.shapes.emplace(std::string(sql), db::query_stats{
+      std::string(sql), 0, 0, std::chrono::nanoseconds{0}, std::chrono::nanoseconds{0}, {}
+    }).first;
+  }
+  auto &stats = it->second;
+  stats.count++;
+  stats.total += elapsed;
+  stats.max = std::max(stats.max, elapsed);
+  if(slow) stats.slow++;
+  return stats.plan.empty();
+}
+
+struct slow_query {
+  std::string sql;
+  std::string expanded;
+  std::chrono::nanoseconds elapsed;
+  bool needs_plan;
+  std::string conn;
+  std::string cmd;
+  std::string user;
+};
+
+// runs EXPLAIN QUERY PLAN on its own (read-only) connection and logs slow queries, off the request threads
+class slow_query_worker {
+public:
+  // the runner is stopped (and joined) by its destructor, before any other member is destroyed
+  explicit slow_query_worker(std::string db_file) : db_file{std::move(db_file)},
+    runner{[this](const std::stop_token &st) { run(st); }} {}
+
+  void submit(slow_query &&q) {
+    {
+      std::unique_lock guard { lock };
+      if(pending.size() >= max_pending_slow) return;
+      pending.push_back(std::move(q));
+    }
+    wakeup.notify_one();
+  }
+
+private:
+  // on failure, the error is returned but not cached in the shape (it might succeed for the next slow query)
+  std::pair<std::string, bool> explain(const std::string &sql) {
+    if(handle == nullptr && sqlite3_open_v2(db_file.c_str(), &handle, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+      sqlite3_close(handle);
+      handle = nullptr;
+      return { "<unavailable>", false };
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    std::string res;
+    if(sqlite3_prepare_v2(handle, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+      return { std::string("<error: ") + sqlite3_errmsg(handle) + ">", false };
+    }
+    while(sqlite3_step(stmt) == SQLITE_ROW) {
+      // columns: id, parent, notused, detail
+      if(!res.empty()) res += "; ";
+      res += reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
+    }
+    sqlite3_finalize(stmt);
+    return { res, true };
+  }
+
+  void run(const std::stop_token &st) {
+    while(!st.stop_requested()) {
+      slow_query q;
+      {
+        std::unique_lock guard { lock };
+        // waiting on the stop token itself, so a stop can't slip in between the check and the wait
+        if(!wakeup.wait(guard, st, [this]() { return !pending.empty(); })) break;
+        q = std::move(pending.front());
+        pending.pop_front();
+      }
+
+      std::string plan;
+      auto &shard = shard_for(q.sql);
+      if(q.needs_plan) {
+        bool success;
+        std::tie(plan, success) = explain(q.sql);
+        std::unique_lock guard { shard.lock };
+        if(auto it = shard.shapes.find(q.sql); success && it != shard.shapes.end()) it->second.plan = plan;
+      }
+      else {
+        std::unique_lock guard { shard.lock };
+        if(auto it = shard.shapes.find(q.sql); it != shard.shapes.end()) plan = it->second.plan;
+      }
+
+      auto ms = std::chrono::duration<double, std::milli>(q.elapsed).count();
+      logging::warn("Slow query", {
+        { "conn", q.conn }, { "cmd", q.cmd }, { "user", q.user },
+        { "duration_ms", std::to_string(ms) }, { "sql", q.expanded }, { "plan", plan }
+      });
+    }
+    sqlite3_close(handle);
+  }
+
+  std::string db_file;
+  sqlite3 *handle = nullptr;
+  std::mutex lock;
+  std::condition_variable_any wakeup;
+  std::deque<slow_query> pending;
+  std::jthread runner;
+};
+
+std::string &db_file() {
+  static std::string file;
+  return file;
+}
+
+slow_query_worker &worker() {
+  static slow_query_worker w(db_file());
+  return w;
+}
+
+// whether the statement mentions the user or session_key tables (or a column named like them), whose bound
+// parameters are password hashes and session keys
+bool touches_credentials(std::string_view sql) {
+  auto is_word = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+  for(size_t i = 0; i < sql.size();) {
+    if(!is_word(sql[i])) { i++; continue; }
+    size_t end = i;
+    while(end < sql.size() && is_word(sql[end])) end++;
+    auto word = sql.substr(i, end - i);
+    if(word == "user" || word == "session_key") return true;
+    i = end;
+  }
+  return false;
+}
+
+void report_slow(sqlite3_stmt *stmt, std::string_view sql, std::chrono::nanoseconds elapsed, bool needs_plan) {
+  bool expand = db::slow_query_parameters() && !touches_credentials(sql);
+  char *expanded = expand ? sqlite3_expanded_sql(stmt) : nullptr;
+  const auto &ctx = logging::context::current();
+  slow_query q{
+    std::string(sql), expanded == nullptr ? std::string(sql) : std::string(expanded), elapsed, needs_plan,
+    ctx.connection.has_value() ? std::to_string(ctx.connection.value()) : "-",
+    ctx.command.empty() ? "-" : ctx.command,
+    ctx.user.has_value() ? std::to_string(ctx.user.value()) : "-"
+  };
+  sqlite3_free(expanded);
+  worker().submit(std::move(q));
+}
+
+int profile_callback(unsigned type, void *, void *p, void *x) {
+  if(type == SQLITE_TRACE_PROFILE) {
+    auto elapsed = std::chrono::nanoseconds(*static_cast<sqlite3_int64 *>(x));
+    metrics::db_query_latency().observe(elapsed);
+
+    auto *stmt = static_cast<sqlite3_stmt *>(p);
+    const char *raw = sqlite3_sql(stmt);
+    std::string_view sql = raw == nullptr ? "" : raw;
+
+    auto end = tracing::clock::now();
+    tracing::record("sqlite", end - std::chrono::duration_cast<tracing::clock::duration>(elapsed), end, sql);
+
+    bool slow = elapsed >= std::chrono::milliseconds(db::slow_query_ms_threshold());
+    bool needs_plan = record_shape(sql, elapsed, slow);
+    if(slow) report_slow(stmt, sql, elapsed, needs_plan);
+  }
+  return 0;
+}
+
+void db::attach_profiler(sqlite3 *handle) {
+  if(db_file().empty()) {
+    if(const char *file = sqlite3_db_filename(handle, "main"); file != nullptr) db_file() = file;
+  }
+  sqlite3_trace_v2(handle, SQLITE_TRACE_PROFILE, profile_callback, nullptr);
+}
+
+size_t &db::slow_query_ms_threshold() {
+  static size_t threshold = 25;
+  return threshold;
+}
+
+bool &db::slow_query_parameters() {
+  static bool expand = false;
+  return expand;
+}
+
+std::vector<db::query_stats> db::query_shapes() {
+  std::vector<query_stats> res;
+  for(auto &shard: shards()) {
+    std::unique_lock guard { shard.lock };
+    for(const auto &[_, stats]: shard.shapes) res.push_back(stats);
+  }
+  std::sort(res.begin(), res.end(), [](const auto &a, const auto &b) { return a.total > b.total; });
+  return res;
+}
+
+std::string db::query_report() {
+  std::string res = "# count slow total_ms avg_ms max_ms | sql | plan\n";
+  for(const auto &stats: query_shapes()) {
+    auto total = std::chrono::duration<double, std::milli>(stats.total).count();
+    auto max = std::chrono::duration<double, std::milli>(stats.max).count();
+    res += std::to_string(stats.count) + " " + std::to_string(stats.slow) + " " + std::to_string(total) + " " +
+           std::to_string(total / static_cast<double>(stats.count)) + " " + std::to_string(max) + " | " +
+           stats.sql + " | " + (stats.plan.empty() ? "-" : stats.plan) + "\n";
+  }
+  return res;
+}
\ No newline at end of file
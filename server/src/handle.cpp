@@ -10,7 +10,18 @@
 #include "handle.hpp"
 #include "handlers/handlers.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/response_cache.hpp"
+#include "handlers/rate_limits.hpp"
+#include "handlers/session.hpp"
+#include "threading/admission.hpp"
+#include "protocol/compression.hpp"
+#include "metrics/server_metrics.hpp"
+#include "tracing/tracing.hpp"
+#include "logging/logging.hpp"
 #include <string>
+#include <chrono>
+#include <optional>
+#include <algorithm>
 
 using namespace dotchat;
 using namespace dotchat::tls;
@@ -19,19 +30,163 @@ using namespace dotchat::proto;
 using namespace sqlite_orm;
 
 message invalid_command(const std::string &cmnd) {
+  metrics::errors()["invalid_command"].inc();
   return exc_to_message(proto_error("Command `" + cmnd + "` is invalid."));
 }
 
-message dotchat::server::handle(bytestream &in) {
-  message got(in);
-
-  if(handlers::switcher.contains(got.get_command())) {
+message respond(const message &got) {
+  if(const auto *callback = handlers::by_opcode[static_cast<uint8_t>(got.get_opcode())]; callback != nullptr) {
+    metrics::requests()[got.get_command()].inc();
+    metrics::scoped_timer timer(metrics::handler_latency()[got.get_command()]);
+    tracing::span span("handle", got.get_command());
     try {
-      return handlers::switcher.at(got.get_command())(got);
+      message res = (*callback)(got);
+      if(res.get_opcode() == opcode::error) metrics::errors()["protocol"].inc();
+      return res;
     }
     catch(const proto_error &e) {
+      metrics::errors()["protocol"].inc();
       return exc_to_message(e);
     }
   }
   return invalid_command(got.get_command());
+}
+
+void compress_response(bytestream &strm, bytestream &scratch) {
+  const auto &cmd = logging::context::current().command;
+  size_t raw = strm.size();
+  bool compressed;
+  {
+    metrics::scoped_timer timer(metrics::compression_latency()[cmd]);
+    compressed = proto::compress(strm, scratch);
+  }
+  if (compressed) {
+    metrics::compression_bytes_raw()[cmd].inc(raw);
+    metrics::compression_bytes_sent()[cmd].inc(strm.size());
+  }
+}
+
+// replies use the highest protocol version both sides support
+void write_reply(const message &got, message &res, bytestream &out, bytestream &scratch) {
+  res.negotiate(got);
+  out << res;
+  if(res.uses_compression()) compress_response(out, scratch);
+}
+
+std::chrono::milliseconds check_rate_limits(const message &got) {
+  // only a bound session tells the user for free; checking the request's token is already work the limits guard
+  const auto *session = valid_session();
+  // password guesses count against the account, whichever connection they come in on
+  std::string target;
+  if(got.get_opcode() == opcode::login) {
+    try { target = requests::login_request::from(got).user; }
+    catch(const proto_error &) { /* the handler reports the error */ }
+  }
+  return rate_limiter::instance().admit(
+      got.get_opcode(), logging::context::current().connection.value_or(0), session == nullptr ? 0 : session->user,
+      target
+  );
+}
+
+// only the handler itself holds a slot; cached responses, encoding and compression don't need one
+message admitted_respond(const message &got) {
+  admission_scope slot(handlers::lanes[static_cast<uint8_t>(got.get_opcode())]);
+  if(!slot) {
+    return responses::error_response{
+        .reason = "The server is busy. Please try again later.",
+        .retry_ms = static_cast<int32_t>(std::min<size_t>(admission_interval_ms(), INT32_MAX))
+    }.to();
+  }
+  return respond(got);
+}
+
+// a request whose response may come from (or go to) the response cache
+struct cache_probe {
+  response_cache::key key;
+  int32_t user;
+  uint64_t version;
+};
+
+// a legacy key the connection isn't bound to has to be looked up in the database; that's left to the handler, so the
+// lookup happens inside the admission gate (and binds the connection, so its later requests can use the cache)
+bool checks_without_database(const token_t &token) {
+  if(!is_legacy_token(token)) return true;
+  auto *session = valid_session();
+  return session != nullptr && token == session->token;
+}
+
+std::optional<cache_probe> probe_response_cache(const message &got) {
+  // the version the reply will be encoded in
+  message reply;
+  reply.negotiate(got);
+  auto make = [&reply](opcode cmd, int32_t subject, int32_t user) -> cache_probe {
+    return {
+        { cmd, subject, reply.major_version(), reply.minor_version() },
+        user, response_cache::instance().version(cmd, subject)
+    };
+  };
+
+  try {
+    switch(got.get_opcode()) {
+      case opcode::channel_list: {
+        auto req = requests::channel_list_request::from(got);
+        if(!checks_without_database(req.token)) return std::nullopt;
+        auto user = check_session_key(req.token);
+        return make(opcode::channel_list, user.id, user.id);
+      }
+      case opcode::channel_details: {
+        auto req = requests::channel_details_request::from(got);
+        if(!checks_without_database(req.token)) return std::nullopt;
+        auto user = check_session_key(req.token);
+        return make(opcode::channel_details, req.chan_id, user.id);
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+  catch(const proto_error &) {
+    // the handler reports the error
+    return std::nullopt;
+  }
+}
+
+// only channel details are shared by several users; channel lists are cached per user
+std::vector<int32_t> response_audience(const cache_probe &probe, const message &res) {
+  if(probe.key.cmd != opcode::channel_details) return {};
+  return responses::channel_details_response::from(res).members;
+}
+
+void dotchat::server::handle(bytestream &in, bytestream &out, bytestream &scratch, header_table &table) {
+  message got(in, &table);
+  logging::context::current().command = got.get_command();
+
+  if(auto wait = check_rate_limits(got); wait.count() > 0) {
+    metrics::rate_limited()[got.get_command()].inc();
+    message res = responses::error_response{
+        .reason = "Too many requests. Please try again in " + std::to_string(wait.count()) + " ms.",
+        .retry_ms = static_cast<int32_t>(std::min<int64_t>(wait.count(), INT32_MAX))
+    }.to();
+    write_reply(got, res, out, scratch);
+    return;
+  }
+
+  auto probe = probe_response_cache(got);
+  if(probe.has_value()) {
+    tracing::span span("response_cache", got.get_command());
+    if(response_cache::instance().lookup(probe->key, probe->user, out)) {
+      metrics::requests()[got.get_command()].inc();
+      metrics::response_cache_requests()["hit"].inc();
+      return;
+    }
+    metrics::response_cache_requests()["miss"].inc();
+  }
+
+  message res = admitted_respond(got);
+  write_reply(got, res, out, scratch);
+
+  if(probe.has_value() && res.get_opcode() == opcode::okay) {
+    response_cache::instance().store(
+        probe->key, probe->version, { out.read_start(), out.size() }, response_audience(*probe, res)
+    );
+  }
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 
 #include "handlers/handlers.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/passwords.hpp"
+#include "handlers/tokens.hpp"
 
 using namespace sqlite_orm;
 using namespace dotchat::server;
@@ -21,7 +23,13 @@ handlers::callback_t handlers::change_pass = [](const message &m) -> message {
     [](const change_pass_request &req) -> change_pass_response {
       auto user = check_session_key(req.token);
 
-      db::database().update(db::user{ .id = user.id, .name = user.name, .pass = req.new_pass });
+      auto hash = hash_password(req.new_pass);
+      db::database().update_all(set(c(&db::user::pass) = hash), where(c(&db::user::id) == user.id));
+      // tokens handed out before the change stop working, like after logging out; connections bound to the user's
+      // sessions have to log in again
+      db::database().remove_all<db::session_key>(where(c(&db::session_key::user) == user.id));
+      token_signer::instance().revoke(user.id);
+      invalidate_sessions(user.id);
       return {};
     }
   );
@@ -10,7 +10,10 @@
 #include "tls/tls_bytestream.hpp"
 #include "handlers/handlers.hpp"
 #include "db/database.hpp"
+#include "db/message_store.hpp"
+#include "db/message_cache.hpp"
 #include "handlers/helpers.hpp"
+#include <algorithm>
 
 using namespace sqlite_orm;
 using namespace dotchat::tls;
@@ -19,25 +22,43 @@ using namespace dotchat::proto::requests;
 using namespace dotchat::proto::responses;
 using namespace dotchat::server;
 
+template <typename T>
+std::pair<std::string, T> paired(std::string key, T val) {
+  return std::make_pair(key, val);
+}
+
+// the reply, built while the messages are read: each message's content is copied from the store (or the cache) into the
+// reply's tree once, allocated from the request's arena, instead of into a `channel_msg_response` first
+struct channel_msg_reply {
+  message::arg_list msgs;
+
+  [[nodiscard]] message to() const & {
+    return { okay_response{}.to(), paired("msgs", msgs) };
+  }
+
+  [[nodiscard]] message to() && {
+    message res = okay_response{}.to();
+    res.map().set(std::pair<std::string, message::arg>{ "msgs", message::arg(std::move(msgs)) });
+    return res;
+  }
+};
+
 handlers::callback_t handlers::channel_msg = [](const message &m) -> message {
-  return reply_to<channel_msg_request, channel_msg_response>(m,
-      [](const channel_msg_request &req) -> channel_msg_response {
+  return reply_to<channel_msg_request, channel_msg_reply>(m,
+      [](const channel_msg_request &req) -> channel_msg_reply {
         if(auto user = check_session_key(req.token); !user_can_access(user.id, req.chan_id))
           throw proto_error("You can't access that channel, or that channel doesn't exist.");
 
-        auto res = db::database().get_all<db::message>(
-            where(c(&db::message::channel) == req.chan_id), order_by(&db::message::when)
-        );
-
-        std::vector<channel_msg_response::message> msgs;
-        for(const auto &msg: res) {
-          channel_msg_response::message add = {
-              .sender = msg.sender, .when = msg.when, .cnt = msg.content
-          };
-          msgs.push_back(add);
-        }
-
-        return { {}, msgs };
+        channel_msg_reply res;
+        auto last = static_cast<size_t>(std::max(req.last, 0));
+        db::message_cache::instance().read(db::messages(), req.chan_id, last, [&res](const db::message_view &msg) {
+          message::arg_obj obj;
+          obj.set(paired("sender", msg.sender));
+          obj.set(paired("when", msg.when));
+          obj.set(std::pair<std::string, message::arg>{ "cnt", message::arg(arena_string(msg.content)) });
+          res.msgs.push_back(message::arg(std::move(obj)));
+        });
+        return res;
       }
   );
 };
\ No newline at end of file
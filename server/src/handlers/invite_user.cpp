@@ -9,6 +9,7 @@
 
 #include "handlers/handlers.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/response_cache.hpp"
 
 using namespace sqlite_orm;
 using namespace dotchat::server;
@@ -43,6 +44,8 @@ handlers::callback_t handlers::invite_user = [](const message &m) -> message {
           throw proto_error("That user has already joined that channel.");
 
         db::database().replace(db::channel_member{ .user = other.id, .channel = chan.id });
+        response_cache::instance().invalidate(opcode::channel_list, other.id);
+        response_cache::instance().invalidate(opcode::channel_details, chan.id);
 
         return {};
     }
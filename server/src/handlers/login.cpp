@@ -13,6 +13,8 @@
 #include "handlers/handlers.hpp"
 #include "db/database.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/tokens.hpp"
+#include "handlers/passwords.hpp"
 
 using namespace sqlite_orm;
 using namespace dotchat;
@@ -29,30 +31,36 @@ int gen_key() {
 }
 
 handlers::callback_t handlers::login = [](const message &m) -> message {
-  using namespace std::chrono_literals;
-
   return reply_to<login_request, login_response>(m,
-      [](const login_request &l) -> login_response {
+      [&m](const login_request &l) -> login_response {
         auto res = db::database().get_all<db::user>(where(c(&db::user::name) == l.user));
         if(res.empty()) throw proto_error("User `" + l.user + "` doesn't exist.");
-        if(res[0].pass != l.pass) throw proto_error("Password for `" + l.user + "` incorrect.");
+        if(!check_password(l.pass, res[0].pass)) throw proto_error("Password for `" + l.user + "` incorrect.");
+        if(password_outdated(res[0].pass)) {
+          // not hashed yet (or with older cost parameters)
+          res[0].pass = hash_password(l.pass);
+          db::database().update(res[0]);
+        }
 
         int uid = res[0].id;
-        int32_t key = gen_key();
-        bool okay = false;
-
-        while(!okay) {
-          try {
-            check_session_key(key);
-            gen_key(); // aka this key already exists
-          }
-          catch(const proto_error &) {
-            okay = true; // aka this key is unique and isn't yet in the DB
-          }
+        auto valid_until = db::now_plus_uncut(token_lifetime());
+        token_t token;
+        if(m.uses_signed_tokens()) {
+          // signed tokens are checked without the database, so they don't have to be stored
+          token = token_signer::instance().issue(uid);
+        }
+        else {
+          int32_t key;
+          do {
+            key = gen_key();
+          } while(db::database().get_optional<db::session_key>(key).has_value());
+          db::database().replace(db::session_key{ key, uid, valid_until });
+          token = legacy_token(key);
         }
 
-        db::database().replace(db::session_key{ key, uid, db::now_plus_uncut(24h) });
-        return login_response{ {}, key /* token */ };
+        // later requests on this connection may leave out the token
+        bind_session(token, uid, valid_until);
+        return login_response{ {}, token };
       }
   );
 };
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "handlers/handlers.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/tokens.hpp"
 
 using namespace dotchat::server;
 using namespace dotchat::proto;
@@ -23,6 +24,8 @@ handlers::callback_t handlers::logout = [](const message &m) -> message {
         db::database().remove_all<db::session_key>(
             sqlite_orm::where(c(&db::session_key::user) == user.id)
         );
+        token_signer::instance().revoke(user.id);
+        invalidate_sessions(user.id);
         return logout_response{};
       }
   );
@@ -9,6 +9,7 @@
 
 #include "handlers/handlers.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/response_cache.hpp"
 
 using namespace sqlite_orm;
 using namespace dotchat::server;
@@ -30,6 +31,7 @@ handlers::callback_t handlers::new_channel = [](const message &m) -> message {
 
       auto id = db::database().insert(created);
       db::database().replace(db::channel_member{ .user = user.id, .channel = id });
+      response_cache::instance().invalidate(opcode::channel_list, user.id);
       return {
           {}, id
       };
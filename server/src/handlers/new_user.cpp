@@ -9,6 +9,7 @@
 
 #include "handlers/handlers.hpp"
 #include "handlers/helpers.hpp"
+#include "handlers/passwords.hpp"
 
 using namespace sqlite_orm;
 using namespace dotchat::server;
@@ -19,7 +20,7 @@ using namespace dotchat::proto::responses;
 handlers::callback_t handlers::new_user = [](const message &m) -> message {
   return reply_to<new_user_request, new_user_response>(m,
     [](const new_user_request &req) -> new_user_response {
-        db::database().insert(db::user{ .id = -1, .name = req.name, .pass = req.pass });
+        db::database().insert(db::user{ .id = -1, .name = req.name, .pass = hash_password(req.pass) });
         return {};
     }
   );
@@ -0,0 +1,149 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        passwords.cpp
+// Purpose:     Password hashing (scrypt, on the hash pool; impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:31 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "handlers/passwords.hpp"
+#include "threading/hash_pool.hpp"
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+#include <array>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <optional>
+#include <stdexcept>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+constexpr const size_t password_salt_size = 16;
+constexpr const size_t password_hash_size = 32;
+constexpr const std::string_view password_prefix = "$scrypt$";
+
+struct scrypt_hash {
+  uint64_t log_n;
+  uint32_t r;
+  uint32_t p;
+  std::vector<uint8_t> salt;
+  std::vector<uint8_t> hash;
+};
+
+std::string to_base64(const std::vector<uint8_t> &data) {
+  std::string res(4 * ((data.size() + 2) / 3), '\0');
+  EVP_EncodeBlock(reinterpret_cast<uint8_t *>(res.data()), data.data(), static_cast<int>(data.size()));
+  return res;
+}
+
+std::optional<std::vector<uint8_t>> from_base64(std::string_view text) {
+  if(text.empty() || text.size() % 4 != 0) return std::nullopt;
+  std::vector<uint8_t> res(3 * text.size() / 4);
+  if(EVP_DecodeBlock(res.data(), reinterpret_cast<const uint8_t *>(text.data()), static_cast<int>(text.size())) < 0)
+    return std::nullopt;
+  // the decoded block includes the padding
+  res.resize(res.size() - static_cast<size_t>(std::count(text.end() - 2, text.end(), '=')));
+  return res;
+}
+
+std::optional<scrypt_hash> parse_password(const std::string &stored) {
+  if(!stored.starts_with(password_prefix)) return std::nullopt;
+  scrypt_hash res{};
+  unsigned long long log_n = 0;
+  unsigned r = 0;
+  unsigned p = 0;
+  int consumed = 0;
+  if(std::sscanf(stored.c_str() + password_prefix.size(), "ln=%llu,r=%u,p=%u$%n", &log_n, &r, &p, &consumed) != 3 ||
+     consumed == 0 || log_n == 0 || log_n >= 32 || r == 0 || p == 0)
+    return std::nullopt;
+
+  std::string_view rest = std::string_view(stored).substr(password_prefix.size() + static_cast<size_t>(consumed));
+  auto split = rest.find('$');
+  if(split == std::string_view::npos) return std::nullopt;
+  auto salt = from_base64(rest.substr(0, split));
+  auto hash = from_base64(rest.substr(split + 1));
+  if(!salt.has_value() || !hash.has_value() || hash->size() != password_hash_size) return std::nullopt;
+
+  res.log_n = log_n;
+  res.r = r;
+  res.p = p;
+  res.salt = std::move(*salt);
+  res.hash = std::move(*hash);
+  return res;
+}
+
+// runs on the hash pool (scrypt is memory-hard, so the amount of concurrent derivations is bounded by the pool)
+std::vector<uint8_t> derive_password(std::string_view pass, const std::vector<uint8_t> &salt, uint64_t log_n,
+                                     uint32_t r, uint32_t p) {
+  static EVP_KDF *scrypt = EVP_KDF_fetch(nullptr, "SCRYPT", nullptr);
+  std::unique_ptr<EVP_KDF_CTX, decltype(&EVP_KDF_CTX_free)> ctx(EVP_KDF_CTX_new(scrypt), EVP_KDF_CTX_free);
+  if(ctx == nullptr) throw std::runtime_error("Failed to set up password hashing.");
+
+  uint64_t n = uint64_t(1) << log_n;
+  std::array<OSSL_PARAM, 6> params = {
+      OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_PASSWORD, const_cast<char *>(pass.data()), pass.size()),
+      OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT, const_cast<uint8_t *>(salt.data()), salt.size()),
+      OSSL_PARAM_construct_uint64(OSSL_KDF_PARAM_SCRYPT_N, &n),
+      OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_SCRYPT_R, &r),
+      OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_SCRYPT_P, &p),
+      OSSL_PARAM_construct_end()
+  };
+  std::vector<uint8_t> res(password_hash_size);
+  if(EVP_KDF_derive(ctx.get(), res.data(), res.size(), params.data()) != 1)
+    throw std::runtime_error("Failed to hash password.");
+  return res;
+}
+
+size_t &dotchat::server::scrypt_log_n() {
+  static size_t log_n = 15;
+  return log_n;
+}
+
+size_t &dotchat::server::scrypt_block_size() {
+  static size_t r = 8;
+  return r;
+}
+
+size_t &dotchat::server::scrypt_parallelism() {
+  static size_t p = 1;
+  return p;
+}
+
+std::string dotchat::server::hash_password(std::string_view pass) {
+  std::vector<uint8_t> salt(password_salt_size);
+  // never fall back to a predictable salt
+  if(RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1)
+    throw std::runtime_error("Failed to generate a salt.");
+  auto log_n = scrypt_log_n();
+  auto r = static_cast<uint32_t>(scrypt_block_size());
+  auto p = static_cast<uint32_t>(scrypt_parallelism());
+
+  std::vector<uint8_t> hash;
+  hash_pool::instance().run([&]() { hash = derive_password(pass, salt, log_n, r, p); });
+  return std::string(password_prefix) + "ln=" + std::to_string(log_n) + ",r=" + std::to_string(r) +
+         ",p=" + std::to_string(p) + "$" + to_base64(salt) + "$" + to_base64(hash);
+}
+
+bool dotchat::server::check_password(std::string_view pass, const std::string &stored) {
+  auto parsed = parse_password(stored);
+  // users created before passwords were hashed; their password is replaced by a hash when they log in
+  if(!parsed.has_value())
+    return pass.size() == stored.size() && CRYPTO_memcmp(pass.data(), stored.data(), pass.size()) == 0;
+
+  std::vector<uint8_t> hash;
+  hash_pool::instance().run([&]() { hash = derive_password(pass, parsed->salt, parsed->log_n, parsed->r, parsed->p); });
+  return CRYPTO_memcmp(hash.data(), parsed->hash.data(), password_hash_size) == 0;
+}
+
+bool dotchat::server::password_outdated(const std::string &stored) {
+  auto parsed = parse_password(stored);
+  return !parsed.has_value() || parsed->log_n != scrypt_log_n() || parsed->r != scrypt_block_size() ||
+         parsed->p != scrypt_parallelism();
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        ping.cpp
+// Purpose:     The handlers for the commands (keep-alive; impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 9:12 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "handlers/handlers.hpp"
+#include "protocol/helpers.hpp"
+
+using namespace dotchat::server;
+using namespace dotchat::proto;
+using namespace dotchat::proto::requests;
+using namespace dotchat::proto::responses;
+
+// no session or database access: this is used to keep a connection from timing out, and as version hello
+handlers::callback_t handlers::ping = [](const message &m) -> message {
+  return reply_to<ping_request, pong_response>(m,
+    [](const ping_request &) -> pong_response {
+      return { .major = message::preferred_major_version(), .minor = message::preferred_minor_version() };
+    }
+  );
+};
\ No newline at end of file
@@ -0,0 +1,135 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        rate_limits.cpp
+// Purpose:     Token-bucket rate limits per connection, user and command (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 9:21 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "handlers/rate_limits.hpp"
+#include "metrics/server_metrics.hpp"
+#include <cmath>
+#include <functional>
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+rate_limit &dotchat::server::connection_rate_limit() {
+  static rate_limit limit{ .per_second = 50, .burst = 100 };
+  return limit;
+}
+
+rate_limit &dotchat::server::user_rate_limit() {
+  static rate_limit limit{ .per_second = 100, .burst = 200 };
+  return limit;
+}
+
+rate_limit &dotchat::server::command_rate_limit(proto::opcode cmd) {
+  static std::array<rate_limit, 256> limits = []() {
+    std::array<rate_limit, 256> res{};
+    res[static_cast<uint8_t>(proto::opcode::login)] = { .per_second = 1, .burst = 5 };
+    res[static_cast<uint8_t>(proto::opcode::new_user)] = { .per_second = 1, .burst = 3 };
+    res[static_cast<uint8_t>(proto::opcode::change_pass)] = { .per_second = 1, .burst = 3 };
+    res[static_cast<uint8_t>(proto::opcode::new_channel)] = { .per_second = 1, .burst = 5 };
+    res[static_cast<uint8_t>(proto::opcode::invite_user)] = { .per_second = 2, .burst = 10 };
+    res[static_cast<uint8_t>(proto::opcode::send_msg)] = { .per_second = 5, .burst = 20 };
+    res[static_cast<uint8_t>(proto::opcode::channel_msg)] = { .per_second = 2, .burst = 10 };
+    res[static_cast<uint8_t>(proto::opcode::user_details)] = { .per_second = 5, .burst = 20 };
+    return res;
+  }();
+  return limits[static_cast<uint8_t>(cmd)];
+}
+
+// scope (connection, user, command per connection, command per user, command per target) | command | ID (or hash)
+uint64_t bucket_key(uint64_t scope, uint64_t id, proto::opcode cmd = proto::opcode::none) {
+  return (scope << 56) | (static_cast<uint64_t>(cmd) << 48) | (id & 0xFFFFFFFFFFFF);
+}
+
+rate_limiter &rate_limiter::instance() {
+  static rate_limiter limiter;
+  return limiter;
+}
+
+rate_limiter::shard &rate_limiter::shard_for(uint64_t key) {
+  // the low bits of a key are a (small) ID, so mix in the scope and command before picking a shard
+  return shards[(key * 0x9E3779B97F4A7C15ull) >> 58];
+}
+
+std::chrono::milliseconds rate_limiter::take(uint64_t key, const rate_limit &limit, clock_t::time_point now) {
+  double burst = std::max(limit.burst, 1.0);
+  auto &s = shard_for(key);
+  std::unique_lock guard { s.lock };
+  auto [it, fresh] = s.table.try_emplace(key, bucket{ .tokens = burst, .last = now, .limit = &limit });
+  auto &b = it->second;
+  if(!fresh && now > b.last) {
+    b.tokens = std::min(burst, b.tokens + std::chrono::duration<double>(now - b.last).count() * limit.per_second);
+    b.last = now;
+  }
+
+  if(b.tokens >= 1) {
+    b.tokens -= 1;
+    return std::chrono::milliseconds::zero();
+  }
+  return std::chrono::milliseconds(static_cast<int64_t>(std::ceil((1 - b.tokens) / limit.per_second * 1000)));
+}
+
+void rate_limiter::refund(uint64_t key) {
+  auto &s = shard_for(key);
+  std::unique_lock guard { s.lock };
+  if(auto it = s.table.find(key); it != s.table.end()) {
+    it->second.tokens = std::min(std::max(it->second.limit->burst, 1.0), it->second.tokens + 1);
+  }
+}
+
+std::chrono::milliseconds rate_limiter::admit(proto::opcode cmd, uint64_t connection, int32_t user,
+                                              std::string_view target) {
+  struct check {
+    uint64_t key;
+    const rate_limit *limit;
+  };
+  std::array<check, 4> checks{};
+  size_t count = 0;
+
+  auto add = [&checks, &count](uint64_t key, const rate_limit &limit) {
+    if(limit.per_second > 0) checks[count++] = { key, &limit };
+  };
+  add(bucket_key(0, connection), connection_rate_limit());
+  if(user != 0) {
+    add(bucket_key(1, static_cast<uint32_t>(user)), user_rate_limit());
+    add(bucket_key(3, static_cast<uint32_t>(user), cmd), command_rate_limit(cmd));
+  }
+  else {
+    add(bucket_key(2, connection, cmd), command_rate_limit(cmd));
+  }
+  // a new connection gets new buckets, but the account it targets keeps its bucket
+  if(!target.empty()) add(bucket_key(4, std::hash<std::string_view>{}(target), cmd), command_rate_limit(cmd));
+
+  auto now = clock_t::now();
+  for(size_t i = 0; i < count; i++) {
+    if(auto wait = take(checks[i].key, *checks[i].limit, now); wait.count() > 0) {
+      for(size_t j = 0; j < i; j++) refund(checks[j].key);
+      return wait;
+    }
+  }
+  return std::chrono::milliseconds::zero();
+}
+
+size_t rate_limiter::purge() {
+  auto now = clock_t::now();
+  size_t removed = 0;
+  size_t left = 0;
+  for(auto &s: shards) {
+    std::unique_lock guard { s.lock };
+    // a full bucket is the same as no bucket at all
+    removed += std::erase_if(s.table, [now](const auto &entry) {
+      const auto &b = entry.second;
+      double refill = std::chrono::duration<double>(now - b.last).count() * b.limit->per_second;
+      return b.tokens + refill >= std::max(b.limit->burst, 1.0);
+    });
+    left += s.table.size();
+  }
+  metrics::rate_limit_buckets().set(static_cast<int64_t>(left));
+  return removed;
+}
\ No newline at end of file
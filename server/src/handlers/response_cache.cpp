@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        response_cache.cpp
+// Purpose:     Cache of encoded responses for read-mostly commands (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 7:10 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "handlers/response_cache.hpp"
+#include <cstring>
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+size_t &dotchat::server::response_cache_capacity() {
+  static size_t capacity = 4096;
+  return capacity;
+}
+
+response_cache &response_cache::instance() {
+  static response_cache cache;
+  return cache;
+}
+
+uint64_t response_cache::version(proto::opcode cmd, int32_t subject) {
+  std::shared_lock guard { lock };
+  auto it = versions.find({ cmd, subject });
+  return it == versions.end() ? 0 : it->second;
+}
+
+bool response_cache::lookup(const key &k, int32_t user, tls::bytestream &out) {
+  std::shared_ptr<const std::vector<uint8_t>> frame;
+  {
+    std::shared_lock guard { lock };
+    auto it = entries.find(k);
+    if(it == entries.end()) return false;
+
+    auto ver = versions.find({ k.cmd, k.subject });
+    if(it->second.version != (ver == versions.end() ? 0 : ver->second)) return false;
+    const auto &audience = it->second.audience;
+    if(!audience.empty() && !std::binary_search(audience.begin(), audience.end(), user)) return false;
+    frame = it->second.frame;
+  }
+
+  auto space = out.append_space(frame->size());
+  std::memcpy(space.data(), frame->data(), frame->size());
+  return true;
+}
+
+void response_cache::store(const key &k, uint64_t version, std::span<const uint8_t> frame,
+                           std::vector<int32_t> audience) {
+  std::sort(audience.begin(), audience.end());
+  auto copy = std::make_shared<const std::vector<uint8_t>>(frame.begin(), frame.end());
+
+  std::unique_lock guard { lock };
+  // the data changed while the response was being built
+  auto ver = versions.find({ k.cmd, k.subject });
+  if(version != (ver == versions.end() ? 0 : ver->second)) return;
+
+  if(response_cache_capacity() == 0) return;
+  if(!entries.contains(k) && entries.size() >= response_cache_capacity()) entries.erase(entries.begin());
+  entries[k] = { version, std::move(copy), std::move(audience) };
+}
+
+void response_cache::invalidate(proto::opcode cmd, int32_t subject) {
+  std::unique_lock guard { lock };
+  versions[{ cmd, subject }]++;
+}
\ No newline at end of file
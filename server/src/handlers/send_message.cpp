@@ -10,6 +10,8 @@
 #include "tls/tls_bytestream.hpp"
 #include "handlers/handlers.hpp"
 #include "db/database.hpp"
+#include "db/message_store.hpp"
+#include "db/message_cache.hpp"
 #include "handlers/helpers.hpp"
 
 using namespace sqlite_orm;
@@ -26,15 +28,7 @@ handlers::callback_t handlers::send_msg = [](const message &m) -> message {
           if(!user_can_access(user.id, msg.chan_id))
             throw proto_error("You are not permitted to send messages in that channel.");
 
-          db::message add = {
-              .id = -1,
-              .sender = user.id,
-              .channel = msg.chan_id,
-              .content = msg.msg_cnt,
-              .when = db::now(),
-              .replies_to = std::nullopt
-          };
-          db::database().insert(add);
+          db::message_cache::instance().append(db::messages(), msg.chan_id, user.id, msg.msg_cnt, db::now());
 
           return {};
         }
@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        session.cpp
+// Purpose:     Sessions bound to connections (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:04 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "handlers/session.hpp"
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+// bumped on each invalidation, so bound sessions only have to look at their user's generation after one
+std::atomic<uint64_t> &invalidation_epoch() {
+  static std::atomic<uint64_t> epoch = 0;
+  return epoch;
+}
+
+struct user_generations {
+  std::shared_mutex lock;
+  std::unordered_map<int32_t, uint64_t> generations;
+};
+
+user_generations &session_generations() {
+  static user_generations res;
+  return res;
+}
+
+uint64_t generation_of(int32_t user) {
+  auto &gens = session_generations();
+  std::shared_lock guard { gens.lock };
+  auto it = gens.generations.find(user);
+  return it == gens.generations.end() ? 0 : it->second;
+}
+
+connection_session *&thread_session() {
+  thread_local connection_session *session = nullptr;
+  return session;
+}
+
+session_scope::session_scope(connection_session &target) : previous{thread_session()} {
+  thread_session() = &target;
+}
+
+session_scope::~session_scope() {
+  thread_session() = previous;
+}
+
+connection_session *dotchat::server::current_session() {
+  return thread_session();
+}
+
+void dotchat::server::bind_session(const proto::token_t &token, int32_t user,
+                                   decltype(db::session_key::valid_until) valid_until) {
+  auto *session = current_session();
+  if(session == nullptr) return;
+
+  // the epoch is read before the generation, so an invalidation in between is noticed by the next check
+  auto epoch = invalidation_epoch().load(std::memory_order_acquire);
+  *session = {
+      .bound = true, .token = token, .user = user, .valid_until = valid_until,
+      .generation = generation_of(user), .epoch = epoch
+  };
+}
+
+connection_session *dotchat::server::valid_session() {
+  auto *session = current_session();
+  if(session == nullptr || !session->bound) return nullptr;
+  if(session->valid_until < db::now_uncut()) {
+    session->bound = false;
+    return nullptr;
+  }
+
+  auto epoch = invalidation_epoch().load(std::memory_order_acquire);
+  if(epoch != session->epoch) {
+    if(generation_of(session->user) != session->generation) {
+      session->bound = false;
+      return nullptr;
+    }
+    session->epoch = epoch;
+  }
+  return session;
+}
+
+void dotchat::server::invalidate_sessions(int32_t user) {
+  {
+    auto &gens = session_generations();
+    std::unique_lock guard { gens.lock };
+    gens.generations[user]++;
+  }
+  invalidation_epoch().fetch_add(1, std::memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tokens.cpp
+// Purpose:     Signed (stateless) session tokens (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:17 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "handlers/tokens.hpp"
+#include "metrics/server_metrics.hpp"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/core_names.h>
+#include <openssl/rand.h>
+#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+// layout: key generation (1 byte), user, expiry and serial number (4 bytes each, big-endian), truncated HMAC
+constexpr const size_t token_claims_size = 13;
+constexpr const size_t token_mac_size = 16;
+constexpr const size_t signed_token_size = token_claims_size + token_mac_size;
+
+uint32_t unix_now() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+  );
+}
+
+void put_token_u32(uint8_t *dst, uint32_t val) {
+  dst[0] = static_cast<uint8_t>(val >> 24);
+  dst[1] = static_cast<uint8_t>(val >> 16);
+  dst[2] = static_cast<uint8_t>(val >> 8);
+  dst[3] = static_cast<uint8_t>(val);
+}
+
+uint32_t get_token_u32(const uint8_t *src) {
+  return (uint32_t(src[0]) << 24) | (uint32_t(src[1]) << 16) | (uint32_t(src[2]) << 8) | uint32_t(src[3]);
+}
+
+std::runtime_error token_error(const std::string &what) {
+  return std::runtime_error("Signed tokens: " + what);
+}
+
+// the secret only lives in the context, which is copied for each token (cheaper than setting up HMAC each time)
+std::shared_ptr<EVP_MAC_CTX> make_token_mac() {
+  static EVP_MAC *hmac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+  if(hmac == nullptr) throw token_error("can't fetch HMAC");
+  std::array<uint8_t, 32> secret = {};
+  if(RAND_bytes(secret.data(), static_cast<int>(secret.size())) != 1) throw token_error("can't generate a secret key");
+
+  std::array<OSSL_PARAM, 2> params = {
+      OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char *>("SHA256"), 0),
+      OSSL_PARAM_construct_end()
+  };
+  std::shared_ptr<EVP_MAC_CTX> res(EVP_MAC_CTX_new(hmac), EVP_MAC_CTX_free);
+  bool ready = res != nullptr && EVP_MAC_init(res.get(), secret.data(), secret.size(), params.data()) == 1;
+  OPENSSL_cleanse(secret.data(), secret.size());
+  if(!ready) throw token_error("can't set up HMAC");
+  return res;
+}
+
+// if any step fails, the MAC is left unwritten and false is returned
+bool sign_token(EVP_MAC_CTX *key, const uint8_t *claims, uint8_t *mac) {
+  std::array<uint8_t, EVP_MAX_MD_SIZE> full = {};
+  size_t len = 0;
+  std::unique_ptr<EVP_MAC_CTX, decltype(&EVP_MAC_CTX_free)> ctx(EVP_MAC_CTX_dup(key), EVP_MAC_CTX_free);
+  if(ctx == nullptr || EVP_MAC_update(ctx.get(), claims, token_claims_size) != 1 ||
+     EVP_MAC_final(ctx.get(), full.data(), &len, full.size()) != 1 || len < token_mac_size)
+    return false;
+  std::copy_n(full.begin(), token_mac_size, mac);
+  return true;
+}
+
+std::chrono::seconds &dotchat::server::token_lifetime() {
+  static std::chrono::seconds lifetime = std::chrono::hours(24);
+  return lifetime;
+}
+
+token_signer &token_signer::instance() {
+  static token_signer signer;
+  return signer;
+}
+
+token_signer::token_signer() : current{ .generation = 0, .mac = make_token_mac() } {}
+
+proto::token_t token_signer::issue(int32_t user) {
+  std::array<uint8_t, signed_token_size> data = {};
+  {
+    // holding the lock keeps serial numbers from being handed out while a user's tokens are revoked
+    std::shared_lock guard { lock };
+    data[0] = current.generation;
+    put_token_u32(data.data() + 1, static_cast<uint32_t>(user));
+    put_token_u32(data.data() + 5, unix_now() + static_cast<uint32_t>(token_lifetime().count()));
+    put_token_u32(data.data() + 9, next_serial.fetch_add(1, std::memory_order_relaxed));
+    if(!sign_token(current.mac.get(), data.data(), data.data() + token_claims_size))
+      throw token_error("can't sign token");
+  }
+  return { data.begin(), data.end() };
+}
+
+std::optional<token_claims> token_signer::verify(const proto::token_t &token) {
+  if(token.size() != signed_token_size) {
+    metrics::token_checks()["invalid"].inc();
+    return std::nullopt;
+  }
+
+  const auto *data = reinterpret_cast<const uint8_t *>(token.data());
+  token_claims res {
+      .user = static_cast<int32_t>(get_token_u32(data + 1)),
+      .expires = get_token_u32(data + 5),
+      .serial = get_token_u32(data + 9)
+  };
+
+  std::array<uint8_t, token_mac_size> mac = {};
+  {
+    std::shared_lock guard { lock };
+    const signing_key *key = data[0] == current.generation ? &current :
+                             previous.has_value() && data[0] == previous->generation ? &*previous : nullptr;
+    // the MAC is compared in constant time, so forged tokens can't be built byte by byte; if it can't be computed, no
+    // token is valid
+    if(key == nullptr || !sign_token(key->mac.get(), data, mac.data()) ||
+       CRYPTO_memcmp(mac.data(), data + token_claims_size, token_mac_size) != 0) {
+      metrics::token_checks()["invalid"].inc();
+      return std::nullopt;
+    }
+
+    auto it = revoked.find(res.user);
+    if(it != revoked.end() && res.serial < it->second.first_valid) {
+      metrics::token_checks()["revoked"].inc();
+      return std::nullopt;
+    }
+  }
+
+  if(res.expires < unix_now()) {
+    metrics::token_checks()["expired"].inc();
+    return std::nullopt;
+  }
+  metrics::token_checks()["valid"].inc();
+  return res;
+}
+
+void token_signer::revoke(int32_t user) {
+  std::unique_lock guard { lock };
+  auto &entry = revoked[user];
+  entry.first_valid = next_serial.load(std::memory_order_relaxed);
+  // each token issued so far expires before this
+  entry.until = unix_now() + static_cast<uint32_t>(token_lifetime().count());
+  metrics::token_revocations().set(static_cast<int64_t>(revoked.size()));
+}
+
+void token_signer::rotate() {
+  signing_key next { .generation = 0, .mac = make_token_mac() };
+
+  std::unique_lock guard { lock };
+  next.generation = static_cast<uint8_t>(current.generation + 1);
+  previous = current;
+  current = next;
+}
+
+size_t token_signer::purge() {
+  auto now = unix_now();
+  std::unique_lock guard { lock };
+  auto removed = std::erase_if(revoked, [now](const auto &entry) { return entry.second.until < now; });
+  metrics::token_revocations().set(static_cast<int64_t>(revoked.size()));
+  return removed;
+}
\ No newline at end of file
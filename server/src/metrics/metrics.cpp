@@ -0,0 +1,120 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        metrics.cpp
+// Purpose:     Lock-free metric types and their registry (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 10:41 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <charconv>
+#include <array>
+#include "metrics/metrics.hpp"
+
+using namespace dotchat::server::metrics;
+
+void append_number(std::string &out, double v) {
+  std::array<char, 32> buf = {};
+  auto [end, _] = std::to_chars(buf.begin(), buf.end(), v);
+  out.append(buf.begin(), end);
+}
+
+void append_number(std::string &out, uint64_t v) {
+  std::array<char, 32> buf = {};
+  auto [end, _] = std::to_chars(buf.begin(), buf.end(), v);
+  out.append(buf.begin(), end);
+}
+
+void append_number(std::string &out, int64_t v) {
+  std::array<char, 32> buf = {};
+  auto [end, _] = std::to_chars(buf.begin(), buf.end(), v);
+  out.append(buf.begin(), end);
+}
+
+void append_sample(std::string &out, std::string_view name, std::string_view labels, std::string_view extra,
+                   auto value) {
+  out += name;
+  if(!labels.empty() || !extra.empty()) {
+    out += '{';
+    out += labels;
+    if(!labels.empty() && !extra.empty()) out += ',';
+    out += extra;
+    out += '}';
+  }
+  out += ' ';
+  append_number(out, value);
+  out += '\n';
+}
+
+metric::metric(std::string name, std::string help, const char *type, bool do_register) :
+    _name{std::move(name)}, _help{std::move(help)}, _type{type}, registered{do_register} {
+  if(registered) registry::instance().add(this);
+}
+
+metric::~metric() {
+  if(registered) registry::instance().remove(this);
+}
+
+void metric::expose(std::string &out) const {
+  out += "# HELP " + _name + " " + _help + "\n";
+  out += "# TYPE " + _name + " " + _type + "\n";
+  expose_samples(out, "");
+}
+
+void counter::expose_samples(std::string &out, std::string_view labels) const {
+  append_sample(out, name(), labels, "", get());
+}
+
+void gauge::expose_samples(std::string &out, std::string_view labels) const {
+  append_sample(out, name(), labels, "", get());
+}
+
+histogram::histogram(std::string name, std::string help, std::initializer_list<double> bounds, bool do_register) :
+    metric(std::move(name), std::move(help), "histogram", do_register), bounds{bounds}, buckets(bounds.size() + 1) {}
+
+void histogram::observe(double v) {
+  auto idx = std::lower_bound(bounds.begin(), bounds.end(), v) - bounds.begin();
+  buckets[static_cast<size_t>(idx)].fetch_add(1, std::memory_order_relaxed);
+  _sum.fetch_add(v, std::memory_order_relaxed);
+  total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void histogram::expose_samples(std::string &out, std::string_view labels) const {
+  uint64_t cumulative = 0;
+  std::string le;
+  for(size_t i = 0; i < buckets.size(); i++) {
+    cumulative += buckets[i].load(std::memory_order_relaxed);
+    le = "le=\"";
+    if(i < bounds.size()) append_number(le, bounds[i]);
+    else le += "+Inf";
+    le += '"';
+    append_sample(out, name() + "_bucket", labels, le, cumulative);
+  }
+  append_sample(out, name() + "_sum", labels, "", sum());
+  append_sample(out, name() + "_count", labels, "", count());
+}
+
+registry &registry::instance() {
+  static registry reg;
+  return reg;
+}
+
+void registry::add(const metric *m) {
+  std::unique_lock lock { protector };
+  metrics.push_back(m);
+}
+
+void registry::remove(const metric *m) {
+  std::unique_lock lock { protector };
+  metrics.remove(m);
+}
+
+std::string registry::expose() {
+  std::string res;
+  std::unique_lock lock { protector };
+  for(const auto *m: metrics) {
+    m->expose(res);
+  }
+  return res;
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        server_metrics.cpp
+// Purpose:     The metrics exported by the server (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 11:05 AM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "metrics/server_metrics.hpp"
+#include "handlers/handlers.hpp"
+
+using namespace dotchat::server;
+using namespace dotchat::server::metrics;
+
+std::vector<std::string> command_names() {
+  std::vector<std::string> res;
+  for(const auto &[cmd, _]: handlers::switcher) res.push_back(cmd);
+  return res;
+}
+
+std::vector<std::string> job_names() {
+  return { "connection_cleanup", "session_key_purge", "token_revocation_purge", "token_key_rotation", "db_optimize",
+           "wal_checkpoint", "rate_limit_purge", "message_log_flush" };
+}
+
+void metrics::init() {
+  requests();
+  handler_latency();
+  db_query_latency();
+  bytes_in();
+  bytes_out();
+  active_connections();
+  handshake_latency();
+  request_allocations();
+  compression_bytes_raw();
+  compression_bytes_sent();
+  compression_latency();
+  message_log_sync_latency();
+  message_cache_requests();
+  message_cache_bytes();
+  response_cache_requests();
+  token_checks();
+  token_revocations();
+  hash_queue_depth();
+  hash_queue_wait();
+  hash_latency();
+  hash_rejected();
+  job_latency();
+  job_failures();
+  pending_timeouts();
+  connection_timeouts();
+  rate_limited();
+  rate_limit_buckets();
+  admission_in_flight();
+  admission_queue_depth();
+  admission_wait();
+  admission_shed();
+  errors();
+}
+
+family<counter> &metrics::requests() {
+  static family<counter> m("dotchat_requests_total", "Requests handled, per command.", "command", command_names());
+  return m;
+}
+
+family<histogram> &metrics::handler_latency() {
+  static family<histogram> m("dotchat_handler_seconds", "Time spent in the command handlers.", "command",
+                             command_names(), histogram::latency_buckets);
+  return m;
+}
+
+histogram &metrics::db_query_latency() {
+  static histogram m("dotchat_db_query_seconds", "Time spent executing SQL statements.");
+  return m;
+}
+
+counter &metrics::bytes_in() {
+  static counter m("dotchat_tls_bytes_in_total", "Bytes read from TLS connections.");
+  return m;
+}
+
+counter &metrics::bytes_out() {
+  static counter m("dotchat_tls_bytes_out_total", "Bytes written to TLS connections.");
+  return m;
+}
+
+gauge &metrics::active_connections() {
+  static gauge m("dotchat_active_connections", "Connections currently managed by the thread manager.");
+  return m;
+}
+
+histogram &metrics::handshake_latency() {
+  static histogram m("dotchat_handshake_seconds", "Time spent on the TLS handshake of new connections.");
+  return m;
+}
+
+histogram &metrics::request_allocations() {
+  static histogram m("dotchat_request_allocations", "Arena allocations made while handling a single request.",
+                     { 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 });
+  return m;
+}
+
+family<counter> &metrics::compression_bytes_raw() {
+  static family<counter> m("dotchat_compression_raw_bytes_total", "Response bytes before compression, per command.",
+                           "command", command_names());
+  return m;
+}
+
+family<counter> &metrics::compression_bytes_sent() {
+  static family<counter> m("dotchat_compression_sent_bytes_total", "Response bytes after compression, per command.",
+                           "command", command_names());
+  return m;
+}
+
+family<histogram> &metrics::compression_latency() {
+  static family<histogram> m("dotchat_compression_seconds", "Time spent compressing responses, per command.",
+                             "command", command_names(), histogram::latency_buckets);
+  return m;
+}
+
+histogram &metrics::message_log_sync_latency() {
+  static histogram m("dotchat_message_log_sync_seconds", "Time spent syncing the message log to disk.");
+  return m;
+}
+
+family<counter> &metrics::message_cache_requests() {
+  static family<counter> m("dotchat_message_cache_requests_total", "Channel message reads, per cache outcome.",
+                           "outcome", { "hit", "partial", "miss" });
+  return m;
+}
+
+gauge &metrics::message_cache_bytes() {
+  static gauge m("dotchat_message_cache_bytes", "Memory used by the cached messages.");
+  return m;
+}
+
+family<counter> &metrics::response_cache_requests() {
+  static family<counter> m("dotchat_response_cache_requests_total", "Cacheable requests, per response cache outcome.",
+                           "outcome", { "hit", "partial", "miss" });
+  return m;
+}
+
+family<counter> &metrics::token_checks() {
+  static family<counter> m("dotchat_token_checks_total", "Signed token checks, per outcome.", "outcome",
+                           { "valid", "invalid", "expired", "revoked" });
+  return m;
+}
+
+gauge &metrics::token_revocations() {
+  static gauge m("dotchat_token_revocations", "Users on the token revocation list.");
+  return m;
+}
+
+gauge &metrics::hash_queue_depth() {
+  static gauge m("dotchat_hash_queue_depth", "Jobs waiting in the hash pool's queue.");
+  return m;
+}
+
+histogram &metrics::hash_queue_wait() {
+  static histogram m("dotchat_hash_queue_wait_seconds", "Time jobs spent waiting in the hash pool's queue.");
+  return m;
+}
+
+histogram &metrics::hash_latency() {
+  static histogram m("dotchat_hash_seconds", "Time spent running password hashes.");
+  return m;
+}
+
+counter &metrics::hash_rejected() {
+  static counter m("dotchat_hash_rejected_total", "Password hashes rejected because the hash pool's queue was full.");
+  return m;
+}
+
+family<histogram> &metrics::job_latency() {
+  static family<histogram> m("dotchat_job_seconds", "Time spent running background jobs.", "job", job_names(),
+                             histogram::latency_buckets);
+  return m;
+}
+
+family<counter> &metrics::job_failures() {
+  static family<counter> m("dotchat_job_failures_total", "Background job runs which failed, per job.", "job",
+                           job_names());
+  return m;
+}
+
+gauge &metrics::pending_timeouts() {
+  static gauge m("dotchat_timeouts_pending", "Armed timeouts (idle connections, handshake deadlines, ...).");
+  return m;
+}
+
+family<counter> &metrics::connection_timeouts() {
+  static family<counter> m("dotchat_connection_timeouts_total",
+                           "Connections closed because a deadline passed, per kind.", "kind", { "handshake", "idle" });
+  return m;
+}
+
+family<counter> &metrics::rate_limited() {
+  static family<counter> m("dotchat_rate_limited_total", "Requests refused by a rate limit, per command.", "command",
+                           command_names());
+  return m;
+}
+
+gauge &metrics::rate_limit_buckets() {
+  static gauge m("dotchat_rate_limit_buckets", "Token buckets held by the rate limiter (as of the last purge).");
+  return m;
+}
+
+gauge &metrics::admission_in_flight() {
+  static gauge m("dotchat_admission_in_flight", "Requests being handled.");
+  return m;
+}
+
+gauge &metrics::admission_queue_depth() {
+  static gauge m("dotchat_admission_queue_depth", "Requests waiting to be handled.");
+  return m;
+}
+
+family<histogram> &metrics::admission_wait() {
+  static family<histogram> m("dotchat_admission_wait_seconds",
+                             "Time requests waited before being handled (or shed), per priority lane.", "lane",
+                             { "interactive", "normal", "heavy", "credentials" }, histogram::latency_buckets);
+  return m;
+}
+
+family<counter> &metrics::admission_shed() {
+  static family<counter> m("dotchat_shed_total", "Requests shed under overload, per reason.", "reason",
+                           { "queue_full", "codel", "deadline" });
+  return m;
+}
+
+family<counter> &metrics::errors() {
+  static family<counter> m("dotchat_errors_total", "Errors, per kind.", "kind",
+                           { "protocol", "invalid_command", "tls", "internal" });
+  return m;
+}
\ No newline at end of file
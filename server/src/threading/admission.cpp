@@ -0,0 +1,195 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        admission.cpp
+// Purpose:     Admission control (load shedding) for request handlers (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 9:37 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "threading/admission.hpp"
+#include "metrics/server_metrics.hpp"
+#include "threading/hash_pool.hpp"
+#include <cmath>
+#include <algorithm>
+
+using namespace dotchat::server;
+using namespace std::chrono_literals;
+
+std::string dotchat::server::lane_name(request_lane lane) {
+  switch(lane) {
+    case request_lane::INTERACTIVE: return "interactive";
+    case request_lane::NORMAL: return "normal";
+    case request_lane::HEAVY: return "heavy";
+    case request_lane::CREDENTIALS: return "credentials";
+  }
+  return "other";
+}
+
+double &dotchat::server::lane_weight(request_lane lane) {
+  static std::array<double, lane_count> weights{ 8, 4, 1, 4 };
+  return weights[static_cast<size_t>(lane)];
+}
+
+size_t &dotchat::server::lane_concurrency(request_lane lane) {
+  static std::array<size_t, lane_count> limits{ 0, 0, 2, hash_pool_threads() };
+  return limits[static_cast<size_t>(lane)];
+}
+
+size_t &dotchat::server::admission_concurrency() {
+  static size_t concurrency = 8;
+  return concurrency;
+}
+
+size_t &dotchat::server::admission_queue_limit() {
+  static size_t limit = 64;
+  return limit;
+}
+
+size_t &dotchat::server::admission_target_ms() {
+  static size_t target = 5;
+  return target;
+}
+
+size_t &dotchat::server::admission_interval_ms() {
+  static size_t interval = 100;
+  return interval;
+}
+
+size_t &dotchat::server::admission_deadline_ms() {
+  static size_t deadline = 1000;
+  return deadline;
+}
+
+admission &admission::instance() {
+  static admission gate;
+  return gate;
+}
+
+admission::admission() : slots_free{std::max<size_t>(admission_concurrency(), 1)} {
+  for(size_t i = 0; i < lane_count; i++) lanes[i].limit = lane_concurrency(static_cast<request_lane>(i));
+}
+
+bool admission::shed(const std::string &reason) {
+  metrics::admission_shed()[reason].inc();
+  return false;
+}
+
+bool admission::can_run(const lane_state &lane) const {
+  return slots_free > 0 && (lane.limit == 0 || lane.running < lane.limit);
+}
+
+bool admission::should_shed(lane_state &lane, clock_t::duration sojourn, clock_t::time_point now) {
+  auto interval = std::chrono::duration_cast<clock_t::duration>(admission_interval_ms() * 1ms);
+  bool above = false;
+  if(sojourn < admission_target_ms() * 1ms) lane.above_since = {};
+  else if(lane.above_since == clock_t::time_point{}) lane.above_since = now + interval;
+  else above = now >= lane.above_since;
+
+  if(lane.dropping) {
+    if(!above) {
+      lane.dropping = false;
+      return false;
+    }
+    if(now < lane.drop_next) return false;
+    lane.drop_count++;
+    lane.drop_next += std::chrono::duration_cast<clock_t::duration>(
+        interval / std::sqrt(static_cast<double>(lane.drop_count))
+    );
+    return true;
+  }
+
+  if(!above) return false;
+  lane.dropping = true;
+  // shedding again shortly after it stopped: start near the previous rate
+  lane.drop_count = lane.drop_count > 2 && now - lane.drop_next < 8 * interval ? lane.drop_count - 2 : 1;
+  lane.drop_next = now + std::chrono::duration_cast<clock_t::duration>(
+      interval / std::sqrt(static_cast<double>(lane.drop_count))
+  );
+  return true;
+}
+
+void admission::dispatch() {
+  auto now = clock_t::now();
+  while(slots_free > 0) {
+    // the waiting request with the lowest tag, over all lanes which may run another request
+    lane_state *best = nullptr;
+    for(auto &lane: lanes) {
+      if(lane.queue.empty() || !can_run(lane)) continue;
+      if(best == nullptr || lane.queue.front()->tag < best->queue.front()->tag) best = &lane;
+    }
+    if(best == nullptr) break;
+
+    waiter *next = best->queue.front();
+    best->queue.pop_front();
+    waiting--;
+    if(should_shed(*best, now - next->since, now)) {
+      next->state = outcome::SHED;
+      shed("codel");
+      next->wake.notify_one();
+      continue;
+    }
+
+    virtual_time = next->tag;
+    slots_free--;
+    best->running++;
+    metrics::admission_in_flight().inc();
+    next->state = outcome::ADMITTED;
+    next->wake.notify_one();
+  }
+
+  for(auto &lane: lanes) {
+    if(!lane.queue.empty()) continue;
+    lane.dropping = false;
+    lane.above_since = {};
+  }
+  metrics::admission_queue_depth().set(static_cast<int64_t>(waiting));
+}
+
+bool admission::enter(request_lane which) {
+  auto &lane = lanes[static_cast<size_t>(which)];
+  std::unique_lock guard { lock };
+  // free slots are handed out right away, so if this lane may run, nothing it would have to wait for is waiting
+  if(can_run(lane)) {
+    slots_free--;
+    lane.running++;
+    metrics::admission_in_flight().inc();
+    return true;
+  }
+  // even while the lane is shedding, new requests queue up: CoDel paces its drops at dequeue (see `should_shed`)
+  if(waiting >= admission_queue_limit()) return shed("queue_full");
+
+  auto now = clock_t::now();
+  double tag = std::max(virtual_time, lane.last_tag) + 1 / std::max(lane_weight(which), 0.001);
+  waiter self{ .since = now, .tag = tag, .wake = {}, .state = outcome::WAITING };
+  lane.last_tag = tag;
+  lane.queue.push_back(&self);
+  waiting++;
+  metrics::admission_queue_depth().set(static_cast<int64_t>(waiting));
+  bool woken = self.wake.wait_until(guard, self.since + admission_deadline_ms() * 1ms, [&self]() {
+    return self.state != outcome::WAITING;
+  });
+  metrics::admission_wait()[lane_name(which)].observe(clock_t::now() - self.since);
+  if(!woken) {
+    lane.queue.erase(std::find(lane.queue.begin(), lane.queue.end(), &self));
+    waiting--;
+    metrics::admission_queue_depth().set(static_cast<int64_t>(waiting));
+    return shed("deadline");
+  }
+  // a shed request was counted by whoever shed it; an admitted one took over its slot
+  return self.state == outcome::ADMITTED;
+}
+
+void admission::leave(request_lane which) {
+  std::unique_lock guard { lock };
+  lanes[static_cast<size_t>(which)].running--;
+  slots_free++;
+  metrics::admission_in_flight().dec();
+  dispatch();
+}
+
+admission_scope::admission_scope(request_lane lane) : lane{lane}, admitted{admission::instance().enter(lane)} {}
+
+admission_scope::~admission_scope() {
+  if(admitted) admission::instance().leave(lane);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        hash_pool.cpp
+// Purpose:     Bounded thread pool for CPU-heavy work (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:31 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "threading/hash_pool.hpp"
+#include "metrics/server_metrics.hpp"
+#include "protocol/requests.hpp"
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+size_t &dotchat::server::hash_pool_threads() {
+  static size_t threads = 2;
+  return threads;
+}
+
+size_t &dotchat::server::hash_pool_queue_capacity() {
+  static size_t capacity = 64;
+  return capacity;
+}
+
+hash_pool &hash_pool::instance() {
+  static hash_pool pool;
+  return pool;
+}
+
+hash_pool::hash_pool() {
+  size_t count = std::max<size_t>(hash_pool_threads(), 1);
+  workers.reserve(count);
+  for(size_t i = 0; i < count; i++) {
+    workers.emplace_back([this](const std::stop_token &st) { work(st); });
+  }
+}
+
+void hash_pool::run(std::function<void()> job) {
+  std::packaged_task<void()> task(std::move(job));
+  auto done = task.get_future();
+  {
+    std::unique_lock guard { lock };
+    if(queue.size() >= hash_pool_queue_capacity()) {
+      metrics::hash_rejected().inc();
+      throw proto::proto_error("The server is too busy to check passwords right now. Please try again later.");
+    }
+    queue.push_back({ std::move(task), std::chrono::steady_clock::now() });
+    metrics::hash_queue_depth().set(static_cast<int64_t>(queue.size()));
+  }
+  ready.notify_one();
+  done.get();
+}
+
+void hash_pool::work(const std::stop_token &st) {
+  while(true) {
+    queued_job next;
+    {
+      std::unique_lock guard { lock };
+      if(!ready.wait(guard, st, [this]() { return !queue.empty(); })) return;
+      next = std::move(queue.front());
+      queue.pop_front();
+      metrics::hash_queue_depth().set(static_cast<int64_t>(queue.size()));
+    }
+
+    metrics::hash_queue_wait().observe(std::chrono::steady_clock::now() - next.queued);
+    metrics::scoped_timer timer(metrics::hash_latency());
+    next.task();
+  }
+}
\ No newline at end of file
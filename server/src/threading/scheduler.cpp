@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        scheduler.cpp
+// Purpose:     Scheduler for background (periodic or delayed) jobs (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:46 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "threading/scheduler.hpp"
+#include "metrics/server_metrics.hpp"
+#include "logging/logging.hpp"
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::server;
+
+size_t &dotchat::server::scheduler_threads() {
+  static size_t threads = 2;
+  return threads;
+}
+
+size_t &dotchat::server::scheduler_tick_ms() {
+  static size_t tick = 10;
+  return tick;
+}
+
+scheduler &scheduler::instance() {
+  static scheduler sched;
+  return sched;
+}
+
+scheduler::scheduler() : tick_length{std::max<size_t>(scheduler_tick_ms(), 1)} {
+  size_t count = std::max<size_t>(scheduler_threads(), 1);
+  workers.reserve(count);
+  for(size_t i = 0; i < count; i++) {
+    workers.emplace_back([this](const std::stop_token &st) { work(st); });
+  }
+  ticker = std::jthread([this](const std::stop_token &st) { tick(st); });
+}
+
+scheduler::~scheduler() {
+  stop();
+}
+
+uint64_t scheduler::to_ticks(std::chrono::milliseconds d) const {
+  return std::max<uint64_t>((d.count() + tick_length.count() - 1) / tick_length.count(), 1);
+}
+
+void scheduler::add(const std::string &name, std::chrono::milliseconds interval, std::chrono::milliseconds delay,
+                    job_t job) {
+  if(auto it = names.find(name); it != names.end()) {
+    wheel.cancel(jobs[it->second].timer);
+    jobs.erase(it->second);
+  }
+
+  uint64_t id = next_id++;
+  names[name] = id;
+  jobs[id] = {
+      .name = name, .interval = interval, .run = std::make_shared<const job_t>(std::move(job)),
+      .timer = wheel.schedule(to_ticks(delay), id)
+  };
+}
+
+void scheduler::every(const std::string &name, std::chrono::milliseconds interval, job_t job) {
+  std::unique_lock guard { lock };
+  add(name, interval, interval, std::move(job));
+}
+
+void scheduler::after(const std::string &name, std::chrono::milliseconds delay, job_t job) {
+  std::unique_lock guard { lock };
+  add(name, std::chrono::milliseconds::zero(), delay, std::move(job));
+}
+
+bool scheduler::cancel(const std::string &name) {
+  std::unique_lock guard { lock };
+  auto it = names.find(name);
+  if(it == names.end()) return false;
+  wheel.cancel(jobs[it->second].timer);
+  jobs.erase(it->second);
+  names.erase(it);
+  return true;
+}
+
+void scheduler::stop() {
+  if(ticker.joinable()) {
+    ticker.request_stop();
+    ticker.join();
+  }
+  for(auto &worker: workers) {
+    if(!worker.joinable()) continue;
+    worker.request_stop();
+    worker.join();
+  }
+}
+
+void scheduler::tick(const std::stop_token &st) {
+  auto start = std::chrono::steady_clock::now();
+  while(!st.stop_requested()) {
+    std::this_thread::sleep_until(start + tick_length * static_cast<int64_t>(wheel.now() + 1));
+    auto elapsed = static_cast<uint64_t>((std::chrono::steady_clock::now() - start) / tick_length);
+
+    bool any = false;
+    {
+      std::unique_lock guard { lock };
+      // after oversleeping, all missed ticks are handled at once
+      wheel.advance(elapsed - std::min(elapsed, wheel.now()), [this, &any](uint64_t id) {
+        auto it = jobs.find(id);
+        if(it == jobs.end()) return;
+        auto &job = it->second;
+        job.timer = job.interval.count() == 0 ? 0 : wheel.schedule(to_ticks(job.interval), id);
+        if(job.running) return;
+        job.running = true;
+        queue.push_back(id);
+        any = true;
+      });
+    }
+    if(any) ready.notify_all();
+  }
+}
+
+void scheduler::work(const std::stop_token &st) {
+  while(true) {
+    uint64_t id;
+    std::string name;
+    std::shared_ptr<const job_t> run;
+    {
+      std::unique_lock guard { lock };
+      if(!ready.wait(guard, st, [this]() { return !queue.empty(); })) return;
+      id = queue.front();
+      queue.pop_front();
+      auto it = jobs.find(id);
+      if(it == jobs.end()) continue;
+      name = it->second.name;
+      run = it->second.run;
+    }
+
+    try {
+      metrics::scoped_timer timer(metrics::job_latency()[name]);
+      (*run)();
+    }
+    catch(const std::exception &exc) {
+      metrics::job_failures()[name].inc();
+      logging::error("Background job failed", { { "job", name }, { "what", exc.what() } });
+    }
+
+    std::unique_lock guard { lock };
+    auto it = jobs.find(id);
+    // the job was cancelled or replaced in the meantime
+    if(it == jobs.end()) continue;
+    it->second.running = false;
+    if(it->second.interval.count() == 0 && it->second.timer == 0) {
+      names.erase(it->second.name);
+      jobs.erase(it);
+    }
+  }
+}
\ No newline at end of file
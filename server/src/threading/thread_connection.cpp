@@ -8,48 +8,139 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "tls/tls_error.hpp"
-#include <iostream>
 #include "threading/thread_connection.hpp"
+#include "threading/thread_mgr.hpp"
+#include "threading/timeouts.hpp"
 #include "handle.hpp"
+#include "handlers/session.hpp"
+#include "protocol/arena.hpp"
+#include "protocol/compression.hpp"
+#include "metrics/server_metrics.hpp"
+#include "tracing/tracing.hpp"
+#include "logging/logging.hpp"
 
 using namespace dotchat::server;
 using namespace dotchat;
 using namespace dotchat::tls;
+using namespace std::chrono_literals;
 
 std::atomic<size_t> thread_conn::thread_id_next = 0;
 
+void report_io(const tls_connection::io_stats &now, tls_connection::io_stats &seen) {
+  metrics::bytes_in().inc(now.bytes_in - seen.bytes_in);
+  metrics::bytes_out().inc(now.bytes_out - seen.bytes_out);
+  seen = now;
+}
+
+void thread_conn::expire() {
+  expired = true;
+  wake();
+}
+
+void thread_conn::wake() {
+  std::unique_lock guard { wake_lock };
+  conn.interrupt();
+}
+
+void thread_conn::finish(thread_state end) {
+  timeouts::instance().disarm(deadline);
+  deadline = 0;
+  {
+    std::unique_lock guard { wake_lock };
+    conn.close();
+  }
+  state = end;
+}
+
 void thread_conn::callback() {
   state = thread_state::RUNNING;
+  logging::context::current().connection = id;
+
+  auto &mgr = thread_mgr::manager();
+  auto &timers = timeouts::instance();
+  tls_connection::io_stats seen{};
+  proto::arena arena;
+  bytestream stream;
+  bytestream strm;
+  bytestream scratch;
 
   try {
+    // a peer which stalls the handshake only holds up this thread, until the deadline
+    if (mgr.handshake_ms_timeout() != 0) deadline = timers.arm(0, mgr.handshake_ms_timeout() * 1ms, *this);
+    try {
+      conn.handshake();
+    }
+    catch(const tls::tls_error &) {
+      if (!expired && state != thread_state::STOPPING) throw;
+      if (expired) metrics::connection_timeouts()["handshake"].inc();
+      finish(state == thread_state::STOPPING ? thread_state::STOPPED : thread_state::FINISHED);
+      return;
+    }
+    // a deadline which can't be disarmed anymore already expired (and interrupted the connection)
+    if (deadline != 0 && !timers.disarm(deadline)) expired = true;
+    deadline = 0;
+    if (expired) {
+      metrics::connection_timeouts()["handshake"].inc();
+      finish(thread_state::FINISHED);
+      return;
+    }
+    metrics::handshake_latency().observe(conn.stats().handshake);
+    conn.set_timeouts(mgr.read_ms_timeout() * 1ms, mgr.read_ms_timeout() * 1ms);
+    seen = conn.stats();
+
     while (conn && is_running()) {
-      auto stream = conn.read();
+      // only armed while waiting for the next request (so `expired` is only ever set while waiting, and a request which
+      // is being read or handled can't expire); counted from the end of the last request
+      if (mgr.idle_ms_timeout() != 0 && deadline == 0) deadline = timers.arm(0, mgr.idle_ms_timeout() * 1ms, *this);
+
+      if (!conn.wait_readable(-1)) continue;
+      if (deadline != 0 && !timers.disarm(deadline)) expired = true;
+      deadline = 0;
+      if (state == thread_state::STOPPING) {
+        finish(thread_state::STOPPED);
+        continue;
+      }
+      if (expired) {
+        metrics::connection_timeouts()["idle"].inc();
+        finish(thread_state::FINISHED);
+        continue;
+      }
+
+      // replies go in a length frame if the request came in one (only peers at version 0.3 or later send them)
+      bool framed = conn.read_into(stream);
       if (stream.size() == 0) {
-        conn.close();
-        state = thread_state::FINISHED;
+        finish(thread_state::FINISHED);
       } else {
-        auto res = handle(stream);
-        bytestream strm;
-        strm << res;
-        conn.send(strm);
+        tracing::span span("request");
+        {
+          // the request and response trees only live until they're serialized
+          proto::arena_scope scope(arena);
+          session_scope auth(session);
+          proto::decompress(stream, scratch);
+          handle(stream, strm, scratch, conn.request_table());
+          metrics::request_allocations().observe(static_cast<double>(arena.allocations()));
+        }
+        conn.send(strm, framed);
+        stream.recycle();
+        strm.recycle();
+        scratch.recycle();
+        report_io(conn.stats(), seen);
+        logging::context::current().end_request();
 
         if (state == thread_state::STOPPING) {
-          conn.close();
-          state = thread_state::STOPPED;
+          finish(thread_state::STOPPED);
         }
       }
     }
   }
   catch(const tls::tls_error &err) {
-    std::cerr << "An error occurred:" << std::endl;
-    std::cerr << "  " << err.what() << std::endl;
-    std::cerr << "OpenSSL error queue: ";
-    tls_context::dump_error_queue([](){ std::cerr << std::endl << "  "; }, std::cerr);
-    std::cerr << std::endl;
+    metrics::errors()["tls"].inc();
+    logging::error("TLS error, closing connection", { { "what", err.what() }, { "openssl", tls_context::error_queue() } });
+    finish(thread_state::FINISHED);
   }
   catch(const std::exception &exc) {
-    std::cerr << "An error occurred:" << std::endl;
-    std::cerr << "  " << exc.what() << std::endl;
-    conn.close();
+    metrics::errors()["internal"].inc();
+    logging::error("Unexpected error, closing connection", { { "what", exc.what() } });
+    finish(thread_state::FINISHED);
   }
 }
\ No newline at end of file
@@ -8,8 +8,10 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "threading/thread_mgr.hpp"
+#include "threading/scheduler.hpp"
 #include "threading/thread_connection.hpp"
 #include "tls/tls_connection.hpp"
+#include "metrics/server_metrics.hpp"
 #include <mutex>
 #include <chrono>
 #include <algorithm>
@@ -26,6 +28,7 @@ thread_mgr &thread_mgr::manager() {
 void thread_mgr::enlist(tls::tls_connection &&conn) {
   std::unique_lock lock { protector };
   threads.emplace_back(std::move(conn));
+  metrics::active_connections().set((int64_t)threads.size());
 }
 
 bool is_stopped(const thread_conn &c) {
@@ -37,11 +40,17 @@ void actual_cleanup(thread_mgr::thread_set_t &threads, std::mutex &mutex) {
   threads.remove_if([](const auto &thread){
     return is_stopped(thread);
   });
+  metrics::active_connections().set((int64_t)threads.size());
 }
 
-void thread_mgr::cleanup(const std::stop_token &st) {
-  while(!st.stop_requested()) {
-    std::this_thread::sleep_for(delay * 1ms);
+thread_mgr::thread_mgr() {
+  schedule_cleanup();
+}
+
+void thread_mgr::schedule_cleanup() {
+  // re-scheduled after each run (instead of periodic), so changes to the delay are picked up
+  scheduler::instance().after("connection_cleanup", delay * 1ms, [this]() {
     actual_cleanup(threads, protector);
-  }
+    schedule_cleanup();
+  });
 }
\ No newline at end of file
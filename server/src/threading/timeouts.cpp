@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        timeouts.cpp
+// Purpose:     Shared timeouts (driven by the accept loop; impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 9:04 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "threading/timeouts.hpp"
+#include "metrics/server_metrics.hpp"
+#include <algorithm>
+
+using namespace dotchat::server;
+
+size_t &dotchat::server::timeout_tick_ms() {
+  static size_t tick = 100;
+  return tick;
+}
+
+timeouts &timeouts::instance() {
+  static timeouts res;
+  return res;
+}
+
+timeouts::timeouts() : start{std::chrono::steady_clock::now()}, tick_length{std::max<size_t>(timeout_tick_ms(), 1)} {}
+
+timeouts::id_t timeouts::arm(id_t previous, std::chrono::milliseconds after, timeout_target &target) {
+  // counted from now (not from the wheel's last tick, which may lag behind a bit)
+  auto deadline = std::chrono::steady_clock::now() - start + after;
+  auto tick = static_cast<uint64_t>((deadline + tick_length - std::chrono::nanoseconds{1}) / tick_length);
+
+  std::unique_lock guard { lock };
+  if(previous != 0) wheel.cancel(previous);
+  auto id = wheel.schedule(tick - std::min(tick, wheel.now()), reinterpret_cast<uintptr_t>(&target));
+  metrics::pending_timeouts().set(static_cast<int64_t>(wheel.size()));
+  return id;
+}
+
+bool timeouts::disarm(id_t id) {
+  if(id == 0) return false;
+  std::unique_lock guard { lock };
+  bool res = wheel.cancel(id);
+  metrics::pending_timeouts().set(static_cast<int64_t>(wheel.size()));
+  return res;
+}
+
+void timeouts::tick() {
+  auto elapsed = static_cast<uint64_t>((std::chrono::steady_clock::now() - start) / tick_length);
+  std::unique_lock guard { lock };
+  if(elapsed <= wheel.now()) return;
+  wheel.advance(elapsed - wheel.now(), [](uint64_t target) {
+    reinterpret_cast<timeout_target *>(static_cast<uintptr_t>(target))->expire();
+  });
+  metrics::pending_timeouts().set(static_cast<int64_t>(wheel.size()));
+}
\ No newline at end of file
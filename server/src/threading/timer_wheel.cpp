@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        timer_wheel.cpp
+// Purpose:     Hierarchical timer wheel (O(1) timers; impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 8:46 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "threading/timer_wheel.hpp"
+#include <algorithm>
+
+using namespace dotchat::server;
+
+timer_wheel::timer_wheel() : heads(levels << bits, none) {}
+
+timer_wheel::id_t timer_wheel::schedule(uint64_t ticks, uint64_t payload) {
+  uint32_t index;
+  if(free_head != none) {
+    index = free_head;
+    free_head = nodes[index].next;
+  }
+  else {
+    index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+  }
+
+  auto &n = nodes[index];
+  n.payload = payload;
+  n.deadline = current + std::max<uint64_t>(ticks, 1);
+  n.used = true;
+  link(index);
+  pending++;
+
+  // the serial is never 0 in a handle, so 0 is never a valid handle
+  return (static_cast<uint64_t>(n.serial + 1) << 32) | index;
+}
+
+bool timer_wheel::cancel(id_t id) {
+  auto index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+  auto serial = static_cast<uint32_t>(id >> 32);
+  if(index >= nodes.size() || !nodes[index].used || nodes[index].serial + 1 != serial) return false;
+  release(index);
+  return true;
+}
+
+void timer_wheel::link(uint32_t index) {
+  auto &n = nodes[index];
+  // the finest level which covers the deadline; timers beyond the last level wait in its furthest slot
+  uint64_t target = std::min<uint64_t>(n.deadline, current + (uint64_t{1} << (bits * levels)) - 1);
+  uint64_t delta = target - current;
+  size_t level = 0;
+  while(level + 1 < levels && delta >> (bits * (level + 1)) != 0) level++;
+
+  auto slot = static_cast<uint32_t>((level << bits) | ((target >> (bits * level)) & mask));
+  n.slot = slot;
+  n.prev = none;
+  n.next = heads[slot];
+  if(n.next != none) nodes[n.next].prev = index;
+  heads[slot] = index;
+}
+
+void timer_wheel::unlink(uint32_t index) {
+  auto &n = nodes[index];
+  if(n.prev != none) nodes[n.prev].next = n.next;
+  else heads[n.slot] = n.next;
+  if(n.next != none) nodes[n.next].prev = n.prev;
+}
+
+void timer_wheel::cascade(size_t level, size_t slot) {
+  uint32_t index = heads[(level << bits) | slot];
+  heads[(level << bits) | slot] = none;
+  while(index != none) {
+    uint32_t next = nodes[index].next;
+    link(index);
+    index = next;
+  }
+}
+
+void timer_wheel::collect(size_t slot) {
+  uint32_t index = heads[slot];
+  while(index != none) {
+    uint32_t next = nodes[index].next;
+    due.push_back(nodes[index].payload);
+    release(index);
+    index = next;
+  }
+}
+
+void timer_wheel::release(uint32_t index) {
+  unlink(index);
+  auto &n = nodes[index];
+  n.used = false;
+  n.serial++;
+  n.prev = none;
+  n.next = free_head;
+  free_head = index;
+  pending--;
+}
\ No newline at end of file
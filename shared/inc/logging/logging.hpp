@@ -0,0 +1,174 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        logging.hpp
+// Purpose:     Structured, asynchronous logging
+// Author:      jay-tux
+// Created:     October 18, 2026 1:10 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Structured, asynchronous logging.
+ */
+
+#ifndef DOTCHAT_LOGGING_HPP
+#define DOTCHAT_LOGGING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <initializer_list>
+
+/**
+ * \short Namespace containing the logging subsystem.
+ *
+ * Records are formatted as `key=value` pairs (logfmt) on the calling thread and pushed into a lock-free, per-thread
+ * queue. A background `flusher` drains these queues and writes them out in batches, so a request thread never waits
+ * on log I/O. If a queue is full, the record is dropped (and counted) instead. Without a running flusher (e.g. in the
+ * client), records are written synchronously.
+ */
+namespace dotchat::logging {
+#define DOTCHAT_LOG_LEVELS X(trace) X(debug) X(info) X(warn) X(error)
+
+/**
+ * \short Enumeration of all log levels, from least to most severe.
+ */
+enum class level {
+#define X(name) name,
+  DOTCHAT_LOG_LEVELS
+#undef X
+};
+
+/**
+ * \short Gets the minimum level for records to be logged (default: `info`).
+ * \returns A reference to the minimum level.
+ */
+std::atomic<level> &min_level();
+
+/**
+ * \short Gets the amount of records each thread may log per second (default: 200).
+ * \returns A reference to the rate limit.
+ *
+ * Records above this rate are suppressed; the amount of suppressed records is added to the next record of that
+ * thread. Records at level `error` use the same budget. A limit of 0 disables rate limiting.
+ */
+std::atomic<size_t> &per_thread_rate();
+
+/**
+ * \short Gets the amount of records dropped because a queue was full.
+ * \returns The amount of dropped records.
+ */
+size_t dropped();
+
+/**
+ * \short Structure holding the contextual fields which are added to each record of the current thread.
+ */
+struct context {
+  std::optional<size_t> connection; /*!< \short The ID of the connection handled by the thread. */
+  std::string command;              /*!< \short The command which is being handled (empty if none). */
+  std::optional<int> user;          /*!< \short The ID of the user the request is from. */
+
+  /**
+   * \short Gets the context of the current thread.
+   * \returns A reference to the thread-local context.
+   */
+  static context &current();
+
+  /**
+   * \short Clears the request-specific fields (command and user).
+   */
+  inline void end_request() {
+    command.clear();
+    user.reset();
+  }
+};
+
+/**
+ * \short Type alias for an extra field in a record.
+ */
+using field = std::pair<std::string_view, std::string>;
+
+/**
+ * \short Logs a record, if its level is high enough.
+ * \param lvl The level of the record.
+ * \param message The message.
+ * \param fields Extra fields to add to the record.
+ */
+void log(level lvl, std::string_view message, std::initializer_list<field> fields = {});
+
+/*
+ * Shorthands for each level: `trace(message, fields)`, `debug(...)`, `info(...)`, `warn(...)` and `error(...)`.
+ */
+#define X(name) \
+inline void name(std::string_view message, std::initializer_list<field> fields = {}) { \
+  log(level::name, message, fields); \
+}
+DOTCHAT_LOG_LEVELS
+#undef X
+
+/**
+ * \short Class draining the per-thread queues in the background.
+ *
+ * At most one flusher should exist at any time. On destruction, all queued records are written out.
+ */
+class flusher {
+public:
+  /**
+   * \short Starts the background flusher.
+   * \param out The stream to write to (should outlive the flusher).
+   * \param interval The time between two flushes.
+   */
+  explicit flusher(std::ostream &out, std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+  /**
+   * \short Flushers can't be copied.
+   */
+  flusher(const flusher &) = delete;
+  /**
+   * \short Flushers can't be moved.
+   */
+  flusher(flusher &&) = delete;
+  /**
+   * \short Flushers can't be copied.
+   * \returns Nothing, flushers can't be copied.
+   */
+  flusher &operator=(const flusher &) = delete;
+  /**
+   * \short Flushers can't be moved.
+   * \returns Nothing, flushers can't be moved.
+   */
+  flusher &operator=(flusher &&) = delete;
+
+  /**
+   * \short Stops the flusher, writing all remaining records.
+   */
+  ~flusher();
+
+private:
+  /**
+   * \short The function running on the background thread.
+   * \param st The stop token.
+   */
+  void run(const std::stop_token &st);
+
+  /**
+   * \short The stream to write to.
+   */
+  std::ostream &out;
+  /**
+   * \short The time between two flushes.
+   */
+  std::chrono::milliseconds interval;
+  /**
+   * \short The background thread.
+   */
+  std::jthread runner;
+};
+}
+
+#endif //DOTCHAT_LOGGING_HPP
@@ -0,0 +1,223 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        arena.hpp
+// Purpose:     Per-request arena for message trees
+// Author:      jay-tux
+// Created:     October 18, 2026 2:25 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Per-request arena for message trees.
+ */
+
+#ifndef DOTCHAT_ARENA_HPP
+#define DOTCHAT_ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <memory_resource>
+
+/**
+ * \short Namespace containing all code related to the dotchat protocol.
+ */
+namespace dotchat::proto {
+/**
+ * \short Gets the memory resource message trees are currently allocated from on this thread.
+ * \returns The active arena, or `std::pmr::new_delete_resource()` if no arena is active.
+ */
+std::pmr::memory_resource *current_resource();
+
+/**
+ * \short Class representing a monotonic arena, from which an entire message tree can be allocated and freed at once.
+ *
+ * Deallocating from an arena is a no-op; all memory is released at once by `reset`. The first few kilobytes are
+ * served from an inline buffer; larger trees get overflow chunks, which are kept in a pool after a reset, so in steady
+ * state an arena doesn't reach the heap at all.
+ */
+class arena : public std::pmr::memory_resource {
+public:
+  /**
+   * \short The size of the inline buffer.
+   */
+  constexpr const static size_t inline_size = 16 * 1024;
+
+  /**
+   * \short Constructs a new, empty arena.
+   */
+  arena() = default;
+  /**
+   * \short Arenas can't be copied.
+   */
+  arena(const arena &) = delete;
+  /**
+   * \short Arenas can't be moved.
+   */
+  arena(arena &&) = delete;
+  /**
+   * \short Arenas can't be copied.
+   * \returns Nothing, arenas can't be copied.
+   */
+  arena &operator=(const arena &) = delete;
+  /**
+   * \short Arenas can't be moved.
+   * \returns Nothing, arenas can't be moved.
+   */
+  arena &operator=(arena &&) = delete;
+
+  /**
+   * \short Releases all memory allocated from this arena, and resets the statistics.
+   *
+   * Any object still using memory from this arena is left dangling.
+   */
+  void reset();
+
+  /**
+   * \short Gets the amount of allocations served since the last reset.
+   * \returns The amount of allocations.
+   */
+  [[nodiscard]] inline size_t allocations() const { return alloc_count; }
+  /**
+   * \short Gets the amount of bytes served since the last reset.
+   * \returns The amount of bytes.
+   */
+  [[nodiscard]] inline size_t bytes() const { return alloc_bytes; }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *, size_t, size_t) override {}
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  /**
+   * \short The inline buffer.
+   */
+  alignas(std::max_align_t) std::array<std::byte, inline_size> buffer{};
+  /**
+   * \short The resource the overflow chunks are taken from; it keeps released chunks around for the next request.
+   */
+  std::pmr::unsynchronized_pool_resource upstream{
+    std::pmr::pool_options{ .max_blocks_per_chunk = 4, .largest_required_pool_block = 1024 * 1024 },
+    std::pmr::new_delete_resource()
+  };
+  /**
+   * \short The monotonic resource doing the actual work.
+   */
+  std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size(), &upstream};
+  /**
+   * \short The amount of allocations since the last reset.
+   */
+  size_t alloc_count = 0;
+  /**
+   * \short The amount of bytes allocated since the last reset.
+   */
+  size_t alloc_bytes = 0;
+};
+
+/**
+ * \short RAII class making an arena the current resource for message trees on this thread.
+ *
+ * When the scope ends, the previous resource is restored and the arena is reset. Every message (and every argument
+ * value) created within the scope must be destroyed before the scope ends.
+ */
+class arena_scope {
+public:
+  /**
+   * \short Activates the arena.
+   * \param target The arena to activate.
+   */
+  explicit arena_scope(arena &target);
+  /**
+   * \short Arena scopes can't be copied.
+   */
+  arena_scope(const arena_scope &) = delete;
+  /**
+   * \short Arena scopes can't be moved.
+   */
+  arena_scope(arena_scope &&) = delete;
+  /**
+   * \short Arena scopes can't be copied.
+   * \returns Nothing, arena scopes can't be copied.
+   */
+  arena_scope &operator=(const arena_scope &) = delete;
+  /**
+   * \short Arena scopes can't be moved.
+   * \returns Nothing, arena scopes can't be moved.
+   */
+  arena_scope &operator=(arena_scope &&) = delete;
+
+  /**
+   * \short Restores the previous resource, then resets the arena.
+   */
+  ~arena_scope();
+
+private:
+  /**
+   * \short The arena which is active in this scope.
+   */
+  arena &target;
+  /**
+   * \short The resource which was active before this scope.
+   */
+  std::pmr::memory_resource *previous;
+};
+
+/**
+ * \short Allocator which allocates from the resource that was current on this thread when it was constructed.
+ * \tparam T The type to allocate.
+ *
+ * Containers copy-constructed from another container pick up the current resource as well (rather than the resource
+ * of the original), so copying a message out of an arena scope is safe.
+ */
+template <typename T>
+struct arena_allocator : public std::pmr::polymorphic_allocator<T> {
+  /**
+   * \short Constructs an allocator for the current resource.
+   */
+  arena_allocator() noexcept : std::pmr::polymorphic_allocator<T>(current_resource()) {}
+  /**
+   * \short Constructs an allocator for the given resource.
+   * \param res The resource to allocate from.
+   */
+  arena_allocator(std::pmr::memory_resource *res) noexcept : std::pmr::polymorphic_allocator<T>(res) {}
+  /**
+   * \short Constructs an allocator sharing the resource of another allocator.
+   * \tparam U The type the other allocator allocates.
+   * \param other The allocator to share the resource of.
+   */
+  template <typename U>
+  arena_allocator(const arena_allocator<U> &other) noexcept : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+
+  /**
+   * \short Gets the allocator to use for a copy of a container.
+   * \returns An allocator for the current resource.
+   */
+  [[nodiscard]] inline arena_allocator select_on_container_copy_construction() const { return {}; }
+};
+
+/**
+ * \short Type alias for a string allocating from the current resource.
+ */
+using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+/**
+ * \short Allocates memory from the current resource, remembering which resource it came from.
+ * \param size The amount of bytes to allocate.
+ * \returns A pointer to the allocated memory.
+ *
+ * This is used as class-specific `operator new` for the types which get stored inside of `std::any`.
+ */
+void *tagged_allocate(size_t size);
+
+/**
+ * \short Deallocates memory allocated by `tagged_allocate` (to the resource it was allocated from).
+ * \param ptr The pointer to deallocate.
+ */
+void tagged_deallocate(void *ptr) noexcept;
+}
+
+#endif //DOTCHAT_ARENA_HPP
@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        byte_order.hpp
+// Purpose:     Bulk byte-order conversion for packed integer lists
+// Author:      jay-tux
+// Created:     October 18, 2026 4:12 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Bulk byte-order conversion for packed integer lists.
+ */
+
+#ifndef DOTCHAT_BYTE_ORDER_HPP
+#define DOTCHAT_BYTE_ORDER_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <concepts>
+
+/**
+ * \short Namespace containing all code related to the dotchat protocol.
+ */
+namespace dotchat::proto {
+/**
+ * \short Copies `count` 16-bit values from `src` to `dst`, reversing the byte order of each value.
+ * \param src The values to copy (need not be aligned).
+ * \param dst The buffer to copy to (need not be aligned; may not overlap with `src`).
+ * \param count The amount of values to copy.
+ *
+ * Uses AVX2 or SSSE3 if the CPU supports it, and a scalar loop otherwise.
+ */
+void swap_copy_16(const void *src, void *dst, size_t count);
+
+/**
+ * \short Copies `count` 32-bit values from `src` to `dst`, reversing the byte order of each value.
+ * \param src The values to copy (need not be aligned).
+ * \param dst The buffer to copy to (need not be aligned; may not overlap with `src`).
+ * \param count The amount of values to copy.
+ *
+ * Uses AVX2 or SSSE3 if the CPU supports it, and a scalar loop otherwise.
+ */
+void swap_copy_32(const void *src, void *dst, size_t count);
+
+/**
+ * \short Gets the instruction set used by `swap_copy_16` and `swap_copy_32` on this machine.
+ * \returns Either `"avx2"`, `"ssse3"` or `"scalar"`.
+ */
+const char *swap_copy_isa();
+
+/**
+ * \short Copies `count` integers between host and network (big-endian) byte order, in either direction.
+ * \tparam T The integer type (16- or 32-bit).
+ * \param src The values to copy.
+ * \param dst The buffer to copy to.
+ * \param count The amount of values to copy.
+ */
+template <std::integral T> requires(sizeof(T) == 2 || sizeof(T) == 4)
+inline void copy_big_endian(const void *src, void *dst, size_t count) {
+  if constexpr(std::endian::native == std::endian::big) std::memcpy(dst, src, count * sizeof(T));
+  else if constexpr(sizeof(T) == 2) swap_copy_16(src, dst, count);
+  else swap_copy_32(src, dst, count);
+}
+}
+
+#endif //DOTCHAT_BYTE_ORDER_HPP
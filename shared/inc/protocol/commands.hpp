@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        commands.hpp
+// Purpose:     Command opcodes and compile-time perfect hash for commands
+// Author:      jay-tux
+// Created:     October 18, 2026 5:48 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Command opcodes and compile-time perfect hash for commands.
+ */
+
+#ifndef DOTCHAT_COMMANDS_HPP
+#define DOTCHAT_COMMANDS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \short X-macro listing all request commands: `X(identifier, command string, opcode)`.
+ */
+#define DOTCHAT_REQUEST_COMMANDS(X) \
+  X(login, "login", 0x01)           \
+  X(logout, "logout", 0x02)         \
+  X(channel_list, "channel_lst", 0x03) \
+  X(channel_msg, "channel_msg", 0x04) \
+  X(send_msg, "msg_send", 0x05)     \
+  X(channel_details, "chan_detail", 0x06) \
+  X(new_channel, "new_chan", 0x07)  \
+  X(new_user, "new_usr", 0x08)      \
+  X(change_pass, "ch_pass", 0x09)   \
+  X(user_details, "usr_detail", 0x0A) \
+  X(invite_user, "invite", 0x0B)    \
+  X(ping, "ping", 0x0C)
+
+/**
+ * \short X-macro listing all response commands: `X(identifier, command string, opcode)`.
+ */
+#define DOTCHAT_RESPONSE_COMMANDS(X) \
+  X(okay, "ok", 0x80)                \
+  X(error, "err", 0x81)              \
+  X(pong, "pong", 0x82)
+
+/**
+ * \short Namespace containing all code related to the dotchat protocol.
+ */
+namespace dotchat::proto {
+/**
+ * \short Enumeration of all command opcodes (sent instead of the command string since protocol version 0.5).
+ */
+enum class opcode : uint8_t {
+  none = 0x00, /*!< \short Not a known command. */
+#define X(id, str, val) id = val,
+  DOTCHAT_REQUEST_COMMANDS(X)
+  DOTCHAT_RESPONSE_COMMANDS(X)
+#undef X
+};
+
+/**
+ * \short Gets the command string for an opcode.
+ * \param op The opcode.
+ * \returns The command string, or an empty string for `opcode::none` and unknown opcodes.
+ */
+constexpr std::string_view command_name(opcode op) {
+  switch(op) {
+#define X(id, str, val) case opcode::id: return str;
+    DOTCHAT_REQUEST_COMMANDS(X)
+    DOTCHAT_RESPONSE_COMMANDS(X)
+#undef X
+    default: return "";
+  }
+}
+
+/**
+ * \short Namespace for internal helper code.
+ */
+namespace _intl_ {
+/**
+ * \short Seeded FNV-1a hash used for the command table.
+ * \param cmd The command string to hash.
+ * \param seed The seed.
+ * \returns The hash of the command string.
+ */
+constexpr uint32_t command_hash(std::string_view cmd, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for(char c: cmd) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * \short Structure representing a collision-free hash table mapping command strings to opcodes.
+ */
+struct command_table {
+  /**
+   * \short The amount of slots in the table.
+   */
+  constexpr const static size_t size = 64;
+
+  /**
+   * \short The seed for which no two commands collide.
+   */
+  uint32_t seed = 0;
+  /**
+   * \short The opcode for each slot (`opcode::none` for empty slots).
+   */
+  std::array<opcode, size> slots = {};
+};
+
+/**
+ * \short Searches (at compile time) for a seed which hashes all commands to distinct slots.
+ * \returns The perfect hash table for the commands.
+ */
+consteval command_table build_command_table() {
+  constexpr std::array all {
+#define X(id, str, val) opcode::id,
+    DOTCHAT_REQUEST_COMMANDS(X)
+    DOTCHAT_RESPONSE_COMMANDS(X)
+#undef X
+  };
+
+  for(uint32_t seed = 0;; seed++) {
+    command_table table{ seed, {} };
+    bool perfect = true;
+    for(auto op: all) {
+      auto &slot = table.slots[command_hash(command_name(op), seed) % command_table::size];
+      if(slot != opcode::none) {
+        perfect = false;
+        break;
+      }
+      slot = op;
+    }
+    if(perfect) return table;
+  }
+}
+
+/**
+ * \short The perfect hash table for all commands.
+ */
+inline constexpr command_table commands = build_command_table();
+}
+
+/**
+ * \short Looks up the opcode for a command string (one hash, one table lookup and one string comparison).
+ * \param cmd The command string.
+ * \returns The opcode for the command, or `opcode::none` if the command is unknown.
+ */
+constexpr opcode command_opcode(std::string_view cmd) {
+  auto op = _intl_::commands.slots[_intl_::command_hash(cmd, _intl_::commands.seed) % _intl_::command_table::size];
+  return op != opcode::none && command_name(op) == cmd ? op : opcode::none;
+}
+
+#define X(id, str, val) static_assert(command_opcode(str) == opcode::id);
+DOTCHAT_REQUEST_COMMANDS(X)
+DOTCHAT_RESPONSE_COMMANDS(X)
+#undef X
+}
+
+#endif //DOTCHAT_COMMANDS_HPP
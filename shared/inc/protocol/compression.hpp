@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        compression.hpp
+// Purpose:     Optional zstd compression of serialized messages
+// Author:      jay-tux
+// Created:     October 18, 2026 5:02 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Optional zstd compression of serialized messages.
+ */
+
+#ifndef DOTCHAT_COMPRESSION_HPP
+#define DOTCHAT_COMPRESSION_HPP
+
+#include <string>
+#include "../tls/tls_bytestream.hpp"
+
+/**
+ * \short Namespace containing all code related to the dotchat protocol.
+ */
+namespace dotchat::proto {
+/**
+ * \short Gets the smallest serialized message size (in bytes) which is worth compressing.
+ * \returns A reference to the threshold (default 512).
+ */
+size_t &compression_threshold();
+
+/**
+ * \short Gets the zstd compression level used when no dictionary is loaded.
+ * \returns A reference to the compression level (default 3).
+ */
+int &compression_level();
+
+/**
+ * \short Gets the largest decompressed size accepted from a peer (in bytes).
+ * \returns A reference to the maximum size (default 16 MiB).
+ */
+size_t &max_decompressed_size();
+
+/**
+ * \short Loads a zstd dictionary (e.g. trained on chat text using `zstd --train`), used for all further compression.
+ * \param path The path to the dictionary file.
+ * \returns True if the dictionary was loaded, otherwise false (compression then continues without dictionary).
+ *
+ * The dictionary should be loaded once, at startup, before any message is compressed. Both peers need the same
+ * dictionary to decompress each other's messages; it's compressed using the compression level at the time of loading.
+ */
+bool load_dictionary(const std::string &path);
+
+/**
+ * \short Checks whether a dictionary is loaded.
+ * \returns True if a dictionary is loaded, otherwise false.
+ */
+bool has_dictionary();
+
+/**
+ * \short Checks whether the next message in the stream is a compressed frame.
+ * \param strm The stream to check.
+ * \returns True if the stream starts with the compressed frame magic number (0x2E 0x5A), otherwise false.
+ */
+bool is_compressed(tls::bytestream &strm);
+
+/**
+ * \short Replaces the serialized message in the stream by a compressed frame, if that's worth it.
+ * \param strm The stream containing the serialized message.
+ * \param scratch A stream used as buffer (its contents are discarded).
+ * \returns True if the message was compressed, otherwise false (the stream is left unchanged).
+ *
+ * Messages shorter than `compression_threshold()`, and messages which don't get smaller, are left as-is. Only use
+ * this for peers which support compression (see `dotchat::proto::message::uses_compression`).
+ */
+bool compress(tls::bytestream &strm, tls::bytestream &scratch);
+
+/**
+ * \short If the stream contains a compressed frame, replaces it by the decompressed message.
+ * \param strm The stream containing the (possibly compressed) message.
+ * \param scratch A stream used as buffer (its contents are discarded).
+ * \returns True if the message was decompressed, otherwise false (the stream is left unchanged).
+ * \throws `dotchat::proto::message_error` if the frame is malformed, too large, or needs an unknown dictionary.
+ */
+bool decompress(tls::bytestream &strm, tls::bytestream &scratch);
+}
+
+#endif //DOTCHAT_COMPRESSION_HPP
@@ -0,0 +1,103 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        header_table.hpp
+// Purpose:     Per-connection table of command names and keys (header compression)
+// Author:      jay-tux
+// Created:     October 18, 2026 7:35 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Per-connection table of command names and keys (header compression).
+ */
+
+#ifndef DOTCHAT_HEADER_TABLE_HPP
+#define DOTCHAT_HEADER_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * \short Namespace containing all code related to the dotchat protocol.
+ */
+namespace dotchat::proto {
+/**
+ * \short Class representing the table of command names and keys seen on a connection (in one direction).
+ *
+ * Since protocol version 0.7, each command name or key sent in a request is added to the table of the connection; when
+ * it's sent again, only its (one-byte) index in the table is sent. Both peers keep their own copy of the table, and
+ * add each name in the same order (the order they're sent and read in), so the indices always match. The table only
+ * grows (up to `capacity` names); names sent after that are always sent in full.
+ */
+class header_table {
+public:
+  /**
+   * \short The maximum amount of names in the table (indices 0 up to 126 are sent as `0x80 | index`).
+   */
+  constexpr const static size_t capacity = 127;
+
+  /**
+   * \short Looks up a name in the table.
+   * \param name The command name or key to look up.
+   * \returns The index of the name, or `std::nullopt` if it's not in the table.
+   */
+  [[nodiscard]] std::optional<uint8_t> find(std::string_view name) const;
+
+  /**
+   * \short Gets the name at an index in the table.
+   * \param index The index of the name.
+   * \returns A reference to the name.
+   * \throws `dotchat::proto::message_error` if there's no name at that index.
+   */
+  [[nodiscard]] const std::string &at(uint8_t index) const;
+
+  /**
+   * \short Adds a name to the table, unless it's already in the table or the table is full.
+   * \param name The command name or key to add.
+   */
+  void add(std::string_view name);
+
+  /**
+   * \short Removes all names added after the table had the given size (used if a message couldn't be sent after all).
+   * \param size The size to shrink the table back to.
+   */
+  void truncate(size_t size);
+
+  /**
+   * \short Gets the amount of names in the table.
+   * \returns The size of the table.
+   */
+  [[nodiscard]] inline size_t size() const { return names.size(); }
+
+private:
+  /**
+   * \short Hash functor for names, allowing lookups using string views.
+   */
+  struct name_hash {
+    using is_transparent = void; /*!< \short Marks the hash as transparent. */
+
+    /**
+     * \short Hashes a name.
+     * \param name The name to hash.
+     * \returns The hash of the name.
+     */
+    inline size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+  };
+
+  /**
+   * \short The names in the table, in the order they were added.
+   */
+  std::vector<std::string> names;
+  /**
+   * \short The index of each name in the table.
+   */
+  std::unordered_map<std::string, uint8_t, name_hash, std::equal_to<>> indices;
+};
+}
+
+#endif //DOTCHAT_HEADER_TABLE_HPP
@@ -18,6 +18,7 @@
 #include <string>
 #include "protocol/message.hpp"
 #include "protocol/requests.hpp"
+#include "tracing/tracing.hpp"
 
 /**
  * \short Namespace containing all code related to the dotchat protocol.
@@ -56,6 +57,23 @@ static T require_arg(const std::string &key, const message::arg_obj &source) {
   return source[key].get<proto::_intl_::matching_enum<T>::val>();
 }
 
+/**
+ * \short Helper function to extract a list from an arg_obj without copying it.
+ * \param key The key of the list to extract.
+ * \param source The arg_obj to search.
+ * \returns A reference to the list (if present).
+ * \throws `dotchat::proto::proto_error` if the key is not present or it isn't a list.
+ */
+inline const message::arg_list &require_list(const std::string &key, const message::arg_obj &source) {
+  if (!source.contains(key)) {
+    throw proto_error("Key `" + key + "` not present.");
+  }
+  if (source.type(key) != message::arg_type::LIST) {
+    throw proto_error("Key `" + key + "` doesn't have the correct type.");
+  }
+  return source[key].list_ref();
+}
+
 /**
  * \short Wraps a reply function, converting a `Req -> Res` function to `const message & -> message`.
  * \tparam Req The request type. Should satisfy `dotchat::proto::from_message_convertible<Req>`.
@@ -66,16 +84,16 @@ static T require_arg(const std::string &key, const message::arg_obj &source) {
  * \returns The reply of the function, or an error message.
  *
  * This function tries to construct an object of type `Req` by using `static Req::from(const message &)`; which is
- * passed as argument to `f`. The result of the function is returned from the function using `Res::to()`. If any
- * `dotchat::proto::proto_error` occurs, it is caught and an error message is returned instead (using
- * `dotchat::proto::responses::error_response::to()`.
+ * passed as argument to `f`. The result of the function is returned from the function using `Res::to()` (called on an
+ * rvalue, so a response may move its contents into the message). If any `dotchat::proto::proto_error` occurs, it is
+ * caught and an error message is returned instead (using `dotchat::proto::responses::error_response::to()`.
  */
 template <from_message_convertible Req, to_message_convertible Res, typename Fun>
 message reply_to(const message &m, Fun &&f) requires(response_fun<Fun, Req, Res>) {
   try {
-    Req req = Req::from(m);
-    Res res = f(req);
-    return res.to();
+    Req req = tracing::traced("Req::from", [&m]() { return Req::from(m); });
+    Res res = tracing::traced("handler", [&f, &req]() { return f(req); });
+    return tracing::traced("Res::to", [&res]() { return std::move(res).to(); });
   }
   catch(const proto_error &e) {
     return responses::error_response{ .reason = e.what() }.to();
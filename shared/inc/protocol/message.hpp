@@ -16,12 +16,20 @@
 #define DOTCHAT_CLIENT_MESSAGE_HPP
 
 #include <map>
+#include <vector>
 #include <string>
+#include <string_view>
 #include <concepts>
 #include <any>
+#include <algorithm>
+#include <span>
+#include <variant>
 #include <utility>
 #include <stdexcept>
 #include "../tls/tls_bytestream.hpp"
+#include "arena.hpp"
+#include "commands.hpp"
+#include "header_table.hpp"
 
 /**
  * \short Namespace containing all code related to the dotchat protocol.
@@ -149,6 +157,20 @@ concept is_trivially_repr = one_of<
     matching_type_t<val_types::CHAR>, matching_type_t<val_types::STRING>
 >::val;
 
+/**
+ * \short Concept relaying the meaning of a packable value.
+ * \tparam T The type to check.
+ *
+ * Packable types are 16- and 32-bit signed and unsigned integers; lists of these are stored (and sent) as contiguous
+ * arrays instead of as separate argument values.
+ */
+template <typename T>
+concept is_packable = one_of<
+    T,
+    matching_type_t<val_types::INT16>, matching_type_t<val_types::INT32>,
+    matching_type_t<val_types::UINT16>, matching_type_t<val_types::UINT32>
+>::val;
+
 /**
  * \short Class representing a single argument value (a wrapper around `std::any`).
  */
@@ -165,7 +187,7 @@ public:
    * \param val T The value to convert.
    */
   template <is_trivially_repr T>
-  explicit inline arg(const T &val) : _type{matching_enum<T>::val}, _content{val} {}
+  explicit inline arg(const T &val) : _type{matching_enum<T>::val}, _content{box(val)} {}
   /**
    * \short Converts a `dotchat::proto::_intl_::arg_list` to an argument value.
    * \param The list to convert.
@@ -176,6 +198,21 @@ public:
    * \param The object to convert.
    */
   explicit arg(const arg_obj &val);
+  /**
+   * \short Moves a `dotchat::proto::_intl_::arg_list` into an argument value.
+   * \param The list to move.
+   */
+  explicit arg(arg_list &&val);
+  /**
+   * \short Moves a `dotchat::proto::_intl_::arg_obj` into an argument value.
+   * \param The object to move.
+   */
+  explicit arg(arg_obj &&val);
+  /**
+   * \short Moves a string allocated from the current arena into an argument value (without copying it to the heap).
+   * \param val The string to move.
+   */
+  explicit inline arg(arena_string &&val) : _type{val_types::STRING}, _content{string_box{ std::move(val) }} {}
 
   /**
    * \short Gets the type currently contained in the argument value.
@@ -190,7 +227,7 @@ public:
    * \throws `std::bad_any_cast` if the contained value is not of the requested type.
    */
   template <val_types T>
-  inline matching_type_t<T> get() const { return std::any_cast<matching_type_t<T>>(_content); }
+  inline matching_type_t<T> get() const { return unbox<matching_type_t<T>>(); }
 
   /**
    * \short Assigns a new `dotchat::proto::_intl_::is_trivially_repr` value to this argument value, erasing all
@@ -203,7 +240,7 @@ public:
   arg &operator=(const T &val) {
     _type = matching_enum<T>::val;
     _content.reset();
-    _content = val;
+    _content = box(val);
     return *this;
   }
 
@@ -231,7 +268,7 @@ public:
    */
   template <is_trivially_repr T>
   explicit operator T() const {
-    if(_type == matching_enum<T>::val) return std::any_cast<T>(_content);
+    if(_type == matching_enum<T>::val) return unbox<T>();
     else throw std::bad_any_cast();
   }
 
@@ -249,7 +286,77 @@ public:
    */
   explicit operator arg_obj() const;
 
+  /**
+   * \short Gets a view on the contained string, without copying it.
+   * \returns A view on the contained string (valid as long as this argument value is unchanged).
+   * \throws `std::bad_any_cast` if the contained value is not a string.
+   */
+  [[nodiscard]] inline std::string_view string_view() const {
+    const auto &boxed = std::any_cast<const string_box &>(_content);
+    return { boxed.value.data(), boxed.value.size() };
+  }
+
+  /**
+   * \short Gets a reference to the contained list, without copying it.
+   * \returns A reference to the contained list.
+   * \throws `std::bad_any_cast` if the contained value is not a list.
+   */
+  [[nodiscard]] const arg_list &list_ref() const;
+
+  /**
+   * \short Gets a reference to the contained sub-object, without copying it.
+   * \returns A reference to the contained sub-object.
+   * \throws `std::bad_any_cast` if the contained value is not a sub-object.
+   */
+  [[nodiscard]] const arg_obj &obj_ref() const;
+
 private:
+  /**
+   * \short Structure holding a string value, so it (and its characters) can be allocated from the current arena.
+   */
+  struct string_box {
+    arena_string value; /*!< \short The actual string. */
+
+    /**
+     * \short Allocates a box from the current arena.
+     * \param size The size to allocate.
+     * \returns A pointer to the allocated memory.
+     */
+    inline static void *operator new(size_t size) { return tagged_allocate(size); }
+    /**
+     * \short Deallocates a box allocated using `operator new`.
+     * \param ptr The pointer to deallocate.
+     */
+    inline static void operator delete(void *ptr) noexcept { tagged_deallocate(ptr); }
+  };
+
+  /**
+   * \short Wraps a value so it can be stored in `_content` (strings are boxed, other values are stored as-is).
+   * \tparam T The type of the value.
+   * \param val The value to wrap.
+   * \returns The wrapped value.
+   */
+  template <is_trivially_repr T>
+  inline static std::any box(const T &val) {
+    if constexpr(std::same_as<T, std::string>) return string_box{ arena_string(val.data(), val.size()) };
+    else return val;
+  }
+
+  /**
+   * \short Unwraps the value stored in `_content`.
+   * \tparam T The type of the value.
+   * \returns A copy of the stored value.
+   * \throws `std::bad_any_cast` if the contained value is not of the requested type.
+   */
+  template <typename T>
+  inline T unbox() const {
+    if constexpr(std::same_as<T, std::string>) {
+      const auto &boxed = std::any_cast<const string_box &>(_content);
+      return { boxed.value.data(), boxed.value.size() };
+    }
+    else return std::any_cast<T>(_content);
+  }
+
   /**
    * \short The type contained in this argument value.
    */
@@ -261,15 +368,55 @@ private:
 };
 
 /**
- * \short Class representing a list of argument values (wrapper around `std::vector<dotchat::proto::_intl_::arg>`).
+ * \short Class representing a list of argument values (wrapper around `std::vector<dotchat::proto::_intl_::arg>`,
+ * allocating from the current arena; see `dotchat::proto::arena_scope`).
+ *
+ * Lists of `dotchat::proto::_intl_::is_packable` values are stored packed (as a contiguous array of the actual type);
+ * other lists are stored as argument values. The form is chosen when the list gets its first element (or is assigned
+ * packed values), and never changes afterwards: reading a list (even as argument values, through `value` or iteration)
+ * doesn't modify it, so a list can be read from multiple threads at once. `packed` gives direct access to the array.
  */
 class arg_list {
 public:
+  /**
+   * \short Type alias for the vector type.
+   */
+  using vector_type = std::vector<arg, arena_allocator<arg>>;
+  /**
+   * \short Type alias for the vector type of packed lists.
+   * \tparam T The type of the elements.
+   */
+  template <is_packable T>
+  using packed_vector = std::vector<T, arena_allocator<T>>;
+  /**
+   * \short Type alias for the packed storage (empty if the list is not packed).
+   */
+  using packed_type = std::variant<
+      std::monostate, packed_vector<int16_t>, packed_vector<int32_t>, packed_vector<uint16_t>, packed_vector<uint32_t>
+  >;
+
+  /**
+   * \short Allocates a list from the current arena (used when a list is stored in an argument value).
+   * \param size The size to allocate.
+   * \returns A pointer to the allocated memory.
+   */
+  inline static void *operator new(size_t size) { return tagged_allocate(size); }
+  /**
+   * \short Deallocates a list allocated using `operator new`.
+   * \param ptr The pointer to deallocate.
+   */
+  inline static void operator delete(void *ptr) noexcept { tagged_deallocate(ptr); }
+
   /**
    * \short Gets the size of the list.
    * \returns The amount of elements contained in the list.
    */
-  [[nodiscard]] inline size_t size() const { return _content.size(); }
+  [[nodiscard]] inline size_t size() const {
+    return std::visit([this]<typename V>(const V &packed) -> size_t {
+      if constexpr(std::same_as<V, std::monostate>) return _content.size();
+      else return packed.size();
+    }, _packed);
+  }
   /**
    * \short Gets the type of the elements contained in the list.
    * \returns The type of the elements contained in the list.
@@ -279,14 +426,28 @@ public:
    * \short Accesses the `n`-th element from the list (as an argument value).
    * \param n The index of the element.
    * \returns A reference to the argument value at index `n`.
+   * \throws `std::bad_any_cast` if the list is packed (use `get_as` instead).
    */
-  inline arg &operator[](size_t n) { return _content[n]; }
+  inline arg &operator[](size_t n) {
+    if(is_packed()) throw std::bad_any_cast();
+    return _content[n];
+  }
   /**
    * \short Accesses the `n`-th element from the list (as an argument value).
    * \param n The index of the element.
    * \returns A constant reference to the argument value at index `n`.
+   * \throws `std::bad_any_cast` if the list is packed (use `get_as`, `packed` or `value` instead).
+   */
+  inline const arg &operator[](size_t n) const {
+    if(is_packed()) throw std::bad_any_cast();
+    return _content[n];
+  }
+  /**
+   * \short Reads the `n`-th element from the list (as an argument value), whether the list is packed or not.
+   * \param n The index of the element.
+   * \returns A copy of the argument value at index `n` (for a packed list, it's built from the packed value).
    */
-  inline const arg &operator[](size_t n) const { return _content[n]; }
+  [[nodiscard]] arg value(size_t n) const;
 
   /**
    * \short Accesses the `n`-th element from the list (as its actual value).
@@ -297,6 +458,9 @@ public:
    */
   template <typename T>
   inline T &get_as(size_t n) {
+    if constexpr(is_packable<T>) {
+      if(auto *packed = std::get_if<packed_vector<T>>(&_packed)) return (*packed)[n];
+    }
     if(_contained == matching_enum<T>::val)
       return *std::any_cast<T *>(&_content[n]);
     else
@@ -348,6 +512,9 @@ public:
    */
   template <typename T>
   inline const T &get_as(size_t n) const {
+    if constexpr(is_packable<T>) {
+      if(auto *packed = std::get_if<packed_vector<T>>(&_packed)) return (*packed)[n];
+    }
     if(_contained == matching_enum<T>::val)
       return std::any_cast<T>(_content[n]);
     else
@@ -399,14 +566,73 @@ public:
    */
   template <is_trivially_repr T>
   inline void push_back(const T &val) {
-    if(_content.empty())
-      _contained = matching_enum<T>::val;
-    if(_contained == matching_enum<T>::val)
-      _content.emplace_back(val);
-    else
+    if(size() == 0)
+      start(matching_enum<T>::val);
+    if(_contained != matching_enum<T>::val)
+      throw std::bad_any_cast();
+
+    if constexpr(is_packable<T>) {
+      if(auto *packed = std::get_if<packed_vector<T>>(&_packed)) {
+        packed->push_back(val);
+        return;
+      }
+    }
+    _content.emplace_back(val);
+  }
+
+  /**
+   * \short If this list holds elements of type `T`, adds all given elements to the end (straight into the packed array).
+   * \tparam T The type of the values to add; should satisfy `dotchat::proto::_intl_::is_packable<T>`.
+   * \param values The values to add.
+   * \throws `std::bad_any_cast` if the contained values do not match `T`.
+   */
+  template <is_packable T>
+  void append(std::span<const T> values) {
+    if(size() == 0)
+      start(matching_enum<T>::val);
+    if(_contained != matching_enum<T>::val)
       throw std::bad_any_cast();
+
+    if(auto *packed = std::get_if<packed_vector<T>>(&_packed))
+      packed->insert(packed->end(), values.begin(), values.end());
+    else
+      for(const auto &val: values) _content.emplace_back(val);
+  }
+
+  /**
+   * \short Gets a view on the contained values, as a contiguous array of type `T`.
+   * \tparam T The type of the values; should satisfy `dotchat::proto::_intl_::is_packable<T>`.
+   * \returns A span over the contained values (valid until the list is modified).
+   * \throws `std::bad_any_cast` if the list is not empty and the contained values do not match `T`.
+   */
+  template <is_packable T>
+  [[nodiscard]] std::span<const T> packed() const {
+    if(size() == 0) return {};
+    const auto *src = std::get_if<packed_vector<T>>(&_packed);
+    if(_contained != matching_enum<T>::val || src == nullptr) throw std::bad_any_cast();
+    return { src->data(), src->size() };
+  }
+
+  /**
+   * \short Replaces the contents of this list by `n` packed values of type `T`, to be filled in directly.
+   * \tparam T The type of the values; should satisfy `dotchat::proto::_intl_::is_packable<T>`.
+   * \param n The amount of values.
+   * \returns A span over the (zero-initialized) values.
+   */
+  template <is_packable T>
+  std::span<T> assign_packed(size_t n) {
+    _contained = matching_enum<T>::val;
+    _content.clear();
+    auto &dst = _packed.template emplace<packed_vector<T>>(n);
+    return { dst.data(), dst.size() };
   }
 
+  /**
+   * \short Checks whether this list is currently stored packed.
+   * \returns True if the list's values are stored as a contiguous array, otherwise false.
+   */
+  [[nodiscard]] inline bool is_packed() const { return !std::holds_alternative<std::monostate>(_packed); }
+
   /**
    * \short If this list holds sublists, adds the given sublist to the end.
    * \param val The sublist to add.
@@ -426,11 +652,14 @@ public:
    * \param val The argument value.
    * \throws `std::bad_any_cast` if the contained values do not match.
    */
-  inline void push_back(const arg &arg) {
-    if(_content.empty()) _contained = arg.type();
-    if(arg.type() != _contained) throw std::bad_any_cast();
-    _content.push_back(arg);
-  }
+  void push_back(const arg &arg);
+
+  /**
+   * \short If the type of the elements of this list matches the type of the argument value, moves it to the end.
+   * \param val The argument value.
+   * \throws `std::bad_any_cast` if the contained values do not match.
+   */
+  void push_back(arg &&arg);
 
   template <typename T> struct iterable;
 
@@ -446,7 +675,7 @@ public:
      * \param idx The index to point at.
      * \param source The source vector.
      */
-    iterator(size_t idx, std::vector<arg> &source) : idx{idx}, source{source} {}
+    iterator(size_t idx, vector_type &source) : idx{idx}, source{source} {}
 
     /**
      * \short The index this iterator points at.
@@ -455,7 +684,7 @@ public:
     /**
      * \short A reference to the source vector.
      */
-    std::vector<arg> &source;
+    vector_type &source;
   public:
     /**
      * \short Dereferences the iterator, returning the value it points to.
@@ -482,31 +711,35 @@ public:
   /**
    * \short A constant, non-modifiable iterator over an argument value list.
    *
-   * This struct is a wrapper around `std::vector<arg>::const_iterator`.
+   * This struct is a wrapper around an index into the list (see `value`).
    */
   struct const_iterator {
     /**
      * \short Dereferences this iterator, returning the argument value it points to.
      * \returns A copy of the argument value this iterator points to.
      */
-    inline arg operator*() const { return *it; }
+    inline arg operator*() const { return list->value(idx); }
     /**
      * \short Increments this iterator, returning a new iterator pointing to the next element.
      * \returns A new iterator to the next element in the sequence.
      */
-    inline const_iterator operator++() { return { ++it }; }
+    inline const_iterator operator++() { return { list, ++idx }; }
     /**
      * \short Compares two iterators for inequality.
      * \returns True if both iterators point to different elements, otherwise false.
      */
     inline bool operator!=(const const_iterator &other) const {
-      return it != other.it;
+      return list != other.list || idx != other.idx;
     }
 
     /**
-     * The wrapped iterator.
+     * The list iterated over.
+     */
+    const arg_list *list;
+    /**
+     * The index of the element the iterator points to.
      */
-    std::vector<arg>::const_iterator it;
+    size_t idx;
   };
 
   /**
@@ -520,12 +753,12 @@ public:
      * \short Wraps the data source of an argument value list in a `dotchat::proto::_intl_::arg_list::iterable<T>`.
      * \param source The data source to wrap.
      */
-    explicit iterable(std::vector<arg> &source) : source{source} {}
+    explicit iterable(vector_type &source) : source{source} {}
 
     /**
      * A reference to the original data source.
      */
-    std::vector<arg> &source;
+    vector_type &source;
   public:
     /**
      * \short Constructs a new type-safe iterator to the first element in the data source.
@@ -545,11 +778,11 @@ public:
    * \short Attempts to wrap this argument value list in a `dotchat::proto::_intl_::arg_list::iterable<T>`.
    * \tparam T The type for the iterator; should satisfy `dotchat::proto::_intl_::is_trivially_repr<T>`.
    * \returns A type-safe iterable object over this argument value list.
-   * \throws `std::bad_any_cast` if `T` doesn't match the contained type.
+   * \throws `std::bad_any_cast` if `T` doesn't match the contained type, or if the list is packed.
    */
   template <is_trivially_repr T>
   iterable<T> iterable_for() {
-    if(_contained == matching_enum<T>::val)
+    if(!is_packed() && _contained == matching_enum<T>::val)
       return arg_list::iterable<arg_list>{ _content };
     else
       throw std::bad_any_cast();
@@ -591,36 +824,59 @@ public:
    * \short Constructs an iterator to the beginning of the vector.
    * \return A const_iterator to the beginning of the underlying vector.
    */
-  [[nodiscard]] inline const_iterator begin() const { return { _content.cbegin() }; }
+  [[nodiscard]] inline const_iterator begin() const { return { this, 0 }; }
   /**
    * \short Constructs an iterator past the end of the vector.
    * \return A const_iterator past the end of the underlying vector.
    */
-  [[nodiscard]] inline const_iterator end() const { return { _content.cend() }; }
+  [[nodiscard]] inline const_iterator end() const { return { this, size() }; }
 
 private:
+  /**
+   * \short Empties the list and makes it hold values of the given type (packed, if possible).
+   * \param type The type of the values the list will hold.
+   */
+  void start(val_types type);
+
   /**
    * \short The type of values contained in this list.
    */
   val_types _contained = arg().type();
   /**
-   * \short The content of the list, as argument values.
+   * \short The content of the list, as argument values (empty if the list is packed).
+   */
+  vector_type _content;
+  /**
+   * \short The content of the list, as a contiguous array (if the list is packed).
    */
-  std::vector<arg> _content;
+  packed_type _packed;
 };
 
 /**
  * \brief Class representing a set of key-value-pairs where each key is a `std::string` and each value is an argument
  * value.
  *
- * Wrapper around an `std::map<std::string, dotchat::proto::_intl_::arg>, std::less<>>`.
+ * Wrapper around an `std::map<std::string, dotchat::proto::_intl_::arg>, std::less<>>`, allocating its nodes from the
+ * current arena (see `dotchat::proto::arena_scope`).
  */
 class arg_obj {
 public:
   /**
    * \brief Type alias for the map type.
    */
-  using map_type = std::map<std::string, arg, std::less<>>;
+  using map_type = std::map<std::string, arg, std::less<>, arena_allocator<std::pair<const std::string, arg>>>;
+
+  /**
+   * \short Allocates an object from the current arena (used when an object is stored in an argument value).
+   * \param size The size to allocate.
+   * \returns A pointer to the allocated memory.
+   */
+  inline static void *operator new(size_t size) { return tagged_allocate(size); }
+  /**
+   * \short Deallocates an object allocated using `operator new`.
+   * \param ptr The pointer to deallocate.
+   */
+  inline static void operator delete(void *ptr) noexcept { tagged_deallocate(ptr); }
 
   /**
    * \brief Returns true if the given key is present.
@@ -700,6 +956,14 @@ public:
     values[val.first] = val.second;
   }
 
+  /**
+   * \short Changes the value corresponding to the given key, or adds it to the set, by moving.
+   * \param val The key-value pair to modify/add.
+   */
+  inline void set(std::pair<std::string, arg> &&val) {
+    values.insert_or_assign(std::move(val.first), std::move(val.second));
+  }
+
   /**
    * \short Iterator type which iterates over all keys in the set (wrapper around
    * `dotchat::proto::_intl_::arg_obj::map_type`).
@@ -741,6 +1005,12 @@ public:
    */
   [[nodiscard]] iterator end() const { return {values.end()}; }
 
+  /**
+   * \short Gets the underlying map, to iterate over all key-value pairs without copying them.
+   * \returns A constant reference to the underlying map.
+   */
+  [[nodiscard]] inline const map_type &entries() const { return values; }
+
 private:
   /**
    * The actual value collection.
@@ -814,8 +1084,11 @@ public:
   /**
    * \short Reads the next message in the byte stream.
    * \param stream The stream to read from.
+   * \param table The header table of the connection the message was read from (only used since protocol version 0.7,
+   * see `uses_header_table`), or `nullptr` if names are never sent as indices.
+   * \throws `dotchat::proto::message_error` if the message is malformed or truncated.
    */
-  explicit message(tls::bytestream &stream);
+  explicit message(tls::bytestream &stream, header_table *table = nullptr);
 
   /**
    * \short Constructs a message from a command and a set of key-value pairs.
@@ -864,6 +1137,11 @@ public:
    * \returns A constant reference to the command.
    */
   [[nodiscard]] inline const command &get_command() const { return cmd; }
+  /**
+   * \short Gets the opcode for this message's command (using the compile-time perfect hash over all commands).
+   * \returns The opcode, or `dotchat::proto::opcode::none` if the command is unknown.
+   */
+  [[nodiscard]] inline opcode get_opcode() const { return command_opcode(cmd); }
 
   /**
    * \short Returns the preferred major protocol version for this implementation.
@@ -872,9 +1150,155 @@ public:
   inline static byte preferred_major_version() { return 0x00; }
   /**
    * \short Returns the preferred minor protocol version for this implementation.
-   * \returns The preferred minor version (0x01).
+   * \returns The preferred minor version (0x09).
+   */
+  inline static byte preferred_minor_version() { return 0x09; }
+  /**
+   * \short Gets the protocol version every server understands (servers running 0.1 reject higher minor versions).
+   * \returns The minor protocol version (0x01).
+   */
+  inline static byte initial_minor_version() { return 0x01; }
+  /**
+   * \short Returns the first minor protocol version supporting compact (varint) integers and list lengths.
+   * \returns The first minor version with compact integers (0x02).
+   */
+  inline static byte compact_minor_version() { return 0x02; }
+  /**
+   * \short Returns the first minor protocol version supporting long strings (with a 32-bit length).
+   * \returns The first minor version with long strings (0x03).
+   */
+  inline static byte long_string_minor_version() { return 0x03; }
+  /**
+   * \short Returns the first minor protocol version supporting compressed frames (see `dotchat::proto::compress`).
+   * \returns The first minor version with compressed frames (0x04).
+   */
+  inline static byte compression_minor_version() { return 0x04; }
+  /**
+   * \short Returns the first minor protocol version supporting command opcodes (see `dotchat::proto::opcode`).
+   * \returns The first minor version with command opcodes (0x05).
+   */
+  inline static byte opcode_minor_version() { return 0x05; }
+  /**
+   * \short Returns the first minor protocol version supporting columnar lists of sub-objects (tables).
+   * \returns The first minor version with tables (0x06).
+   */
+  inline static byte columnar_minor_version() { return 0x06; }
+  /**
+   * \short Returns the first minor protocol version supporting indexed names (see `dotchat::proto::header_table`).
+   * \returns The first minor version with indexed names (0x07).
+   */
+  inline static byte header_table_minor_version() { return 0x07; }
+  /**
+   * \short Returns the first minor protocol version in which connections are bound to sessions (so requests on them may
+   * leave out their token, see `dotchat::proto::requests::token_request::bound_token`).
+   * \returns The first minor version with bound sessions (0x08).
+   */
+  inline static byte bound_session_minor_version() { return 0x08; }
+  /**
+   * \short Returns the first minor protocol version in which the server hands out signed tokens (sent as strings, see
+   * `dotchat::proto::token_t`).
+   * \returns The first minor version with signed tokens (0x09).
+   */
+  inline static byte signed_token_minor_version() { return 0x09; }
+
+  /**
+   * \short Gets the major protocol version of this message (for received messages, the version the peer sent).
+   * \returns The major protocol version.
+   */
+  [[nodiscard]] inline byte major_version() const { return protocol_major; }
+  /**
+   * \short Gets the minor protocol version of this message (for received messages, the version the peer sent).
+   * \returns The minor protocol version.
    */
-  inline static byte preferred_minor_version() { return 0x01; }
+  [[nodiscard]] inline byte minor_version() const { return protocol_minor; }
+
+  /**
+   * \short Lowers the protocol version of this message to the given version, if that's lower than the preferred one.
+   * \param major The major version the peer supports.
+   * \param minor The minor version the peer supports.
+   *
+   * The version of a message decides which encodings `send_to` may use; replies should be negotiated down to the
+   * version of the request they answer.
+   */
+  inline void negotiate(byte major, byte minor) {
+    if(major < preferred_major_version()) {
+      protocol_major = major;
+      protocol_minor = minor;
+    }
+    else {
+      protocol_major = preferred_major_version();
+      protocol_minor = major == preferred_major_version() ? std::min(minor, preferred_minor_version()) : preferred_minor_version();
+    }
+  }
+  /**
+   * \short Lowers the protocol version of this message to the version of the given (received) message.
+   * \param peer The message received from the peer.
+   */
+  inline void negotiate(const message &peer) { negotiate(peer.protocol_major, peer.protocol_minor); }
+
+  /**
+   * \short Checks whether this message may use compact (varint) integers and list lengths.
+   * \returns True if the protocol version is at least 0.2, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_compact() const {
+    return protocol_major > 0 || protocol_minor >= compact_minor_version();
+  }
+  /**
+   * \short Checks whether this message may send strings longer than 255 characters (as long strings).
+   * \returns True if the protocol version is at least 0.3, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_long_strings() const {
+    return protocol_major > 0 || protocol_minor >= long_string_minor_version();
+  }
+  /**
+   * \short Checks whether this message is sent in a length frame (see `dotchat::tls::tls_connection::send`).
+   * \returns True if the protocol version is at least 0.3, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_length_frames() const {
+    return protocol_major > 0 || protocol_minor >= long_string_minor_version();
+  }
+  /**
+   * \short Checks whether this message may be sent as a compressed frame.
+   * \returns True if the protocol version is at least 0.4, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_compression() const {
+    return protocol_major > 0 || protocol_minor >= compression_minor_version();
+  }
+  /**
+   * \short Checks whether this message may send its command as a one-byte opcode.
+   * \returns True if the protocol version is at least 0.5, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_opcodes() const {
+    return protocol_major > 0 || protocol_minor >= opcode_minor_version();
+  }
+  /**
+   * \short Checks whether this message may send lists of similar sub-objects as tables (column by column).
+   * \returns True if the protocol version is at least 0.6, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_columnar() const {
+    return protocol_major > 0 || protocol_minor >= columnar_minor_version();
+  }
+  /**
+   * \short Checks whether this message may send its command and keys as indices in a header table.
+   * \returns True if the protocol version is at least 0.7, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_header_table() const {
+    return protocol_major > 0 || protocol_minor >= header_table_minor_version();
+  }
+  /**
+   * \short Checks whether the peer binds connections to sessions (so token requests may leave out their token).
+   * \returns True if the protocol version is at least 0.8, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_bound_sessions() const {
+    return protocol_major > 0 || protocol_minor >= bound_session_minor_version();
+  }
+  /**
+   * \short Checks whether the peer hands out (or accepts) signed tokens.
+   * \returns True if the protocol version is at least 0.9, otherwise false.
+   */
+  [[nodiscard]] inline bool uses_signed_tokens() const {
+    return protocol_major > 0 || protocol_minor >= signed_token_minor_version();
+  }
 
   /**
    * \short Checks whether the two given bytes match the magic number (0x2E 0x43).
@@ -889,11 +1313,20 @@ public:
   /**
    * \short Writes this message to the given TLS byte stream.
    * \param strm The stream to write to.
+   * \param table The header table of the connection the message is sent on (only used since protocol version 0.7, see
+   * `uses_header_table`), or `nullptr` to send all names in full.
+   *
+   * If the message's version allows it (see `uses_compact`), 16- and 32-bit integers are sent as varints whenever that
+   * is shorter, and list lengths are always sent as varints. Likewise (see `uses_long_strings`), string values longer
+   * than 255 characters are sent as long strings, (see `uses_opcodes`) known commands are sent as opcodes, and (see
+   * `uses_columnar`) lists of sub-objects with the same keys and value types are sent as tables. If a header table is
+   * given, names already in the table are sent as their index, and other names are added to it.
    * \throws `dotchat::proto::message_error` if the map of any of its sub-objects has more than 255 keys.
-   * \throws `dotchat::proto::message_error` if the command or any string value (including keys) is longer than 255
-   * characters.
+   * \throws `dotchat::proto::message_error` if the command or any key is longer than 255 characters.
+   * \throws `dotchat::proto::message_error` if any string value is longer than 255 characters, and the message's version
+   * doesn't support long strings.
    */
-  void send_to(tls::bytestream &strm) const;
+  void send_to(tls::bytestream &strm, header_table *table = nullptr) const;
 
   /**
    * \short Inserts this message into the given TLS byte stream.
@@ -935,6 +1368,8 @@ private:
  * protocol_version (2 bytes; major minor)
  * cmd_len (1 byte)
  * cmd (n bytes; indicated by cmd_len)
+ *   since 0.5, known commands: cmd_len 0x00, followed by opcode (1 byte)
+ *   since 0.7 (requests), commands in the header table: 0x80 | index (1 byte)
  * arg_count (1 byte)
  * args.
  */
@@ -943,6 +1378,7 @@ private:
  *  --- ARGUMENT FORMAT ---
  *  key_len (1 byte)
  *  key (n bytes; indicated by key_len)
+ *    since 0.7 (requests), keys in the header table: 0x80 | index (1 byte); other keys of 128+ characters: 0xFF key_len
  *  val_type (1 byte)
  *  val (integral/float types: byte-per-byte; other types: see below).
  */
@@ -953,13 +1389,35 @@ private:
  *  val_cnt (n bytes; indicated by val_len)
  */
 
+/*
+ *  --- VALUE FORMAT (LONG STRINGS, SINCE 0.3) ---
+ *  val_type 0x23 (1 byte)
+ *  val_len (4 bytes)
+ *  val_cnt (n bytes; indicated by val_len)
+ */
+
 /*
  *  --- VALUE FORMAT (LISTS) ---
  *  cnt_type (1 byte)
- *  list_len (4 bytes)
+ *  list_len (4 bytes; since 0.2: LEB128 varint)
  *  list_values (n bytes; each is same as val in ARGUMENT FORMAT)
  */
 
+/*
+ *  --- VALUE FORMAT (TABLES, SINCE 0.6; LISTS OF SUB-OBJECTS WITH THE SAME KEYS AND VALUE TYPES) ---
+ *  cnt_type 0x32 (1 byte)
+ *  row_count (LEB128 varint)
+ *  col_count (1 byte)
+ *  columns (per column: key_len, key, val_type; val_type as cnt_type for lists)
+ *  col_values (per column, row_count values; each is same as list_values)
+ */
+
+/*
+ *  --- VALUE FORMAT (COMPACT INTEGERS, SINCE 0.2) ---
+ *  val_type | 0x80 (1 byte; for 16- and 32-bit integers)
+ *  val (LEB128 varint; zigzag-encoded for signed types)
+ */
+
 /*
  *  --- VALUE FORMAT (SUB-OBJECTS) ---
  *  sub_obj_count (1 byte)
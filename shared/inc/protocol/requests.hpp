@@ -100,6 +100,53 @@ struct proto_error : public std::logic_error {
   using logic_error::logic_error;
 };
 
+/**
+ * \short Type alias for session tokens (`std::string`).
+ *
+ * Since protocol version 0.9, the server hands out signed tokens, which are sent as strings (see
+ * `dotchat::proto::message::uses_signed_tokens`). Older servers hand out 32-bit keys, which are still sent as 32-bit
+ * integers; such a token holds the raw bytes of the key (see `legacy_token`).
+ */
+using token_t = std::string;
+
+/**
+ * \short Converts a 32-bit key (as handed out before protocol version 0.9) into a token.
+ * \param key The key to convert.
+ * \returns A token holding the raw bytes of the key.
+ */
+token_t legacy_token(int32_t key);
+
+/**
+ * \short Checks whether a token holds a 32-bit key (as handed out before protocol version 0.9).
+ * \param token The token to check.
+ * \returns True if the token holds a 32-bit key, otherwise false.
+ */
+inline bool is_legacy_token(const token_t &token) { return token.size() == sizeof(int32_t); }
+
+/**
+ * \short Gets the 32-bit key held in a token.
+ * \param token The token (should satisfy `is_legacy_token`).
+ * \returns The key held in the token.
+ */
+int32_t legacy_key(const token_t &token);
+
+/**
+ * \short Extracts a token from an arg_obj (either a string, or a 32-bit key).
+ * \param key The key of the token.
+ * \param source The arg_obj to search.
+ * \returns The extracted token.
+ * \throws `dotchat::proto::proto_error` if the key is not present or it doesn't have the correct type.
+ */
+token_t require_token(const std::string &key, const message::arg_obj &source);
+
+/**
+ * \short Adds a token to an arg_obj (32-bit keys as 32-bit integer, other tokens as string).
+ * \param key The key for the token.
+ * \param token The token to add.
+ * \param target The arg_obj to add the token to.
+ */
+void set_token(const std::string &key, const token_t &token, message::arg_obj &target);
+
 /**
  * \short Namespace containing the request structures.
  */
@@ -119,16 +166,25 @@ struct request_commands {
   const inline static std::string change_pass = "ch_pass";         /*!< \short The password change command. */
   const inline static std::string user_details = "usr_detail";     /*!< \short The user detail command. */
   const inline static std::string invite_user = "invite";          /*!< \short The user invite command. */
+  const inline static std::string ping = "ping";                   /*!< \short The keep-alive command. */
 };
 
 /**
  * \short Structure representing a request containing only a token (base class).
  */
 struct token_request {
+  /**
+   * \short Token value for requests on a connection which is bound to a session.
+   *
+   * A request with this token is sent without `token` key; the server then uses the session the connection is bound to
+   * (see `dotchat::proto::message::uses_bound_sessions`). This value (the empty token) is never used as a real token.
+   */
+  const inline static token_t bound_token{};
+
   /**
    * \short The contained token.
    */
-  int32_t token;
+  token_t token;
 
   /**
    * \short Converts a message into a token request.
@@ -224,6 +280,10 @@ struct channel_msg_request : public token_request {
    * \short The ID of the channel whose messages to request.
    */
   int32_t chan_id;
+  /**
+   * \short The amount of most recent messages to request (0 for all messages; sent only if set).
+   */
+  int32_t last = 0;
 
   /**
    * \short Converts a message into a channel message listing request.
@@ -428,6 +488,27 @@ struct invite_user_request : public token_request {
    */
   [[nodiscard]] message to() const;
 };
+
+/**
+ * \short Structure representing a keep-alive request.
+ *
+ * Ping requests carry no arguments (not even a token); the server answers them without validating a session or
+ * touching the database.
+ */
+struct ping_request {
+  /**
+   * \short Converts a message into a keep-alive request.
+   * \param m The message to convert.
+   * \returns A new keep-alive request.
+   * \throws `dotchat::proto::proto_error` if the command is incorrect.
+   */
+  static ping_request from(const message &m);
+  /**
+   * \short Converts this request to a message.
+   * \returns A new message, equivalent to this request.
+   */
+  [[nodiscard]] message to() const;
+};
 }
 
 /**
@@ -440,6 +521,7 @@ namespace responses {
 struct response_commands {
   const inline static std::string okay = "ok";    /*!< \short Command indicating a success response. */
   const inline static std::string error = "err";  /*!< \short Command indicating a failure response. */
+  const inline static std::string pong = "pong";  /*!< \short Command indicating a keep-alive response. */
 };
 
 /**
@@ -473,6 +555,11 @@ struct error_response {
    * \short The reason for this error.
    */
   std::string reason;
+  /**
+   * \short The time after which the request may be sent again, in milliseconds (0 if there's no hint; e.g. when a
+   * rate limit refused the request).
+   */
+  int32_t retry_ms = 0;
   /**
    * \short Converts a message into an erroneous response.
    * \param m The message to convert.
@@ -496,6 +583,36 @@ struct error_response {
   [[nodiscard]] message to() const;
 };
 
+/**
+ * \short Structure representing a keep-alive response (reply to a `dotchat::proto::requests::ping_request`).
+ *
+ * The reply to a ping is negotiated down to the ping's version like any other reply, so the server's own version is
+ * sent in the body as well; a client uses this to learn the server's version before its first real request.
+ */
+struct pong_response {
+  /**
+   * \short The highest major protocol version the server supports (0 and 0 if not sent; e.g. by an older server).
+   */
+  message::byte major = 0;
+  /**
+   * \short The highest minor protocol version the server supports.
+   */
+  message::byte minor = 0;
+
+  /**
+   * \short Converts a message into a keep-alive response.
+   * \param m The message to convert.
+   * \returns A new keep-alive response.
+   * \throws `dotchat::proto::proto_error` if the command is incorrect.
+   */
+  static pong_response from(const message &m);
+  /**
+   * \short Converts this response into a message.
+   * \returns A new message, equivalent to this response.
+   */
+  [[nodiscard]] message to() const;
+};
+
 /**
  * \short Structure representing a response holding only a token.
  */
@@ -503,18 +620,18 @@ struct token_response : public okay_response {
   /**
    * \short The token.
    */
-  int32_t token = 0;
+  token_t token;
 
   /**
    * \short Constructs a default token response.
    */
-  constexpr token_response() = default;
+  token_response() = default;
   /**
    * \short Constructs a token response from all required values.
    * \param o The `dotchat::proto::responses::okay_response` this response is based on.
    * \param token The token to include.
    */
-  constexpr token_response(const okay_response &o, int32_t token): okay_response(o), token{token} {}
+  token_response(const okay_response &o, token_t token): okay_response(o), token{std::move(token)} {}
 
   /**
    * \short Converts a message into a token response.
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        buffer_pool.hpp
+// Purpose:     Pool of reusable I/O buffers
+// Author:      jay-tux
+// Created:     October 18, 2026 3:20 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Pool of reusable I/O buffers.
+ */
+
+#ifndef DOTCHAT_BUFFER_POOL_HPP
+#define DOTCHAT_BUFFER_POOL_HPP
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+/**
+ * \short Namespace containing all code related to the dotchat OpenSSL TLS wrappers.
+ */
+namespace dotchat::tls {
+/**
+ * \short Singleton class holding spare byte buffers, grouped in power-of-two size classes.
+ *
+ * Byte streams take their storage from this pool when they need to grow, and give it back when they shrink or are
+ * destroyed; so once the pool is warmed up, (de)serializing messages doesn't hit the heap.
+ */
+class buffer_pool {
+public:
+  /**
+   * \short Type alias for the buffer type.
+   */
+  using buffer_t = std::vector<uint8_t>;
+
+  /**
+   * \short The smallest size class (1 KiB); smaller buffers are never pooled.
+   */
+  constexpr const static size_t min_class_log = 10;
+  /**
+   * \short The largest size class (1 MiB); larger buffers are never pooled.
+   */
+  constexpr const static size_t max_class_log = 20;
+  /**
+   * \short The maximum amount of spare buffers kept per size class.
+   */
+  constexpr const static size_t max_spares = 16;
+
+  /**
+   * \short Gets the pool.
+   * \returns The singleton instance.
+   */
+  static buffer_pool &instance();
+
+  /**
+   * \short Gets an (empty) buffer with at least the given capacity.
+   * \param capacity The minimum capacity.
+   * \returns A pooled buffer if one is available, otherwise a newly allocated one.
+   */
+  buffer_t acquire(size_t capacity);
+
+  /**
+   * \short Gives a buffer back to the pool.
+   * \param buf The buffer to give back. If its size class is full or it's too small or large, it's freed instead.
+   */
+  void release(buffer_t &&buf);
+
+  /**
+   * \short Gets the amount of times `acquire` could be served from the pool.
+   * \returns The amount of pool hits.
+   */
+  [[nodiscard]] inline uint64_t hits() const { return hit_count.load(std::memory_order_relaxed); }
+  /**
+   * \short Gets the amount of times `acquire` had to allocate a new buffer.
+   * \returns The amount of pool misses.
+   */
+  [[nodiscard]] inline uint64_t misses() const { return miss_count.load(std::memory_order_relaxed); }
+
+private:
+  /**
+   * \short The pool is a singleton, so it doesn't support constructing.
+   */
+  buffer_pool();
+
+  /**
+   * \short Structure holding the spare buffers of a single size class.
+   */
+  struct size_class {
+    std::mutex lock;          /*!< \short Mutex protecting the spares. */
+    std::vector<buffer_t> spares; /*!< \short The spare buffers. */
+  };
+
+  /**
+   * \short All size classes, from `1 << min_class_log` up to `1 << max_class_log` bytes.
+   */
+  std::array<size_class, max_class_log - min_class_log + 1> classes;
+  /**
+   * \short The amount of pool hits.
+   */
+  std::atomic<uint64_t> hit_count = 0;
+  /**
+   * \short The amount of pool misses.
+   */
+  std::atomic<uint64_t> miss_count = 0;
+};
+}
+
+#endif //DOTCHAT_BUFFER_POOL_HPP
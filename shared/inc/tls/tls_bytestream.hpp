@@ -23,6 +23,8 @@
 #include <span>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
+#include "buffer_pool.hpp"
 
 /**
  * \short Namespace containing all code related to the dotchat OpenSSL TLS wrappers.
@@ -92,6 +94,38 @@ public:
   template <typename T>
   using raw_t = std::array<byte, sizeof(T)>;
 
+  /**
+   * \short Constructs a new, empty byte stream.
+   */
+  bytestream() = default;
+  /**
+   * \short Copies another byte stream.
+   */
+  bytestream(const bytestream &) = default;
+  /**
+   * \short Moves another byte stream into this one.
+   */
+  bytestream(bytestream &&) noexcept = default;
+  /**
+   * \short Copy-assigns another byte stream to this one.
+   * \returns A reference to this stream.
+   */
+  bytestream &operator=(const bytestream &) = default;
+  /**
+   * \short Move-assigns another byte stream to this one.
+   * \returns A reference to this stream.
+   */
+  bytestream &operator=(bytestream &&) noexcept = default;
+
+  /**
+   * \short Swaps the contents (and storage) of two byte streams.
+   * \param other The stream to swap with.
+   */
+  inline void swap(bytestream &other) noexcept {
+    std::swap(offset, other.offset);
+    std::swap(data, other.data);
+  }
+
   /**
    * \short Writes a single value to the stream.
    * \tparam T The type of the value to write.
@@ -100,24 +134,25 @@ public:
   template <typename T>
   void add(const T &val) {
     raw_t<T> raw = as_raw(val);
-    data.reserve(data.size() + raw.size());
-    for(const auto &b : raw) data.push_back(b);
+    append(raw.data(), raw.size());
   }
 
   /**
    * \short Extracts a single value from the stream.
    * \tparam T The type of the value to extract; this type should satisfy `dotchat::tls::_intl_::not_iterable<T>`.
    * \param out A reference to the variable to extract into.
+   * \throws `std::out_of_range` if the stream holds fewer bytes than the value needs (`out` is left unchanged).
    *
-   * If the buffer has passed over a significant amount of bytes already (100), the stream is sanitized.
+   * If the whole buffer has been read, the stream is cleansed (which keeps its storage for the next message).
    */
   template <_intl_::not_iterable T>
   void extract(T &out) {
     raw_t<T> res;
-    for(size_t i = 0; i < res.size(); i++) res[i] = data[offset + i];
+    if(size() < res.size()) throw std::out_of_range("Can't extract value (not enough bytes left in the stream).");
+    std::memcpy(res.data(), data.data() + offset, res.size());
     offset += res.size();
     out = std::bit_cast<T>(res);
-    if(offset > 100) sanitize();
+    if(offset == data.size()) cleanse();
   }
 
   /**
@@ -146,23 +181,48 @@ public:
    * \returns The amount of bytes read. This value will always be smaller than or equal to `span.size()`.
    */
   inline size_t read(const std::span<byte> &span) {
-    size_t i = 0;
-    for(; i < span.size() && i + offset < data.size(); i++) {
-      span[i] = data[i + offset];
-    }
+    size_t i = std::min(span.size(), data.size() - offset);
+    if(i != 0) std::memcpy(span.data(), data.data() + offset, i);
     offset += i;
     return i;
   }
 
+  /**
+   * \short Skips bytes, as if they were read (e.g. after they were consumed through `read_start`).
+   * \param n The amount of bytes to skip; at most `size()` bytes are skipped.
+   */
+  inline void skip(size_t n) {
+    offset += std::min(n, data.size() - offset);
+  }
+
   /**
    * \short Writes all bytes from the given buffer to the stream.
    * \param span The buffer to copy from.
    */
   inline void write(const std::span<byte> &span) {
-    data.reserve(data.size() + span.size());
-    for(const auto &v: span) {
-      data.push_back(v);
-    }
+    append(span.data(), span.size());
+  }
+
+  /**
+   * \short Appends uninitialized space to the end of the stream, to be filled in directly (e.g. by `SSL_read`).
+   * \param n The amount of bytes to append.
+   * \returns A span over the appended bytes.
+   *
+   * Any bytes which end up unused should be removed again using `drop_tail`.
+   */
+  inline std::span<byte> append_space(size_t n) {
+    ensure(n);
+    size_t old = data.size();
+    data.resize(old + n);
+    return { data.data() + old, n };
+  }
+
+  /**
+   * \short Removes bytes from the end of the stream.
+   * \param n The amount of bytes to remove.
+   */
+  inline void drop_tail(size_t n) {
+    data.resize(data.size() - std::min(n, data.size() - offset));
   }
 
   /**
@@ -215,7 +275,62 @@ public:
     data.clear();
   }
 
+  /**
+   * \short Cleanses the stream, and gives its storage back to the pool if it grew larger than `max_retained`.
+   *
+   * Long-lived streams should call this after each message, so a single large message doesn't pin its buffer.
+   */
+  inline void recycle() {
+    cleanse();
+    if(data.capacity() > max_retained) {
+      buffer_pool::instance().release(std::move(data));
+      data = buffer_pool::instance().acquire(initial_capacity);
+    }
+  }
+
+  /**
+   * \short Destroys the stream, giving its storage back to the pool.
+   */
+  inline ~bytestream() {
+    buffer_pool::instance().release(std::move(data));
+  }
+
+  /**
+   * \short The capacity of the first buffer a stream takes from the pool.
+   */
+  constexpr const static size_t initial_capacity = 1024;
+  /**
+   * \short The largest capacity `recycle` keeps for the next message.
+   */
+  constexpr const static size_t max_retained = 16 * 1024;
+
 private:
+  /**
+   * \short Makes sure there's room for at least `n` more bytes, growing into a pooled buffer if necessary.
+   * \param n The amount of bytes needed.
+   *
+   * Growing also drops the bytes which have already been read.
+   */
+  inline void ensure(size_t n) {
+    if(data.size() + n <= data.capacity()) return;
+
+    auto next = buffer_pool::instance().acquire(std::max({ size() + n, 2 * data.capacity(), initial_capacity }));
+    next.insert(next.end(), data.begin() + static_cast<std::ptrdiff_t>(offset), data.end());
+    offset = 0;
+    std::swap(data, next);
+    buffer_pool::instance().release(std::move(next));
+  }
+
+  /**
+   * \short Appends raw bytes to the stream.
+   * \param src The bytes to append.
+   * \param n The amount of bytes to append.
+   */
+  inline void append(const byte *src, size_t n) {
+    ensure(n);
+    data.insert(data.end(), src, src + n);
+  }
+
   /**
    * \short The offset into the buffer.
    */
@@ -24,8 +24,10 @@ class tls_connection;
 #include "tls_client_socket.hpp"
 #include "tls_context.hpp"
 #include "tls_bytestream.hpp"
+#include "../protocol/header_table.hpp"
 #include "openssl/ssl.h"
 #include <vector>
+#include <chrono>
 
 /**
  * \short Namespace containing all code related to the dotchat OpenSSL TLS wrappers.
@@ -36,6 +38,12 @@ namespace dotchat::tls {
  */
 using byte = bytestream::byte;
 
+/**
+ * \short Gets the largest message (in bytes) sent or accepted in a length frame.
+ * \returns A reference to the maximum size (default 16 MiB).
+ */
+size_t &max_message_size();
+
 /**
  * \short Class representing a TLS connection.
  *
@@ -52,6 +60,24 @@ public:
    */
   struct end_of_msg {};
 
+  /**
+   * \short Structure holding I/O statistics for a connection.
+   */
+  struct io_stats {
+    /**
+     * \short The amount of bytes read from the connection.
+     */
+    uint64_t bytes_in = 0;
+    /**
+     * \short The amount of bytes written to the connection.
+     */
+    uint64_t bytes_out = 0;
+    /**
+     * \short The time it took to complete the TLS handshake.
+     */
+    std::chrono::nanoseconds handshake{0};
+  };
+
   /**
    * \short TLS connections can't be copy-initialized.
    */
@@ -79,9 +105,18 @@ public:
     std::swap(ssl, other.ssl);
     std::swap(conn_handle, other.conn_handle);
     std::swap(connected, other.connected);
+    std::swap(statistics, other.statistics);
+    std::swap(requests, other.requests);
     return *this;
   }
 
+  /**
+   * \short Completes the TLS handshake, for a connection accepted without one (see
+   * `dotchat::tls::tls_server_socket::accept_pending`).
+   * \throws `dotchat::tls::tls_error` if the TLS handshake can't be completed (or was interrupted).
+   */
+  void handshake();
+
   /**
    * \short Makes the connection sends all the data in its buffer.
    * \param _ This parameter is ignored and is only for overload resolution.
@@ -110,15 +145,58 @@ public:
   /**
    * \short Sends the contents of a byte-stream through the connection to the other end.
    * \param strm The stream to send.
+   * \param framed Whether to send the message in a length frame (only for peers which read them).
+   * \throws `dotchat::tls::tls_error` if the message is too large (more than 16 KiB without a length frame, or more
+   * than `max_message_size()` in one), or if it can't be sent.
+   *
+   * Afterwards, `strm` is empty, but can be reused for the next message without allocating. Without a length frame,
+   * the stream's storage is swapped with the connection's (empty) internal buffer; otherwise, the frame is assembled in
+   * the internal buffer.
    */
-  void send(bytestream &strm);
+  void send(bytestream &strm, bool framed = false);
   /**
    * \short Starts reading from the connection.
-   * \returns A new byte-stream which contains the data read.
-   * \attention The current implementation only supports reading messages of at most 1024 bytes. This will be changed
-   * in the future to allow messages of arbitrary lengths.
+   * \returns A new byte-stream which contains the message read (without its length frame).
    */
   bytestream read();
+  /**
+   * \short Starts reading a message from the connection, into an existing byte-stream.
+   * \param target The stream to read into; it's cleansed first (but keeps its storage).
+   * \returns True if the message was sent in a length frame, otherwise false.
+   * \throws `dotchat::tls::tls_error` if reading from the underlying OpenSSL structures failed.
+   * \throws `dotchat::tls::tls_error` if the length frame is malformed or larger than `max_message_size()`.
+   *
+   * A message in a length frame is read until all of it has arrived; the frame header is skipped. Any other message is
+   * read as a single TLS record, so it can be at most 16 KiB.
+   */
+  bool read_into(bytestream &target);
+
+  /**
+   * \short Waits for a certain amount of time, until data is available to be read.
+   * \param millidelay The delay, in milliseconds.
+   * \returns True if a call to `read` won't block (data is available, or the other end hung up); otherwise false.
+   *
+   * Data already buffered by OpenSSL is taken into account, so this doesn't miss messages which were received together
+   * with a previous one.
+   */
+  [[nodiscard]] bool wait_readable(int millidelay = 0) const;
+
+  /**
+   * \short Sets the timeouts for the underlying socket.
+   * \param read The maximum time a single read may block (0 to disable).
+   * \param write The maximum time a single write may block (0 to disable).
+   *
+   * When a timeout expires, the blocked `read` or `send` call fails with a `dotchat::tls::tls_error`.
+   */
+  void set_timeouts(std::chrono::milliseconds read, std::chrono::milliseconds write) const;
+
+  /**
+   * \short Shuts down the reading side of the underlying socket, waking up any blocked read, wait or handshake.
+   *
+   * Afterwards, `wait_readable` returns true and reads see the end of the stream (or fail); writes still succeed. This
+   * may be called from another thread, but not concurrently with (or after) `close`.
+   */
+  void interrupt() const;
 
   /**
    * \short Checks the internal state to determine if the connection is still opened.
@@ -138,6 +216,18 @@ public:
    */
   void close();
 
+  /**
+   * \short Gets the I/O statistics for this connection.
+   * \returns A constant reference to the statistics.
+   */
+  [[nodiscard]] inline const io_stats &stats() const { return statistics; }
+
+  /**
+   * \short Gets the header table for the requests on this connection (see `dotchat::proto::header_table`).
+   * \returns A reference to the table (filled while sending requests client-side, and while reading them server-side).
+   */
+  inline proto::header_table &request_table() { return requests; }
+
   /**
    * \short Destroys this connection, closing the connection if it's still opened.
    */
@@ -148,10 +238,11 @@ private:
    * \short Constructs a new connection from a handle, in a certain TLS context.
    * \param ctxt A reference to the context to use.
    * \param conn_handle The connection handle.
+   * \param defer_handshake Whether to leave the TLS handshake to a later call to `handshake`.
    * \throws `dotchat::tls::tls_error` if the connection is server-side and the TLS connection can't be accepted.
    * \throws `dotchat::tls::tls_error` if the TLS handshake can't be completed.
    */
-  tls_connection(const tls_context &ctxt, int conn_handle);
+  tls_connection(const tls_context &ctxt, int conn_handle, bool defer_handshake = false);
 
   /**
    * The internal buffer to send or read from.
@@ -169,6 +260,14 @@ private:
    * Whether or not a connection has been established.
    */
   bool connected = false;
+  /**
+   * The I/O statistics for this connection.
+   */
+  io_stats statistics;
+  /**
+   * The command names and keys sent in requests on this connection.
+   */
+  proto::header_table requests;
   friend tls_server_socket;
   friend tls_client_socket;
 };
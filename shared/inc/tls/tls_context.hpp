@@ -21,6 +21,7 @@ class tls_context;
 }
 
 #include <string>
+#include <sstream>
 #include "openssl/err.h"
 #include "openssl/ssl.h"
 
@@ -155,6 +156,20 @@ public:
     }
   }
 
+  /**
+   * \short Dumps the error queue to a single-line string.
+   * \returns The errors in the queue, separated by `; `.
+   *
+   * \see `dotchat::tls::tls_context::dump_error_queue`
+   */
+  static inline std::string error_queue() {
+    std::ostringstream res;
+    std::ostream &strm = res;
+    bool first = true;
+    dump_error_queue([&strm, &first]() { if(!first) strm << "; "; first = false; }, strm);
+    return res.str();
+  }
+
   /**
    * \short Gets a pointer to the internal OpenSSL context.
    * \returns A pointer to the internal OpenSSL context.
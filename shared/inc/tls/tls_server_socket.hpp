@@ -96,6 +96,17 @@ public:
    * returns an empty response.
    */
   [[nodiscard]] std::optional<tls_connection> accept_nonblock(int millidelay = 0) const;
+  /**
+   * \short Waits for a certain amount of time, accepting a connection if one is available, without the TLS handshake.
+   * \param millidelay The delay, in milliseconds.
+   * \returns A new connection if one was available (see `dotchat::tls::tls_connection::handshake`). Otherwise,
+   * `std::nullopt`.
+   * \throws `dotchat::tls::tls_server_socket::socket_error` if the connection can't be accepted.
+   *
+   * Like `accept_nonblock`, but a slow (or stalling) peer can't hold up the caller: the handshake is left to whoever
+   * handles the connection.
+   */
+  [[nodiscard]] std::optional<tls_connection> accept_pending(int millidelay = 0) const;
 
   /**
    * \short Destroys the socket, cleaning up any resources.
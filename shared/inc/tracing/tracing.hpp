@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tracing.hpp
+// Purpose:     Lightweight per-thread tracing spans
+// Author:      jay-tux
+// Created:     October 18, 2026 12:20 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file
+ * \short Lightweight per-thread tracing spans.
+ */
+
+#ifndef DOTCHAT_TRACING_HPP
+#define DOTCHAT_TRACING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+/**
+ * \short Namespace containing the tracing spans.
+ *
+ * Each thread records its spans in its own fixed-size ring buffer (older spans get overwritten). The rings of all
+ * threads (including recently exited ones) can be dumped in the Chrome trace-event format, which can be opened in
+ * `chrome://tracing` or Perfetto.
+ */
+namespace dotchat::tracing {
+/**
+ * \short The clock used for all spans.
+ */
+using clock = std::chrono::steady_clock;
+
+/**
+ * \short Gets whether tracing is enabled (default: true).
+ * \returns A reference to the flag.
+ *
+ * While disabled, creating a span costs a single atomic load.
+ */
+std::atomic<bool> &enabled();
+
+/**
+ * \short Records a finished span on the current thread's ring buffer.
+ * \param name The name of the span; should be a string literal (or otherwise outlive the program).
+ * \param start The time at which the span started.
+ * \param end The time at which the span ended.
+ * \param detail Optional extra information (truncated to a few dozen characters).
+ */
+void record(const char *name, clock::time_point start, clock::time_point end, std::string_view detail = {});
+
+/**
+ * \short RAII class recording a span from its construction until its destruction.
+ */
+class span {
+public:
+  /**
+   * \short Starts a new span.
+   * \param name The name of the span; should be a string literal (or otherwise outlive the program).
+   * \param detail Optional extra information; should outlive the span.
+   */
+  explicit inline span(const char *name, std::string_view detail = {}) :
+    name{name}, detail{detail}, active{enabled().load(std::memory_order_relaxed)} {
+    if(active) start = clock::now();
+  }
+  /**
+   * \short Spans can't be copied.
+   */
+  span(const span &) = delete;
+  /**
+   * \short Spans can't be moved.
+   */
+  span(span &&) = delete;
+  /**
+   * \short Spans can't be copied.
+   * \returns Nothing, spans can't be copied.
+   */
+  span &operator=(const span &) = delete;
+  /**
+   * \short Spans can't be moved.
+   * \returns Nothing, spans can't be moved.
+   */
+  span &operator=(span &&) = delete;
+
+  /**
+   * \short Ends the span and records it.
+   */
+  inline ~span() {
+    if(active) record(name, start, clock::now(), detail);
+  }
+
+private:
+  /**
+   * \short The name of the span.
+   */
+  const char *name;
+  /**
+   * \short The extra information for the span.
+   */
+  std::string_view detail;
+  /**
+   * \short Whether tracing was enabled when the span started.
+   */
+  bool active;
+  /**
+   * \short The time at which the span started.
+   */
+  clock::time_point start;
+};
+
+/**
+ * \short Runs a function inside of a span.
+ * \tparam Fun The type of the function.
+ * \param name The name of the span.
+ * \param f The function to run.
+ * \returns The result of the function.
+ */
+template <typename Fun>
+inline decltype(auto) traced(const char *name, Fun &&f) {
+  span s(name);
+  return f();
+}
+
+/**
+ * \short Dumps the spans of all threads in the Chrome trace-event JSON format.
+ * \returns A string containing the JSON document.
+ */
+std::string dump_chrome_json();
+
+/**
+ * \short Dumps the spans of all threads in the Chrome trace-event JSON format to a file.
+ * \param path The path of the file to write to (overwritten if it exists).
+ * \returns True if the file was written, otherwise false.
+ */
+bool dump_to_file(const std::string &path);
+}
+
+#endif //DOTCHAT_TRACING_HPP
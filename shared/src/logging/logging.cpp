@@ -0,0 +1,258 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        logging.cpp
+// Purpose:     Structured, asynchronous logging (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 1:34 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "logging/logging.hpp"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <ctime>
+#include <iostream>
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::logging;
+
+const static size_t queue_capacity = 256;
+
+// single-producer (the owning thread), single-consumer (the flusher) queue
+struct record_queue {
+  std::array<std::string, queue_capacity> slots;
+  std::atomic<size_t> head = 0;
+  std::atomic<size_t> tail = 0;
+  std::atomic<bool> retired = false;
+
+  bool push(std::string &&line) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) == queue_capacity) return false;
+    slots[t % queue_capacity] = std::move(line);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(std::string &into) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire)) return false;
+    into.swap(slots[h % queue_capacity]);
+    slots[h % queue_capacity].clear();
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+struct queue_registry {
+  std::mutex lock;
+  std::vector<std::shared_ptr<record_queue>> queues;
+  std::atomic<bool> flushing = false;
+  std::atomic<size_t> pushing = 0;
+  std::atomic<size_t> dropped = 0;
+  std::mutex sync_lock;
+};
+
+queue_registry &all_queues() {
+  static queue_registry reg;
+  return reg;
+}
+
+struct queue_owner {
+  std::shared_ptr<record_queue> owned;
+
+  queue_owner() : owned{std::make_shared<record_queue>()} {
+    std::unique_lock guard { all_queues().lock };
+    all_queues().queues.push_back(owned);
+  }
+
+  ~queue_owner() {
+    owned->retired = true;
+  }
+};
+
+record_queue &local_queue() {
+  thread_local queue_owner owner;
+  return *owner.owned;
+}
+
+struct rate_bucket {
+  double tokens = -1;
+  std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+  size_t suppressed = 0;
+
+  bool take(size_t rate) {
+    if(rate == 0) return true;
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - last;
+    last = now;
+    if(tokens < 0) tokens = static_cast<double>(rate);
+    tokens = std::min(static_cast<double>(rate), tokens + elapsed.count() * static_cast<double>(rate));
+    if(tokens < 1) {
+      suppressed++;
+      return false;
+    }
+    tokens -= 1;
+    return true;
+  }
+};
+
+std::atomic<level> &logging::min_level() {
+  static std::atomic<level> lvl = level::info;
+  return lvl;
+}
+
+std::atomic<size_t> &logging::per_thread_rate() {
+  static std::atomic<size_t> rate = 200;
+  return rate;
+}
+
+size_t logging::dropped() {
+  return all_queues().dropped.load(std::memory_order_relaxed);
+}
+
+context &context::current() {
+  thread_local context ctx;
+  return ctx;
+}
+
+std::string_view level_name(level lvl) {
+  switch(lvl) {
+#define X(name) case level::name: return #name;
+    DOTCHAT_LOG_LEVELS
+#undef X
+  }
+  return "unknown";
+}
+
+void append_timestamp(std::string &out) {
+  auto now = std::chrono::system_clock::now();
+  auto secs = std::chrono::system_clock::to_time_t(now);
+  auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+  std::tm parts{};
+  gmtime_r(&secs, &parts);
+  std::array<char, 32> buf{};
+  size_t len = std::strftime(buf.data(), buf.size(), "%Y-%m-%dT%H:%M:%S", &parts);
+  out.append(buf.data(), len);
+  out += '.';
+  out += static_cast<char>('0' + millis / 100);
+  out += static_cast<char>('0' + millis / 10 % 10);
+  out += static_cast<char>('0' + millis % 10);
+  out += 'Z';
+}
+
+void append_value(std::string &out, std::string_view value) {
+  bool quote = value.empty() || std::any_of(value.begin(), value.end(), [](char c) {
+    return c == ' ' || c == '=' || c == '"' || static_cast<unsigned char>(c) < 0x20;
+  });
+  if(!quote) {
+    out += value;
+    return;
+  }
+
+  out += '"';
+  for(char c: value) {
+    switch(c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+        break;
+    }
+  }
+  out += '"';
+}
+
+void append_field(std::string &out, std::string_view key, std::string_view value) {
+  out += ' ';
+  out += key;
+  out += '=';
+  append_value(out, value);
+}
+
+void logging::log(level lvl, std::string_view message, std::initializer_list<field> fields) {
+  if(lvl < min_level().load(std::memory_order_relaxed)) return;
+
+  thread_local rate_bucket bucket;
+  if(!bucket.take(per_thread_rate().load(std::memory_order_relaxed))) return;
+
+  std::string line;
+  line.reserve(128);
+  line += "ts=";
+  append_timestamp(line);
+  append_field(line, "level", level_name(lvl));
+
+  const context &ctx = context::current();
+  if(ctx.connection.has_value()) append_field(line, "conn", std::to_string(ctx.connection.value()));
+  if(!ctx.command.empty()) append_field(line, "cmd", ctx.command);
+  if(ctx.user.has_value()) append_field(line, "user", std::to_string(ctx.user.value()));
+
+  append_field(line, "msg", message);
+  for(const auto &[key, value]: fields) append_field(line, key, value);
+  if(bucket.suppressed != 0) {
+    append_field(line, "suppressed", std::to_string(bucket.suppressed));
+    bucket.suppressed = 0;
+  }
+  line += '\n';
+
+  // announce the push before checking for a flusher, so a stopping flusher waits for it (see ~flusher)
+  all_queues().pushing.fetch_add(1);
+  if(all_queues().flushing.load()) {
+    if(!local_queue().push(std::move(line))) all_queues().dropped.fetch_add(1, std::memory_order_relaxed);
+    all_queues().pushing.fetch_sub(1);
+  }
+  else {
+    all_queues().pushing.fetch_sub(1);
+    std::unique_lock guard { all_queues().sync_lock };
+    std::cerr << line << std::flush;
+  }
+}
+
+size_t drain(std::ostream &out) {
+  std::vector<std::shared_ptr<record_queue>> queues;
+  {
+    std::unique_lock guard { all_queues().lock };
+    queues = all_queues().queues;
+  }
+
+  size_t written = 0;
+  std::string line;
+  for(const auto &q: queues) {
+    while(q->pop(line)) {
+      out << line;
+      written++;
+    }
+  }
+  if(written != 0) out.flush();
+
+  std::unique_lock guard { all_queues().lock };
+  std::erase_if(all_queues().queues, [](const auto &q) {
+    return q->retired.load() && q->head.load() == q->tail.load();
+  });
+  return written;
+}
+
+flusher::flusher(std::ostream &out, std::chrono::milliseconds interval) :
+  out{out}, interval{interval}, runner{[this](const std::stop_token &st) { run(st); }} {
+  all_queues().flushing = true;
+}
+
+void flusher::run(const std::stop_token &st) {
+  while(!st.stop_requested()) {
+    if(drain(out) == 0) std::this_thread::sleep_for(interval);
+  }
+}
+
+flusher::~flusher() {
+  runner.request_stop();
+  if(runner.joinable()) runner.join();
+  // from here on, records are written synchronously; the final drain runs once pushes which saw the flusher are done
+  all_queues().flushing = false;
+  while(all_queues().pushing.load() != 0) std::this_thread::yield();
+  drain(out);
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        arena.cpp
+// Purpose:     Per-request arena for message trees (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 2:49 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "protocol/arena.hpp"
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+struct alignas(std::max_align_t) tag_header {
+  std::pmr::memory_resource *source;
+  size_t size;
+};
+
+std::pmr::memory_resource *&thread_resource() {
+  thread_local std::pmr::memory_resource *res = std::pmr::new_delete_resource();
+  return res;
+}
+
+std::pmr::memory_resource *proto::current_resource() {
+  return thread_resource();
+}
+
+void arena::reset() {
+  resource.release();
+  alloc_count = 0;
+  alloc_bytes = 0;
+}
+
+void *arena::do_allocate(size_t bytes, size_t alignment) {
+  alloc_count++;
+  alloc_bytes += bytes;
+  return resource.allocate(bytes, alignment);
+}
+
+arena_scope::arena_scope(arena &target) : target{target}, previous{thread_resource()} {
+  thread_resource() = &target;
+}
+
+arena_scope::~arena_scope() {
+  thread_resource() = previous;
+  target.reset();
+}
+
+void *proto::tagged_allocate(size_t size) {
+  auto *res = current_resource();
+  auto *header = static_cast<tag_header *>(res->allocate(sizeof(tag_header) + size, alignof(tag_header)));
+  header->source = res;
+  header->size = size;
+  return header + 1;
+}
+
+void proto::tagged_deallocate(void *ptr) noexcept {
+  if(ptr == nullptr) return;
+  auto *header = static_cast<tag_header *>(ptr) - 1;
+  header->source->deallocate(header, sizeof(tag_header) + header->size, alignof(tag_header));
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        byte_order.cpp
+// Purpose:     Bulk byte-order conversion for packed integer lists (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 4:20 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+
+#include "protocol/byte_order.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DOTCHAT_BYTE_ORDER_X86
+#endif
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+using swap_fn = void (*)(const uint8_t *, uint8_t *, size_t);
+
+struct swap_impl {
+  const char *isa;
+  swap_fn swap16;
+  swap_fn swap32;
+};
+
+void swap16_scalar(const uint8_t *src, uint8_t *dst, size_t count) {
+  for(size_t i = 0; i < count; i++) {
+    uint16_t v;
+    std::memcpy(&v, src + 2 * i, 2);
+    v = __builtin_bswap16(v);
+    std::memcpy(dst + 2 * i, &v, 2);
+  }
+}
+
+void swap32_scalar(const uint8_t *src, uint8_t *dst, size_t count) {
+  for(size_t i = 0; i < count; i++) {
+    uint32_t v;
+    std::memcpy(&v, src + 4 * i, 4);
+    v = __builtin_bswap32(v);
+    std::memcpy(dst + 4 * i, &v, 4);
+  }
+}
+
+#ifdef DOTCHAT_BYTE_ORDER_X86
+// the shuffle masks reverse each 2- or 4-byte group within every 128-bit lane
+__attribute__((target("ssse3")))
+void swap16_ssse3(const uint8_t *src, uint8_t *dst, size_t count) {
+  const __m128i mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  size_t i = 0;
+  for(; i + 8 <= count; i += 8) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), _mm_shuffle_epi8(v, mask));
+  }
+  swap16_scalar(src + 2 * i, dst + 2 * i, count - i);
+}
+
+__attribute__((target("ssse3")))
+void swap32_ssse3(const uint8_t *src, uint8_t *dst, size_t count) {
+  const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  size_t i = 0;
+  for(; i + 4 <= count; i += 4) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * i), _mm_shuffle_epi8(v, mask));
+  }
+  swap32_scalar(src + 4 * i, dst + 4 * i, count - i);
+}
+
+__attribute__((target("avx2")))
+void swap16_avx2(const uint8_t *src, uint8_t *dst, size_t count) {
+  const __m256i mask = _mm256_setr_epi8(
+      1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+      1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+  );
+  size_t i = 0;
+  for(; i + 16 <= count; i += 16) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i), _mm256_shuffle_epi8(v, mask));
+  }
+  swap16_ssse3(src + 2 * i, dst + 2 * i, count - i);
+}
+
+__attribute__((target("avx2")))
+void swap32_avx2(const uint8_t *src, uint8_t *dst, size_t count) {
+  const __m256i mask = _mm256_setr_epi8(
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+  );
+  size_t i = 0;
+  for(; i + 8 <= count; i += 8) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_shuffle_epi8(v, mask));
+  }
+  swap32_ssse3(src + 4 * i, dst + 4 * i, count - i);
+}
+#endif
+
+const swap_impl &select_swap_impl() {
+  static const swap_impl impl = []() -> swap_impl {
+#ifdef DOTCHAT_BYTE_ORDER_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return { "avx2", swap16_avx2, swap32_avx2 };
+    if(__builtin_cpu_supports("ssse3")) return { "ssse3", swap16_ssse3, swap32_ssse3 };
+#endif
+    return { "scalar", swap16_scalar, swap32_scalar };
+  }();
+  return impl;
+}
+
+void proto::swap_copy_16(const void *src, void *dst, size_t count) {
+  select_swap_impl().swap16(static_cast<const uint8_t *>(src), static_cast<uint8_t *>(dst), count);
+}
+
+void proto::swap_copy_32(const void *src, void *dst, size_t count) {
+  select_swap_impl().swap32(static_cast<const uint8_t *>(src), static_cast<uint8_t *>(dst), count);
+}
+
+const char *proto::swap_copy_isa() {
+  return select_swap_impl().isa;
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        compression.cpp
+// Purpose:     Optional zstd compression of serialized messages (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 5:14 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <zstd.h>
+
+#include "protocol/compression.hpp"
+#include "protocol/message.hpp"
+#include "tracing/tracing.hpp"
+
+using namespace dotchat;
+using namespace dotchat::tls;
+using namespace dotchat::proto;
+
+/*
+ * --- COMPRESSED FRAME FORMAT ---
+ * .Z hexadecimal (2 bytes; magic number: 0x2E 0x5A)
+ * original_size (4 bytes; MSB)
+ * zstd frame (n bytes; carries the dictionary ID, if any)
+ */
+const static bytestream::byte frame_magic_1 = 0x2E;
+const static bytestream::byte frame_magic_2 = 0x5A;
+const static size_t frame_header_size = 6;
+
+struct zstd_dictionary {
+  ZSTD_CDict *cdict = nullptr;
+  ZSTD_DDict *ddict = nullptr;
+  unsigned id = 0;
+
+  ~zstd_dictionary() {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+  }
+};
+
+std::unique_ptr<zstd_dictionary> &loaded_dictionary() {
+  static std::unique_ptr<zstd_dictionary> dict;
+  return dict;
+}
+
+ZSTD_CCtx *thread_cctx() {
+  thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> ctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+  return ctx.get();
+}
+
+ZSTD_DCtx *thread_dctx() {
+  thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> ctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+  return ctx.get();
+}
+
+size_t &proto::compression_threshold() {
+  static size_t threshold = 512;
+  return threshold;
+}
+
+int &proto::compression_level() {
+  static int level = 3;
+  return level;
+}
+
+size_t &proto::max_decompressed_size() {
+  static size_t size = 16 * 1024 * 1024;
+  return size;
+}
+
+bool proto::load_dictionary(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if(!in) return false;
+  std::string raw{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+  // only trained dictionaries carry an ID, which is needed to tell frames with and without dictionary apart
+  auto id = ZSTD_getDictID_fromDict(raw.data(), raw.size());
+  if(id == 0) return false;
+
+  auto dict = std::make_unique<zstd_dictionary>();
+  dict->cdict = ZSTD_createCDict(raw.data(), raw.size(), compression_level());
+  dict->ddict = ZSTD_createDDict(raw.data(), raw.size());
+  dict->id = id;
+  if(dict->cdict == nullptr || dict->ddict == nullptr) return false;
+
+  loaded_dictionary() = std::move(dict);
+  return true;
+}
+
+bool proto::has_dictionary() {
+  return loaded_dictionary() != nullptr;
+}
+
+bool proto::is_compressed(bytestream &strm) {
+  return strm.size() >= 2 && strm.read_start()[0] == frame_magic_1 && strm.read_start()[1] == frame_magic_2;
+}
+
+bool proto::compress(bytestream &strm, bytestream &scratch) {
+  size_t size = strm.size();
+  if(size < compression_threshold() || size > UINT32_MAX) return false;
+
+  tracing::span span("compress");
+  size_t bound = ZSTD_compressBound(size);
+  scratch.cleanse();
+  auto *dst = scratch.append_space(frame_header_size + bound).data();
+  dst[0] = frame_magic_1;
+  dst[1] = frame_magic_2;
+  for(size_t i = 0; i < 4; i++) dst[2 + i] = static_cast<bytestream::byte>(size >> (8 * (3 - i)));
+
+  const auto &dict = loaded_dictionary();
+  size_t got = dict != nullptr ?
+      ZSTD_compress_usingCDict(thread_cctx(), dst + frame_header_size, bound, strm.read_start(), size, dict->cdict) :
+      ZSTD_compressCCtx(thread_cctx(), dst + frame_header_size, bound, strm.read_start(), size, compression_level());
+
+  if(ZSTD_isError(got) || frame_header_size + got >= size) {
+    scratch.cleanse();
+    return false;
+  }
+
+  scratch.drop_tail(bound - got);
+  strm.swap(scratch);
+  scratch.cleanse();
+  return true;
+}
+
+bool proto::decompress(bytestream &strm, bytestream &scratch) {
+  if(!is_compressed(strm)) return false;
+  if(strm.size() < frame_header_size) throw message_error("Can't parse message (truncated compressed frame)");
+
+  tracing::span span("decompress");
+  const auto *src = strm.read_start();
+  size_t size = 0;
+  for(size_t i = 0; i < 4; i++) size = (size << 8) | src[2 + i];
+  if(size > max_decompressed_size()) throw message_error("Can't parse message (compressed message too large)");
+
+  // a frame without dictionary ID must be decompressed without dictionary, and vice versa
+  const auto &dict = loaded_dictionary();
+  auto frame_dict = ZSTD_getDictID_fromFrame(src + frame_header_size, strm.size() - frame_header_size);
+  if(frame_dict != 0 && (dict == nullptr || dict->id != frame_dict))
+    throw message_error("Can't parse message (unknown compression dictionary)");
+
+  scratch.cleanse();
+  auto *dst = scratch.append_space(size).data();
+  size_t got = frame_dict != 0 ?
+      ZSTD_decompress_usingDDict(thread_dctx(), dst, size, src + frame_header_size, strm.size() - frame_header_size,
+                                 dict->ddict) :
+      ZSTD_decompressDCtx(thread_dctx(), dst, size, src + frame_header_size, strm.size() - frame_header_size);
+
+  if(ZSTD_isError(got)) throw message_error(std::string("Can't parse message (") + ZSTD_getErrorName(got) + ")");
+  if(got != size) throw message_error("Can't parse message (compressed frame size mismatch)");
+
+  strm.swap(scratch);
+  scratch.cleanse();
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        header_table.cpp
+// Purpose:     Per-connection table of command names and keys (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 7:42 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "protocol/header_table.hpp"
+#include "protocol/message.hpp"
+
+using namespace dotchat;
+using namespace dotchat::proto;
+
+std::optional<uint8_t> header_table::find(std::string_view name) const {
+  auto it = indices.find(name);
+  if(it == indices.end()) return std::nullopt;
+  return it->second;
+}
+
+const std::string &header_table::at(uint8_t index) const {
+  if(index >= names.size()) throw message_error("Can't parse message (unknown header table index)");
+  return names[index];
+}
+
+void header_table::add(std::string_view name) {
+  if(names.size() >= capacity || indices.contains(name)) return;
+  indices.emplace(std::string(name), static_cast<uint8_t>(names.size()));
+  names.emplace_back(name);
+}
+
+void header_table::truncate(size_t size) {
+  while(names.size() > size) {
+    indices.erase(names.back());
+    names.pop_back();
+  }
+}
\ No newline at end of file
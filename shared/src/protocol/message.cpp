@@ -8,13 +8,20 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include <bit>
+#include <span>
 #include <array>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <arpa/inet.h>
 
 #include "tls/tls_bytestream.hpp"
 #include "tls/tls_connection.hpp"
-#include "dynsize_array.hpp"
 #include "protocol/message.hpp"
+#include "protocol/byte_order.hpp"
+#include "tracing/tracing.hpp"
 
 using namespace dotchat;
 using namespace dotchat::tls;
@@ -32,15 +39,52 @@ inline const char *type_to_str(message::arg_type a){
 #undef X
 }
 
-std::string read_string(bytestream &stream) {
+template <typename Str = std::string>
+Str read_chars(bytestream &stream, uint8_t size) {
+  Str res(size, '\0');
+  auto got = stream.read({ reinterpret_cast<bytestream::byte *>(res.data()), size });
+  res.resize(got);
+  return res;
+}
+
+template <typename Str = std::string>
+Str read_string(bytestream &stream) {
   uint8_t size;
   stream >> size;
-  dyn_size_array<char> arr(size + 1);
-  for(uint8_t i = 0; i < size; i++) {
-    stream >> arr[i];
+  return read_chars<Str>(stream, size);
+}
+
+// since 0.7, names (commands and keys) in requests may be sent as an index into the connection's header table: a length
+// byte of 0x80 | index refers to a name in the table, and 0xFF is followed by the real length of a name of 128 or more
+// characters; each name sent in full is added to the table
+const static uint8_t header_index_flag = 0x80;
+const static uint8_t long_name_marker = 0xFF;
+
+std::string read_name(uint8_t size, bytestream &stream, header_table *table) {
+  if(table != nullptr) {
+    if(size == long_name_marker) stream >> size;
+    else if((size & header_index_flag) != 0) return table->at(size & ~header_index_flag);
   }
-  arr[size] = '\0';
-  return { arr.buf };
+
+  auto res = read_chars(stream, size);
+  if(table != nullptr) table->add(res);
+  return res;
+}
+
+// since 0.5, known commands are sent as an empty command string followed by their one-byte opcode
+std::string read_command(bytestream &stream, bool opcodes, header_table *table) {
+  uint8_t size;
+  stream >> size;
+  if(size == 0 && opcodes) {
+    uint8_t op;
+    stream >> op;
+    auto name = command_name(static_cast<opcode>(op));
+    if(name.empty()) throw message_error("Can't parse message (unknown command opcode)");
+    if(table != nullptr) table->add(name);
+    return std::string(name);
+  }
+
+  return read_name(size, stream, table);
 }
 
 uint32_t reorder(uint32_t tmp) { return ntohl(tmp); }
@@ -52,16 +96,99 @@ uint16_t reorder(uint16_t tmp) { return ntohs(tmp); }
 int16_t reorder(int16_t v) {
   return std::bit_cast<int16_t>(reorder(std::bit_cast<uint16_t>(v)));
 }
-
 template <typename T>
 concept requires_reorder =
     std::same_as<T, int16_t> || std::same_as<T, uint16_t> ||
     std::same_as<T, int32_t> || std::same_as<T, uint32_t>;
 
+// since 0.2, 16- and 32-bit integers may be sent as LEB128 varints (zigzag-encoded if signed), marked by this bit in
+// their type byte
+const static uint8_t compact_flag = 0x80;
+const static size_t max_varint_size = 5;
+// since 0.3, strings longer than 255 characters are sent with this type byte and a 32-bit length; they're received as
+// regular strings
+const static uint8_t long_string_type = 0x23;
+const static size_t max_short_string = 0xFF;
+// since 0.6, lists of sub-objects sharing the same keys (and value types) are sent as tables (with this type byte): the
+// keys and value types once, followed by the values column by column
+const static uint8_t table_type = 0x32;
+
+struct wire_format {
+  bool compact;
+  bool long_strings;
+  bool columnar;
+  header_table *table;
+};
+
+wire_format format_of(const message &m, header_table *table = nullptr) {
+  return {
+      m.uses_compact(), m.uses_long_strings(), m.uses_columnar(), m.uses_header_table() ? table : nullptr
+  };
+}
+
+std::string read_key(bytestream &stream, const wire_format &fmt) {
+  uint8_t size;
+  stream >> size;
+  return read_name(size, stream, fmt.table);
+}
+
+template <dotchat::proto::_intl_::is_packable T>
+uint32_t to_wire(T v) {
+  if constexpr(std::is_signed_v<T>) {
+    auto wide = static_cast<int32_t>(v);
+    return (static_cast<uint32_t>(wide) << 1) ^ static_cast<uint32_t>(wide >> 31);
+  }
+  else return v;
+}
+
+template <dotchat::proto::_intl_::is_packable T>
+T from_wire(uint32_t v) {
+  if constexpr(std::is_signed_v<T>) {
+    auto wide = static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+    if(wide < std::numeric_limits<T>::min() || wide > std::numeric_limits<T>::max())
+      throw message_error("Can't parse message (varint out of range)");
+    return static_cast<T>(wide);
+  }
+  else {
+    if(v > std::numeric_limits<T>::max())
+      throw message_error("Can't parse message (varint out of range)");
+    return static_cast<T>(v);
+  }
+}
+
+size_t varint_size(uint32_t v) {
+  size_t n = 1;
+  for(; v >= 0x80; v >>= 7) n++;
+  return n;
+}
+
+size_t put_varint(uint32_t v, bytestream::byte *out) {
+  size_t n = 0;
+  for(; v >= 0x80; v >>= 7) out[n++] = static_cast<bytestream::byte>(v | 0x80);
+  out[n++] = static_cast<bytestream::byte>(v);
+  return n;
+}
+
+uint32_t read_varint(bytestream &stream) {
+  const auto *src = stream.read_start();
+  size_t avail = std::min(stream.size(), max_varint_size);
+  uint32_t res = 0;
+  for(size_t i = 0; i < avail; i++) {
+    res |= static_cast<uint32_t>(src[i] & 0x7F) << (7 * i);
+    if((src[i] & 0x80) == 0) {
+      if(i == max_varint_size - 1 && src[i] > 0x0F)
+        throw message_error("Can't parse message (varint out of range)");
+      stream.skip(i + 1);
+      return res;
+    }
+  }
+  throw message_error("Can't parse message (unterminated varint)");
+}
+
 template <dotchat::proto::_intl_::is_repr T>
-T read_single(bytestream &stream) {
+T read_single(bytestream &stream, const wire_format & = {}) {
   std::array<bytestream::byte, sizeof(T)> arr = {};
-  stream.read(arr);
+  if(stream.read(arr) != arr.size()) throw message_error("Can't parse message (message is truncated)");
   T val = std::bit_cast<T>(arr);
 
   if constexpr (requires_reorder<T>) {
@@ -71,36 +198,148 @@ T read_single(bytestream &stream) {
   return val;
 }
 
-message::arg_obj read_arg_obj(bytestream &stream);
-message::arg read_value(message::arg_type type, bytestream &stream);
+uint32_t read_length(bytestream &stream, const wire_format &fmt) {
+  return fmt.compact ? read_varint(stream) : read_single<uint32_t>(stream);
+}
+
+arena_string read_long_string(bytestream &stream) {
+  auto size = read_single<uint32_t>(stream);
+  if(size > stream.size())
+    throw message_error("Can't parse message (string is longer than the message)");
+
+  arena_string res(reinterpret_cast<const char *>(stream.read_start()), size);
+  stream.skip(size);
+  return res;
+}
+
+message::arg_obj read_arg_obj(bytestream &stream, const wire_format &fmt);
+message::arg read_value(message::arg_type type, bytestream &stream, const wire_format &fmt);
 
 template <>
-std::string read_single<std::string>(bytestream &stream) {
+std::string read_single<std::string>(bytestream &stream, const wire_format &) {
   return read_string(stream);
 }
 
 template<>
-message::arg_obj read_single<message::arg_obj>(bytestream &stream) {
-  return read_arg_obj(stream);
+message::arg_obj read_single<message::arg_obj>(bytestream &stream, const wire_format &fmt) {
+  return read_arg_obj(stream, fmt);
+}
+
+template <dotchat::proto::_intl_::is_packable T>
+void read_packed(message::arg_list &list, uint32_t size, bytestream &stream) {
+  if(size > stream.size() / sizeof(T))
+    throw message_error("Can't parse message (list is longer than the message)");
+
+  auto dst = list.assign_packed<T>(size);
+  copy_big_endian<T>(stream.read_start(), dst.data(), size);
+  stream.skip(size * sizeof(T));
+}
+
+template <dotchat::proto::_intl_::is_packable T>
+void read_packed_varints(message::arg_list &list, uint32_t size, bytestream &stream) {
+  // each varint takes at least one byte
+  if(size > stream.size())
+    throw message_error("Can't parse message (list is longer than the message)");
+
+  auto dst = list.assign_packed<T>(size);
+  for(auto &val: dst) val = from_wire<T>(read_varint(stream));
+}
+
+message::arg_list read_table(uint32_t size, bytestream &stream, const wire_format &fmt) {
+  uint8_t count;
+  stream >> count;
+  if(count == 0)
+    throw message_error("Can't parse message (table without columns)");
+  // each row takes at least one byte in each column
+  size_t cell_count = static_cast<size_t>(size) * count;
+  if(cell_count > stream.size())
+    throw message_error("Can't parse message (table is longer than the message)");
+
+  std::vector<std::pair<std::string, message::arg_type>, arena_allocator<std::pair<std::string, message::arg_type>>>
+      columns;
+  columns.reserve(count);
+  for(uint8_t i = 0; i < count; i++) {
+    std::string key = read_key(stream, fmt);
+    uint8_t type_i;
+    stream >> type_i;
+    columns.emplace_back(std::move(key), static_cast<message::arg_type>(type_i));
+  }
+
+  // the values are read column by column, then moved into the rows (one object at a time)
+  std::vector<message::arg, arena_allocator<message::arg>> cells;
+  cells.reserve(cell_count);
+  for(const auto &[key, type]: columns) {
+    for(uint32_t r = 0; r < size; r++) cells.push_back(read_value(type, stream, fmt));
+  }
+
+  message::arg_list list;
+  for(uint32_t r = 0; r < size; r++) {
+    message::arg_obj row;
+    for(size_t c = 0; c < count; c++) row.set({ columns[c].first, std::move(cells[c * size + r]) });
+    list.push_back(message::arg{ std::move(row) });
+  }
+  return list;
 }
 
 template <>
-message::arg_list read_single<message::arg_list>(bytestream &stream) {
+message::arg_list read_single<message::arg_list>(bytestream &stream, const wire_format &fmt) {
   uint8_t contained;
   stream >> contained;
-  auto type = static_cast<message::arg_type>(contained);
-  auto size = read_single<uint32_t>(stream);
+  auto type = static_cast<message::arg_type>(contained & ~compact_flag);
+  auto size = read_length(stream, fmt);
+
+  if(fmt.columnar && contained == table_type) return read_table(size, stream, fmt);
 
   message::arg_list list;
+  if(fmt.compact && (contained & compact_flag) != 0) {
+    switch(type) {
+      case message::arg_type::INT16: read_packed_varints<int16_t>(list, size, stream); return list;
+      case message::arg_type::INT32: read_packed_varints<int32_t>(list, size, stream); return list;
+      case message::arg_type::UINT16: read_packed_varints<uint16_t>(list, size, stream); return list;
+      case message::arg_type::UINT32: read_packed_varints<uint32_t>(list, size, stream); return list;
+      default: throw message_error("Invalid type to read.");
+    }
+  }
+
+  type = static_cast<message::arg_type>(contained);
+  if(fmt.long_strings && contained == long_string_type) {
+    for(size_t i = 0; i < size; i++) list.push_back(message::arg{ read_long_string(stream) });
+    return list;
+  }
+  // lists of 16- and 32-bit integers are byte-swapped in one pass, straight into packed storage
+  switch(type) {
+    case message::arg_type::INT16: read_packed<int16_t>(list, size, stream); return list;
+    case message::arg_type::INT32: read_packed<int32_t>(list, size, stream); return list;
+    case message::arg_type::UINT16: read_packed<uint16_t>(list, size, stream); return list;
+    case message::arg_type::UINT32: read_packed<uint32_t>(list, size, stream); return list;
+    default: break;
+  }
+
   for(size_t i = 0; i < size; i++) {
-    list.push_back(read_value(type, stream));
+    list.push_back(read_value(type, stream, fmt));
   }
   return list;
 }
 
+message::arg read_compact_value(message::arg_type type, bytestream &stream) {
+  switch(type) {
+    case message::arg_type::INT16: return message::arg{ from_wire<int16_t>(read_varint(stream)) };
+    case message::arg_type::INT32: return message::arg{ from_wire<int32_t>(read_varint(stream)) };
+    case message::arg_type::UINT16: return message::arg{ from_wire<uint16_t>(read_varint(stream)) };
+    case message::arg_type::UINT32: return message::arg{ from_wire<uint32_t>(read_varint(stream)) };
+    default: throw message_error("Invalid type to read.");
+  }
+}
 
-message::arg read_value(message::arg_type type, bytestream &stream) {
-#define X(v) case message::arg_type::v: return message::arg{ read_single<typename dotchat::proto::_intl_::matching_type_t<message::arg_type::v>>(stream) };
+message::arg read_value(message::arg_type type, bytestream &stream, const wire_format &fmt) {
+#define X(v) case message::arg_type::v: return message::arg{ read_single<typename dotchat::proto::_intl_::matching_type_t<message::arg_type::v>>(stream, fmt) };
+  auto raw = static_cast<uint8_t>(type);
+  if(fmt.compact && (raw & compact_flag) != 0)
+    return read_compact_value(static_cast<message::arg_type>(raw & ~compact_flag), stream);
+  if(fmt.long_strings && raw == long_string_type)
+    return message::arg{ read_long_string(stream) };
+  // strings are read straight into the current arena
+  if(type == message::arg_type::STRING) return message::arg{ read_string<arena_string>(stream) };
   switch(type) {
     TYPES
 
@@ -110,37 +349,44 @@ message::arg read_value(message::arg_type type, bytestream &stream) {
 #undef X
 }
 
-message::arg_obj read_arg_obj(bytestream &stream) {
+message::arg_obj read_arg_obj(bytestream &stream, const wire_format &fmt) {
   message::arg_obj res;
   uint8_t count;
   stream >> count;
   for(uint8_t i = 0; i < count; i++) {
-    std::string key = read_string(stream);
+    std::string key = read_key(stream, fmt);
     uint8_t type_i;
     stream >> type_i;
     auto type = static_cast<message::arg_type>(type_i);
-    auto value = read_value(type, stream);
-    res.set({ key, value });
+    res.set({ std::move(key), read_value(type, stream, fmt) });
   }
   return res;
 }
 
-message::message(bytestream &stream) {
-  byte b1;
-  byte b2;
-  stream >> b1 >> b2;
-
-  if(!magic_number_match(b1, b2))
-    throw message_error("Can't parse message (missing magic number)");
-
-  stream >> protocol_major >> protocol_minor;
-  if(protocol_major > preferred_major_version())
-    throw message_error("Can't parse message (incompatible major version)");
-  if(protocol_major == preferred_major_version() && protocol_minor > preferred_minor_version())
-    throw message_error("Can't parse message (incompatible minor version)");
-
-  cmd = read_string(stream);
-  args = read_arg_obj(stream);
+message::message(bytestream &stream, header_table *table) {
+  tracing::span span("decode");
+  try {
+    byte b1;
+    byte b2;
+    stream >> b1 >> b2;
+
+    if(!magic_number_match(b1, b2))
+      throw message_error("Can't parse message (missing magic number)");
+
+    stream >> protocol_major >> protocol_minor;
+    if(protocol_major > preferred_major_version())
+      throw message_error("Can't parse message (incompatible major version)");
+    // newer minor versions only add encodings; the peer falls back to ours once we reply (see `negotiate`), and any
+    // encoding we don't know still fails as an invalid type
+
+    auto fmt = format_of(*this, table);
+    cmd = read_command(stream, uses_opcodes(), fmt.table);
+    args = read_arg_obj(stream, fmt);
+  }
+  catch(const std::out_of_range &) {
+    // a single value ran past the end of the stream
+    throw message_error("Can't parse message (message is truncated)");
+  }
 }
 
 
@@ -153,8 +399,8 @@ int32_t reorder_send(int32_t v) {
   return std::bit_cast<int32_t>(reorder_send(std::bit_cast<uint32_t>(v)));
 }
 
-void send_one(const message::arg_obj &obj, bytestream &strm);
-void send_list(const message::arg_list &l, bytestream &strm);
+void send_one(const message::arg_obj &obj, bytestream &strm, const wire_format &fmt);
+void send_list(const message::arg_list &l, bytestream &strm, const wire_format &fmt);
 
 void send_val(int8_t v, bytestream &strm) { strm << v; }
 void send_val(uint8_t v, bytestream &strm) { strm << v; }
@@ -164,14 +410,81 @@ void send_val(int32_t v, bytestream &strm) { strm << reorder_send(v); }
 void send_val(uint32_t v, bytestream &strm) { strm << reorder_send(v); }
 void send_val(char v, bytestream &strm) { strm << v; }
 void send_val(std::string_view v, bytestream &strm) {
-  if(v.size() > 0xFF) throw message_error("String too long to send.");
+  if(v.size() > max_short_string) throw message_error("String too long to send.");
   strm << (message::byte)v.size();
-  for(const char &c: v) strm << c;
+  strm.write({ reinterpret_cast<message::byte *>(const_cast<char *>(v.data())), v.size() });
+}
+
+void send_long_val(std::string_view v, bytestream &strm) {
+  if(v.size() > std::numeric_limits<uint32_t>::max()) throw message_error("String too long to send.");
+  send_val((uint32_t)v.size(), strm);
+  strm.write({ reinterpret_cast<message::byte *>(const_cast<char *>(v.data())), v.size() });
+}
+
+void send_name(std::string_view name, bytestream &strm, header_table *table) {
+  if(table == nullptr) return send_val(name, strm);
+  if(auto index = table->find(name); index.has_value()) {
+    strm << static_cast<message::byte>(header_index_flag | *index);
+    return;
+  }
+
+  if(name.size() > max_short_string) throw message_error("String too long to send.");
+  if(name.size() >= header_index_flag) strm << long_name_marker;
+  send_val(name, strm);
+  table->add(name);
 }
 
-#define SUBSET X(INT8) X(INT16) X(INT32) X(UINT8) X(UINT16) X(UINT32) X(CHAR) X(STRING)
+void send_varint(uint32_t v, bytestream &strm) {
+  auto dst = strm.append_space(max_varint_size);
+  strm.drop_tail(max_varint_size - put_varint(v, dst.data()));
+}
+
+void send_length(size_t n, bytestream &strm, const wire_format &fmt) {
+  if(fmt.compact) send_varint((uint32_t)n, strm);
+  else send_val((uint32_t)n, strm);
+}
+
+template <dotchat::proto::_intl_::is_packable T>
+void send_int(T v, bytestream &strm, const wire_format &fmt) {
+  constexpr auto type = static_cast<uint8_t>(dotchat::proto::_intl_::matching_enum<T>::val);
+  auto wire = to_wire(v);
+  if(fmt.compact && varint_size(wire) < sizeof(T)) {
+    strm << static_cast<uint8_t>(type | compact_flag);
+    send_varint(wire, strm);
+  }
+  else {
+    strm << type;
+    send_val(v, strm);
+  }
+}
+
+#define SUBSET X(INT8) X(UINT8) X(CHAR)
+
+void send_arg(const message::arg &a, bytestream &strm, const wire_format &fmt, bool send_type = true) {
+  // 16- and 32-bit integers pick their own (fixed or compact) type byte, long strings their own type byte
+  switch(a.type()) {
+    case message::arg_type::INT16:
+      if(send_type) return send_int(a.get<message::arg_type::INT16>(), strm, fmt);
+      break;
+    case message::arg_type::INT32:
+      if(send_type) return send_int(a.get<message::arg_type::INT32>(), strm, fmt);
+      break;
+    case message::arg_type::UINT16:
+      if(send_type) return send_int(a.get<message::arg_type::UINT16>(), strm, fmt);
+      break;
+    case message::arg_type::UINT32:
+      if(send_type) return send_int(a.get<message::arg_type::UINT32>(), strm, fmt);
+      break;
+    case message::arg_type::STRING:
+      if(send_type && fmt.long_strings && a.string_view().size() > max_short_string) {
+        strm << long_string_type;
+        return send_long_val(a.string_view(), strm);
+      }
+      break;
+    default:
+      break;
+  }
 
-void send_arg(const message::arg &a, bytestream &strm, bool send_type = true) {
   if(send_type) strm << (int8_t)a.type();
 #define X(v) case message::arg_type::v: \
   send_val(a.get<message::arg_type::v>(), strm); \
@@ -179,41 +492,196 @@ void send_arg(const message::arg &a, bytestream &strm, bool send_type = true) {
 
   switch(a.type()) {
     SUBSET
+    X(INT16) X(INT32) X(UINT16) X(UINT32)
 
+    // strings, lists and sub-objects are sent in-place, without copying them out of the argument value
+    case message::arg_type::STRING:
+      send_val(a.string_view(), strm);
+      break;
     case message::arg_type::LIST:
-      send_list(static_cast<message::arg_list>(a), strm);
+      send_list(a.list_ref(), strm, fmt);
       break;
     case message::arg_type::SUB_OBJECT:
-      send_one(static_cast<message::arg_obj>(a), strm);
+      send_one(a.obj_ref(), strm, fmt);
       break;
 
     default:
       throw message_error("Can't send this object.");
   }
+#undef X
 }
 
-void send_one(const message::arg_obj &obj, bytestream &strm) {
+void send_one(const message::arg_obj &obj, bytestream &strm, const wire_format &fmt) {
   if(obj.size() > 0xFF) throw message_error("Too much arguments.");
   strm << (message::byte)obj.size();
-  for(const auto &key: obj) {
-    send_val(key, strm);
-    send_arg(obj[key], strm);
+  for(const auto &[key, value]: obj.entries()) {
+    send_name(key, strm, fmt.table);
+    send_arg(value, strm, fmt);
   }
 }
 
-void send_list(const message::arg_list &l, bytestream &strm) {
-  strm << (int8_t)l.type();
-  send_val((uint32_t)l.size(), strm);
-  for(const auto v: l) {
-    send_arg(v, strm, false);
+template <dotchat::proto::_intl_::is_packable T>
+void send_packed(std::span<const T> values, bytestream &strm, const wire_format &fmt) {
+  constexpr auto type = static_cast<uint8_t>(dotchat::proto::_intl_::matching_enum<T>::val);
+  if(fmt.compact) {
+    size_t total = 0;
+    for(const auto &val: values) total += varint_size(to_wire(val));
+
+    // only use varints if they actually save space (small ids do, random tokens don't)
+    if(total < values.size_bytes()) {
+      strm << static_cast<uint8_t>(type | compact_flag);
+      send_length(values.size(), strm, fmt);
+      auto *dst = strm.append_space(total).data();
+      for(const auto &val: values) dst += put_varint(to_wire(val), dst);
+      return;
+    }
   }
+
+  strm << type;
+  send_length(values.size(), strm, fmt);
+  auto dst = strm.append_space(values.size_bytes());
+  copy_big_endian<T>(values.data(), dst.data(), values.size());
 }
 
-void message::send_to(tls::bytestream &strm) const {
-  strm << (byte)0x2E << (byte)0x43
-       << preferred_major_version() << preferred_minor_version();
+using column_t = std::span<const message::arg *const>;
 
-  send_val(cmd, strm);
+// picks the type byte for a table column, like `send_list` does for a list
+uint8_t column_type(message::arg_type type, column_t values, const wire_format &fmt) {
+  auto raw = static_cast<uint8_t>(type);
+  size_t fixed = 0;
+  size_t total = 0;
+  switch(type) {
+    case message::arg_type::INT16: case message::arg_type::UINT16: fixed = 2; break;
+    case message::arg_type::INT32: case message::arg_type::UINT32: fixed = 4; break;
+    case message::arg_type::STRING:
+      if(fmt.long_strings && std::any_of(values.begin(), values.end(), [](const auto *v) {
+        return v->string_view().size() > max_short_string;
+      })) return long_string_type;
+      return raw;
+    default: return raw;
+  }
 
-  send_one(args, strm);
+  if(!fmt.compact) return raw;
+  for(const auto *v: values) {
+    switch(type) {
+      case message::arg_type::INT16: total += varint_size(to_wire(v->get<message::arg_type::INT16>())); break;
+      case message::arg_type::INT32: total += varint_size(to_wire(v->get<message::arg_type::INT32>())); break;
+      case message::arg_type::UINT16: total += varint_size(to_wire(v->get<message::arg_type::UINT16>())); break;
+      default: total += varint_size(to_wire(v->get<message::arg_type::UINT32>())); break;
+    }
+  }
+  return total < fixed * values.size() ? static_cast<uint8_t>(raw | compact_flag) : raw;
+}
+
+void send_column(uint8_t wire_type, column_t values, bytestream &strm, const wire_format &fmt) {
+  if(wire_type == long_string_type) {
+    for(const auto *v: values) send_long_val(v->string_view(), strm);
+  }
+  else if((wire_type & compact_flag) != 0) {
+    for(const auto *v: values) {
+      switch(v->type()) {
+        case message::arg_type::INT16: send_varint(to_wire(v->get<message::arg_type::INT16>()), strm); break;
+        case message::arg_type::INT32: send_varint(to_wire(v->get<message::arg_type::INT32>()), strm); break;
+        case message::arg_type::UINT16: send_varint(to_wire(v->get<message::arg_type::UINT16>()), strm); break;
+        default: send_varint(to_wire(v->get<message::arg_type::UINT32>()), strm); break;
+      }
+    }
+  }
+  else {
+    for(const auto *v: values) send_arg(*v, strm, fmt, false);
+  }
+}
+
+// sends a list of sub-objects as a table; returns false (without sending anything) if they don't share their keys and
+// value types (or if there are too few of them to gain anything)
+bool send_table(const message::arg_list &l, bytestream &strm, const wire_format &fmt) {
+  if(!fmt.columnar || l.type() != message::arg_type::SUB_OBJECT || l.size() < 2) return false;
+  const auto &first = l[0].obj_ref().entries();
+  size_t rows = l.size();
+  size_t cols = first.size();
+  if(cols == 0 || cols > 0xFF) return false;
+
+  // the values, column by column (the keys are sorted, so they're in the same order in each row)
+  std::vector<const message::arg *, arena_allocator<const message::arg *>> cells(rows * cols);
+  for(size_t r = 0; r < rows; r++) {
+    const auto &row = l[r].obj_ref().entries();
+    if(row.size() != cols) return false;
+
+    size_t c = 0;
+    for(auto it = row.begin(), ref = first.begin(); it != row.end(); ++it, ++ref, ++c) {
+      if(it->first != ref->first || it->second.type() != ref->second.type()) return false;
+      cells[c * rows + r] = &it->second;
+    }
+  }
+
+  strm << table_type;
+  send_length(rows, strm, fmt);
+  strm << (message::byte)cols;
+  std::vector<uint8_t, arena_allocator<uint8_t>> types(cols);
+  size_t c = 0;
+  for(const auto &[key, value]: first) {
+    types[c] = column_type(value.type(), column_t(cells).subspan(c * rows, rows), fmt);
+    send_name(key, strm, fmt.table);
+    strm << types[c];
+    c++;
+  }
+
+  for(c = 0; c < cols; c++) send_column(types[c], column_t(cells).subspan(c * rows, rows), strm, fmt);
+  return true;
+}
+
+void send_list(const message::arg_list &l, bytestream &strm, const wire_format &fmt) {
+  if(send_table(l, strm, fmt)) return;
+
+  switch(l.type()) {
+    case message::arg_type::INT16: send_packed(l.packed<int16_t>(), strm, fmt); return;
+    case message::arg_type::INT32: send_packed(l.packed<int32_t>(), strm, fmt); return;
+    case message::arg_type::UINT16: send_packed(l.packed<uint16_t>(), strm, fmt); return;
+    case message::arg_type::UINT32: send_packed(l.packed<uint32_t>(), strm, fmt); return;
+    default: break;
+  }
+
+  if(l.type() == message::arg_type::STRING && fmt.long_strings) {
+    bool any_long = false;
+    for(size_t i = 0; i < l.size() && !any_long; i++) any_long = l[i].string_view().size() > max_short_string;
+
+    // one long string makes the whole list a list of long strings
+    if(any_long) {
+      strm << long_string_type;
+      send_length(l.size(), strm, fmt);
+      for(size_t i = 0; i < l.size(); i++) send_long_val(l[i].string_view(), strm);
+      return;
+    }
+  }
+
+  strm << (int8_t)l.type();
+  send_length(l.size(), strm, fmt);
+  for(size_t i = 0; i < l.size(); i++) {
+    send_arg(l[i], strm, fmt, false);
+  }
+}
+
+void message::send_to(tls::bytestream &strm, header_table *table) const {
+  tracing::span span("send_to");
+  auto fmt = format_of(*this, table);
+  // names added to the table while encoding a message which isn't sent after all would never reach the peer's table
+  size_t table_size = fmt.table == nullptr ? 0 : fmt.table->size();
+  try {
+    strm << (byte)0x2E << (byte)0x43
+         << protocol_major << protocol_minor;
+
+    // an indexed command is even shorter than an opcode
+    auto op = get_opcode();
+    if(op != opcode::none && uses_opcodes() && (fmt.table == nullptr || !fmt.table->find(cmd).has_value())) {
+      strm << (byte)0x00 << static_cast<byte>(op);
+      if(fmt.table != nullptr) fmt.table->add(cmd);
+    }
+    else send_name(cmd, strm, fmt.table);
+
+    send_one(args, strm, fmt);
+  }
+  catch(...) {
+    if(fmt.table != nullptr) fmt.table->truncate(table_size);
+    throw;
+  }
 }
\ No newline at end of file
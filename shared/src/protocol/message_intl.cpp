@@ -13,6 +13,8 @@ using namespace dotchat::proto::_intl_;
 
 arg::arg(const arg_list &val)  : _type{matching_enum<arg_list>::val}, _content{val} {}
 arg::arg(const arg_obj &val)  : _type{matching_enum<arg_obj>::val}, _content{val} {}
+arg::arg(arg_list &&val)  : _type{matching_enum<arg_list>::val}, _content{std::move(val)} {}
+arg::arg(arg_obj &&val)  : _type{matching_enum<arg_obj>::val}, _content{std::move(val)} {}
 
 arg &arg::operator=(const arg_list &l) {
   _type = matching_enum<arg_list>::val;
@@ -38,6 +40,16 @@ arg::operator arg_obj() const {
   else throw std::bad_any_cast();
 }
 
+const arg_list &arg::list_ref() const {
+  if(_type == matching_enum<arg_list>::val) return std::any_cast<const arg_list &>(_content);
+  else throw std::bad_any_cast();
+}
+
+const arg_obj &arg::obj_ref() const {
+  if(_type == matching_enum<arg_obj>::val) return std::any_cast<const arg_obj &>(_content);
+  else throw std::bad_any_cast();
+}
+
 arg_list &arg_list::get_list(size_t n) {
   if(_contained == matching_enum<arg_list>::val)
     return *std::any_cast<arg_list *>(&_content[n]);
@@ -66,9 +78,48 @@ const arg_obj &arg_list::get_obj(size_t n) const {
     throw std::bad_any_cast();
 }
 
+void arg_list::start(val_types type) {
+  _contained = type;
+  _content.clear();
+  switch(type) {
+    case val_types::INT16: _packed.emplace<packed_vector<int16_t>>(); break;
+    case val_types::INT32: _packed.emplace<packed_vector<int32_t>>(); break;
+    case val_types::UINT16: _packed.emplace<packed_vector<uint16_t>>(); break;
+    case val_types::UINT32: _packed.emplace<packed_vector<uint32_t>>(); break;
+    default: _packed.emplace<std::monostate>(); break;
+  }
+}
+
+arg arg_list::value(size_t n) const {
+  return std::visit([this, n]<typename V>(const V &packed) {
+    if constexpr(std::same_as<V, std::monostate>) return _content[n];
+    else return arg(packed[n]);
+  }, _packed);
+}
+
+void arg_list::push_back(const arg &val) {
+  if(size() == 0) start(val.type());
+  if(val.type() != _contained) throw std::bad_any_cast();
+
+  switch(_packed.index()) {
+    case 1: std::get<1>(_packed).push_back(static_cast<int16_t>(val)); break;
+    case 2: std::get<2>(_packed).push_back(static_cast<int32_t>(val)); break;
+    case 3: std::get<3>(_packed).push_back(static_cast<uint16_t>(val)); break;
+    case 4: std::get<4>(_packed).push_back(static_cast<uint32_t>(val)); break;
+    default: _content.push_back(val); break;
+  }
+}
+
+void arg_list::push_back(arg &&val) {
+  if(size() == 0) start(val.type());
+  if(is_packed()) return push_back(static_cast<const arg &>(val));
+  if(val.type() != _contained) throw std::bad_any_cast();
+  _content.push_back(std::move(val));
+}
+
 void arg_list::push_back(const arg_list &val) {
-  if(_content.empty())
-    _contained = matching_enum<arg_list>::val;
+  if(size() == 0)
+    start(matching_enum<arg_list>::val);
   if(_contained == matching_enum<arg_list>::val)
     _content.emplace_back(val);
   else
@@ -76,8 +127,8 @@ void arg_list::push_back(const arg_list &val) {
 }
 
 void arg_list::push_back(const arg_obj &val) {
-  if(_content.empty())
-    _contained = matching_enum<arg_obj>::val;
+  if(size() == 0)
+    start(matching_enum<arg_obj>::val);
   if(_contained == matching_enum<arg_obj>::val)
     _content.emplace_back(val);
   else
@@ -8,6 +8,8 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include <string>
+#include <cstring>
+#include <algorithm>
 #include "protocol/message.hpp"
 #include "protocol/requests.hpp"
 #include "protocol/helpers.hpp"
@@ -26,18 +28,42 @@ std::pair<std::string, T> paired(std::string key, T val) {
   return std::make_pair(key, val);
 }
 
+// TOKENS
+token_t dotchat::proto::legacy_token(int32_t key) {
+  token_t res(sizeof(key), '\0');
+  std::memcpy(res.data(), &key, sizeof(key));
+  return res;
+}
+
+int32_t dotchat::proto::legacy_key(const token_t &token) {
+  int32_t key = 0;
+  std::memcpy(&key, token.data(), std::min(token.size(), sizeof(key)));
+  return key;
+}
+
+token_t dotchat::proto::require_token(const std::string &key, const message::arg_obj &source) {
+  if(source.contains(key) && source.type(key) == _intl_::val_types::INT32)
+    return legacy_token(require_arg<int32_t>(key, source));
+  return require_arg<token_t>(key, source);
+}
+
+void dotchat::proto::set_token(const std::string &key, const token_t &token, message::arg_obj &target) {
+  if(is_legacy_token(token)) target.set(paired(key, legacy_key(token)));
+  else target.set(paired(key, token));
+}
+
 // TOKEN REQUEST
 token_request token_request::from(const dotchat::proto::message &m) {
+  if(!m.map().contains("token")) return { .token = bound_token };
   return {
-    .token = require_arg<decltype(token)>("token", m.map())
+    .token = require_token("token", m.map())
   };
 }
 
 message token_request::to_intl(const message::command &command) const {
-  return message(
-      command,
-      paired("token", token)
-  );
+  message res(command);
+  if(token != bound_token) set_token("token", token, res.map());
+  return res;
 }
 
 // LOGIN REQUEST
@@ -81,15 +107,18 @@ channel_msg_request channel_msg_request::from(const message &m) {
   check_command(request_commands::channel_msg, m);
   return {
     token_request::from(m),
-    require_arg<decltype(chan_id)>("chan_id", m.map()) // channel id
+    require_arg<decltype(chan_id)>("chan_id", m.map()), // channel id
+    m.map().contains("last") ? require_arg<decltype(last)>("last", m.map()) : 0
   };
 }
 
 message channel_msg_request::to() const {
-  return {
+  message res(
       token_request::to_intl(request_commands::channel_msg),
       paired("chan_id", chan_id)
-  };
+  );
+  if(last > 0) res.map().set(paired("last", last));
+  return res;
 }
 
 // MESSAGE SEND REQUEST
@@ -212,4 +241,14 @@ message invite_user_request::to() const {
     paired("uid", uid),
     paired("chan_id", chan_id)
   };
+}
+
+// PING REQUEST
+ping_request ping_request::from(const message &m) {
+  check_command(request_commands::ping, m);
+  return {};
+}
+
+message ping_request::to() const {
+  return message(request_commands::ping);
 }
\ No newline at end of file
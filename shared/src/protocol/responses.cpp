@@ -34,7 +34,8 @@ message okay_response::to() const {
 // ERROR RESPONSE
 error_response error_response::from(const dotchat::proto::message &m) {
   return {
-    .reason = require_arg<std::string>("reason", m.map())
+    .reason = require_arg<std::string>("reason", m.map()),
+    .retry_ms = m.map().contains("retry_ms") ? require_arg<int32_t>("retry_ms", m.map()) : 0
   };
 }
 
@@ -45,25 +46,45 @@ error_response error_response::from(const dotchat::proto::proto_error &err) {
 }
 
 message error_response::to() const {
-  return message(
+  message res(
       response_commands::error,
       paired("reason", reason)
   );
+  if(retry_ms > 0) res.map().set(paired("retry_ms", retry_ms));
+  return res;
+}
+
+// PONG RESPONSE
+pong_response pong_response::from(const dotchat::proto::message &m) {
+  if(m.get_command() != response_commands::pong)
+    throw proto_error("Expected command `" + response_commands::pong + "`, but got `" + m.get_command() + "`");
+  if(!m.map().contains("major") || !m.map().contains("minor")) return {};
+  return {
+    .major = require_arg<message::byte>("major", m.map()),
+    .minor = require_arg<message::byte>("minor", m.map())
+  };
+}
+
+message pong_response::to() const {
+  return message(
+      response_commands::pong,
+      paired("major", major),
+      paired("minor", minor)
+  );
 }
 
 // TOKEN RESPONSE
 token_response token_response::from(const dotchat::proto::message &m) {
   return token_response{
     okay_response::from(m),
-    require_arg<decltype(token)>("token", m.map()) // token
+    require_token("token", m.map()) // token
   };
 }
 
 message token_response::to() const {
-  return {
-      (*this).okay_response::to(),
-      paired("token", token)
-  };
+  message res = (*this).okay_response::to();
+  set_token("token", token, res.map());
+  return res;
 }
 
 // ID RESPONSE
@@ -161,14 +182,11 @@ channel_details_response channel_details_response::from(const dotchat::proto::me
   auto cowner = require_arg<decltype(owner_id)>("owner_id", m.map());
   auto cdesc = require_arg<std::string>("desc", m.map());
 
-  auto lst = require_arg<message::arg_list>("members", m.map());
-  decltype(members) res;
-  for(const auto &val: lst) {
-    if(val.type() != _intl_::matching_enum<decltype(res)::value_type>::val)
-      throw proto_error("Invalid contained type in channel_details_response.members");
-
-    res.push_back(static_cast<decltype(res)::value_type>(val));
-  }
+  const auto &lst = require_list("members", m.map());
+  if(lst.size() != 0 && lst.type() != _intl_::matching_enum<decltype(members)::value_type>::val)
+    throw proto_error("Invalid contained type in channel_details_response.members");
+  auto packed = lst.packed<decltype(members)::value_type>();
+  decltype(members) res(packed.begin(), packed.end());
 
   return {
       {},
@@ -178,7 +196,7 @@ channel_details_response channel_details_response::from(const dotchat::proto::me
 
 message channel_details_response::to() const {
   message::arg_list lst;
-  for(const auto &mem: members) lst.push_back(mem);
+  lst.append<decltype(members)::value_type>(members);
 
   return {
       (*this).okay_response::to(),
@@ -195,14 +213,11 @@ user_details_response user_details_response::from(const dotchat::proto::message
   auto _id = require_arg<decltype(id)>("id", m.map());
   auto _name = require_arg<decltype(name)>("name", m.map());
 
-  auto lst = require_arg<message::arg_list>("mutual_channels", m.map());
-  decltype(mutual_channels) _mutual;
-  for(const auto &val: lst) {
-    if(val.type() != _intl_::matching_enum<decltype(_mutual)::value_type>::val)
-      throw proto_error("Invalid contained type in user_details_response.mutual_channels");
-
-    _mutual.push_back(static_cast<decltype(_mutual)::value_type>(val));
-  }
+  const auto &lst = require_list("mutual_channels", m.map());
+  if(lst.size() != 0 && lst.type() != _intl_::matching_enum<decltype(mutual_channels)::value_type>::val)
+    throw proto_error("Invalid contained type in user_details_response.mutual_channels");
+  auto packed = lst.packed<decltype(mutual_channels)::value_type>();
+  decltype(mutual_channels) _mutual(packed.begin(), packed.end());
 
   return {
       {},
@@ -212,7 +227,7 @@ user_details_response user_details_response::from(const dotchat::proto::message
 
 message user_details_response::to() const {
   message::arg_list lst;
-  for(const auto &mut: mutual_channels) lst.push_back(mut);
+  lst.append<decltype(mutual_channels)::value_type>(mutual_channels);
 
   return {
       (*this).okay_response::to(),
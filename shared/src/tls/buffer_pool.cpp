@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        buffer_pool.cpp
+// Purpose:     Pool of reusable I/O buffers (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 3:37 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "tls/buffer_pool.hpp"
+#include <bit>
+#include <algorithm>
+
+using namespace dotchat;
+using namespace dotchat::tls;
+
+// the smallest class whose buffers are all at least `capacity` bytes
+size_t class_for_request(size_t capacity) {
+  auto log = static_cast<size_t>(std::bit_width(std::max(capacity, size_t{1}) - 1));
+  return std::max(log, buffer_pool::min_class_log) - buffer_pool::min_class_log;
+}
+
+// the largest class whose minimum is at most `capacity` bytes
+size_t class_for_spare(size_t capacity) {
+  return static_cast<size_t>(std::bit_width(capacity)) - 1 - buffer_pool::min_class_log;
+}
+
+buffer_pool::buffer_pool() {
+  for(auto &c: classes) c.spares.reserve(max_spares);
+}
+
+buffer_pool &buffer_pool::instance() {
+  // never destroyed: byte streams in other static objects may still give their buffers back during shutdown
+  static auto *pool = new buffer_pool();
+  return *pool;
+}
+
+buffer_pool::buffer_t buffer_pool::acquire(size_t capacity) {
+  if(size_t idx = class_for_request(capacity); idx < classes.size()) {
+    auto &c = classes[idx];
+    std::unique_lock guard { c.lock };
+    if(!c.spares.empty()) {
+      buffer_t res = std::move(c.spares.back());
+      c.spares.pop_back();
+      hit_count.fetch_add(1, std::memory_order_relaxed);
+      return res;
+    }
+    guard.unlock();
+
+    buffer_t res;
+    res.reserve(size_t{1} << (idx + min_class_log));
+    miss_count.fetch_add(1, std::memory_order_relaxed);
+    return res;
+  }
+
+  buffer_t res;
+  res.reserve(capacity);
+  miss_count.fetch_add(1, std::memory_order_relaxed);
+  return res;
+}
+
+void buffer_pool::release(buffer_t &&buf) {
+  if(buf.capacity() < (size_t{1} << min_class_log) || buf.capacity() >= (size_t{1} << (max_class_log + 1))) return;
+
+  auto &c = classes[class_for_spare(buf.capacity())];
+  buf.clear();
+  std::unique_lock guard { c.lock };
+  if(c.spares.size() < max_spares) c.spares.push_back(std::move(buf));
+}
\ No newline at end of file
@@ -9,9 +9,15 @@
 
 #include "tls/tls_connection.hpp"
 #include "tls/tls_error.hpp"
+#include "tracing/tracing.hpp"
+#include "logging/logging.hpp"
 #include "openssl/ssl.h"
-#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
 #include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
 
 #if __unix__
 #include <cerrno>
@@ -20,9 +26,24 @@
 using namespace dotchat;
 using namespace dotchat::tls;
 
-void dump_err(const SSL *ssl, int err) {
-  auto code = SSL_get_error(ssl, err);
-#define X(x) case (x): std::cerr << "Error " << (x) << ": " << #x << std::endl; break;
+const static size_t max_record_size = 16 * 1024;
+
+/*
+ * Length frame format:
+ * .L hexadecimal (2 bytes; magic number: 0x2E 0x4C)
+ * length (4 bytes; MSB) -> the size of the message which follows
+ */
+const static byte length_magic_1 = 0x2E;
+const static byte length_magic_2 = 0x4C;
+const static size_t length_header_size = 6;
+
+size_t &tls::max_message_size() {
+  static size_t size = 16 * 1024 * 1024;
+  return size;
+}
+
+std::string_view error_name(int code) {
+#define X(x) case (x): return #x;
   switch(code) {
     X(SSL_ERROR_NONE)
     X(SSL_ERROR_ZERO_RETURN)
@@ -36,56 +57,162 @@ void dump_err(const SSL *ssl, int err) {
     X(SSL_ERROR_WANT_CLIENT_HELLO_CB)
     X(SSL_ERROR_SYSCALL)
     X(SSL_ERROR_SSL)
-    default: std::cerr << "Error " << code << ": unknown?" << std::endl; break;
+    default: return "unknown?";
   }
+#undef X
+}
+
+void dump_err(const SSL *ssl, int err) {
+  auto code = SSL_get_error(ssl, err);
 
 #if __unix__
   if(code == SSL_ERROR_SYSCALL) {
-    std::cerr << "  -> inspecting *nix errno..." << std::endl;
-    std::cerr << "  -> *nix errno information: " << errno << " ~> " << strerror(errno) << std::endl;
+    logging::warn("SSL/TLS read failed", {
+      { "code", std::to_string(code) }, { "error", std::string(error_name(code)) },
+      { "errno", std::to_string(errno) }, { "errno_msg", strerror(errno) }
+    });
+    return;
   }
 #endif
+
+  logging::warn("SSL/TLS read failed", { { "code", std::to_string(code) }, { "error", std::string(error_name(code)) } });
 }
 
-tls_connection::tls_connection(const tls_context &ctxt, int conn_handle) : ssl{SSL_new(ctxt.get())}, conn_handle{conn_handle} {
+tls_connection::tls_connection(const tls_context &ctxt, int conn_handle, bool defer_handshake) :
+    ssl{SSL_new(ctxt.get())}, conn_handle{conn_handle} {
   SSL_set_fd(ssl, conn_handle);
-  if(ctxt.get_mode() == tls_context::mode::SERVER) {
-    if (SSL_accept(ssl) < 0) {
+  if(ctxt.get_mode() == tls_context::mode::SERVER) SSL_set_accept_state(ssl);
+  else SSL_set_connect_state(ssl);
+  if(!defer_handshake) {
+    try {
+      handshake();
+    }
+    catch(const tls_error &) {
+      // the destructor doesn't run for a throwing constructor
+      close();
+      throw;
+    }
+  }
+}
+
+void tls_connection::handshake() {
+  auto start = std::chrono::steady_clock::now();
+  if(SSL_is_server(ssl)) {
+    if(SSL_do_handshake(ssl) <= 0) {
       throw tls_error("Can't accept SSL/TLS connection.");
     }
   }
   else {
     // no host name verification. No idea if we need it?
-    if(SSL_connect(ssl) <= 0) {
+    if(SSL_do_handshake(ssl) <= 0) {
       throw tls_error("Can't connect using SSL/TLS.");
     }
   }
+  statistics.handshake = std::chrono::steady_clock::now() - start;
 }
 
 void tls_connection::operator<<(const end_of_msg) {
+  tracing::span span("SSL_write");
   if(SSL_write(ssl, buffer.buffer(), static_cast<int>(buffer.size())) < 0)
     throw tls_error("Can't send message");
-  buffer.cleanse();
+  statistics.bytes_out += buffer.size();
+  buffer.recycle();
 }
 
-bytestream tls_connection::read() { // TODO: refactor to allow messages of > 1024 bytes
-  std::vector<byte> buf;
-  buf.reserve(1024);
+bytestream tls_connection::read() {
   bytestream res;
-  if(auto got = SSL_read(ssl, buf.data(), 1023); got <= 0) {
-    connected = false;
-    dump_err(ssl, got);
-    throw tls_error("Can't read from SSL/TLS.");
-  }
-  else {
-    std::span subset(buf.begin(), got);
-    res.overwrite(subset);
-  }
+  read_into(res);
   return res;
 }
 
-void tls_connection::send(bytestream &strm) {
-  buffer = std::move(strm);
+bool tls_connection::read_into(bytestream &target) {
+  tracing::span span("SSL_read");
+  target.cleanse();
+  size_t total = 0;
+  do {
+    // a single TLS record carries at most 16 KiB of data; keep reading while OpenSSL holds more of the record
+    auto space = target.append_space(max_record_size);
+    auto got = SSL_read(ssl, space.data(), static_cast<int>(space.size()));
+    if(got <= 0) {
+      target.drop_tail(space.size());
+      if(total != 0) break;
+      connected = false;
+      dump_err(ssl, got);
+      throw tls_error("Can't read from SSL/TLS.");
+    }
+    target.drop_tail(space.size() - static_cast<size_t>(got));
+    total += static_cast<size_t>(got);
+  } while(SSL_pending(ssl) > 0);
+
+  const byte *src = target.read_start();
+  bool framed = target.size() >= length_header_size && src[0] == length_magic_1 && src[1] == length_magic_2;
+  if(framed) {
+    size_t length = 0;
+    for(size_t i = 0; i < 4; i++) length = (length << 8) | src[2 + i];
+    if(length > max_message_size()) throw tls_error("Can't read message (length frame too large).");
+    target.skip(length_header_size);
+    if(target.size() > length) throw tls_error("Can't read message (length frame too short).");
+
+    // the rest of the message follows in further records; a record never holds parts of two messages
+    auto space = target.append_space(length - target.size());
+    size_t filled = 0;
+    while(filled < space.size()) {
+      auto want = std::min(space.size() - filled, static_cast<size_t>(INT32_MAX));
+      auto got = SSL_read(ssl, space.data() + filled, static_cast<int>(want));
+      if(got <= 0) {
+        connected = false;
+        dump_err(ssl, got);
+        throw tls_error("Can't read from SSL/TLS (message cut off).");
+      }
+      filled += static_cast<size_t>(got);
+    }
+    total += filled;
+  }
+  statistics.bytes_in += total;
+  return framed;
+}
+
+bool tls_connection::wait_readable(int millidelay) const {
+  if(ssl == nullptr) return false;
+  if(SSL_pending(ssl) > 0) return true;
+  pollfd fd = { .fd = conn_handle, .events = POLLIN, .revents = 0 };
+  return poll(&fd, 1, millidelay) > 0 && fd.revents != 0;
+}
+
+timeval to_timeval(std::chrono::milliseconds ms) {
+  auto secs = std::chrono::duration_cast<std::chrono::seconds>(ms);
+  auto usecs = std::chrono::duration_cast<std::chrono::microseconds>(ms - secs);
+  return { .tv_sec = secs.count(), .tv_usec = usecs.count() };
+}
+
+void tls_connection::set_timeouts(std::chrono::milliseconds read, std::chrono::milliseconds write) const {
+  auto r = to_timeval(read);
+  auto w = to_timeval(write);
+  setsockopt(conn_handle, SOL_SOCKET, SO_RCVTIMEO, &r, sizeof(r));
+  setsockopt(conn_handle, SOL_SOCKET, SO_SNDTIMEO, &w, sizeof(w));
+}
+
+void tls_connection::interrupt() const {
+  if(ssl != nullptr) shutdown(conn_handle, SHUT_RD);
+}
+
+void tls_connection::send(bytestream &strm, bool framed) {
+  size_t size = strm.size();
+  if(!framed) {
+    // the other end reads a single record
+    if(size > max_record_size) throw tls_error("Can't send message (too large without a length frame).");
+    buffer.swap(strm);
+  }
+  else {
+    if(size > max_message_size()) throw tls_error("Can't send message (too large).");
+    buffer.cleanse();
+    auto *dst = buffer.append_space(length_header_size + size).data();
+    dst[0] = length_magic_1;
+    dst[1] = length_magic_2;
+    for(size_t i = 0; i < 4; i++) dst[2 + i] = static_cast<byte>(size >> (8 * (3 - i)));
+    std::memcpy(dst + length_header_size, strm.read_start(), size);
+    strm.cleanse();
+  }
   (*this) << end_of_msg{};
 }
 
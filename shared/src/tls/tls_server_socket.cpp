@@ -55,6 +55,19 @@ std::optional<tls_connection> tls_server_socket::accept_nonblock(int millidelay)
   return std::nullopt;
 }
 
+std::optional<tls_connection> tls_server_socket::accept_pending(int millidelay) const {
+  pollfd fd = { .fd = handle, .events = POLLIN, .revents = 0 };
+  if(auto res = poll(&fd, 1, millidelay); res <= 0 || (fd.revents & POLLIN) == 0) return std::nullopt;
+
+  sockaddr_in addr = {};
+  uint len = sizeof(addr);
+  int client = ::accept(handle, (sockaddr *)&addr, &len);
+  if(client < 0) {
+    throw socket_error("Unable to accept connection.");
+  }
+  return tls_connection(ctxt, client, true);
+}
+
 tls_server_socket::~tls_server_socket() {
   close(handle);
 }
\ No newline at end of file
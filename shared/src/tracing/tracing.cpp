@@ -0,0 +1,181 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tracing.cpp
+// Purpose:     Lightweight per-thread tracing spans (impl)
+// Author:      jay-tux
+// Created:     October 18, 2026 12:41 PM
+// Copyright:   (c) 2026 jay-tux
+// Licence:     MPL
+/////////////////////////////////////////////////////////////////////////////
+
+#include "tracing/tracing.hpp"
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+using namespace dotchat;
+using namespace dotchat::tracing;
+
+const static size_t ring_capacity = 1024;
+const static size_t detail_capacity = 47;
+const static size_t max_retired_rings = 32;
+
+struct span_record {
+  const char *name;
+  clock::time_point start;
+  clock::duration duration;
+  uint8_t detail_size;
+  std::array<char, detail_capacity> detail;
+};
+
+// the mutex is only ever contended while dumping; recording threads never wait on each other
+struct ring {
+  std::mutex lock;
+  std::array<span_record, ring_capacity> records;
+  size_t next = 0;
+  size_t count = 0;
+  uint32_t thread_id = 0;
+  bool retired = false;
+};
+
+struct ring_registry {
+  std::mutex lock;
+  std::list<std::shared_ptr<ring>> rings;
+  uint32_t next_id = 1;
+
+  std::shared_ptr<ring> create() {
+    auto res = std::make_shared<ring>();
+    std::unique_lock guard { lock };
+    res->thread_id = next_id++;
+
+    size_t retired = 0;
+    for(const auto &r: rings) if(r->retired) retired++;
+    for(auto it = rings.begin(); it != rings.end() && retired > max_retired_rings;) {
+      if((*it)->retired) { it = rings.erase(it); retired--; }
+      else ++it;
+    }
+
+    rings.push_back(res);
+    return res;
+  }
+};
+
+ring_registry &all_rings() {
+  static ring_registry reg;
+  return reg;
+}
+
+struct ring_owner {
+  std::shared_ptr<ring> owned = all_rings().create();
+
+  ~ring_owner() {
+    std::unique_lock guard { owned->lock };
+    owned->retired = true;
+  }
+};
+
+ring &local_ring() {
+  thread_local ring_owner owner;
+  return *owner.owned;
+}
+
+std::atomic<bool> &tracing::enabled() {
+  static std::atomic<bool> flag = true;
+  return flag;
+}
+
+void tracing::record(const char *name, clock::time_point start, clock::time_point end, std::string_view detail) {
+  ring &r = local_ring();
+  std::unique_lock guard { r.lock };
+  span_record &rec = r.records[r.next];
+  rec.name = name;
+  rec.start = start;
+  rec.duration = end - start;
+  rec.detail_size = static_cast<uint8_t>(std::min(detail.size(), detail_capacity));
+  if(rec.detail_size != 0) std::memcpy(rec.detail.data(), detail.data(), rec.detail_size);
+  r.next = (r.next + 1) % ring_capacity;
+  if(r.count < ring_capacity) r.count++;
+}
+
+void append_escaped(std::string &out, std::string_view str) {
+  for(char c: str) {
+    switch(c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+        break;
+    }
+  }
+}
+
+void append_micros(std::string &out, clock::duration d) {
+  std::array<char, 32> buf{};
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  int len = std::snprintf(buf.data(), buf.size(), "%lld.%03lld", (long long)(ns / 1000), (long long)(ns % 1000));
+  out.append(buf.data(), static_cast<size_t>(len));
+}
+
+std::string tracing::dump_chrome_json() {
+  std::vector<std::shared_ptr<ring>> rings;
+  {
+    std::unique_lock guard { all_rings().lock };
+    rings.assign(all_rings().rings.begin(), all_rings().rings.end());
+  }
+
+  std::string out = R"({"displayTimeUnit":"ns","traceEvents":[)";
+  bool first = true;
+  auto separate = [&first, &out]() {
+    if(!first) out += ',';
+    first = false;
+  };
+
+  std::vector<span_record> copy;
+  for(const auto &r: rings) {
+    uint32_t tid;
+    {
+      std::unique_lock guard { r->lock };
+      tid = r->thread_id;
+      copy.clear();
+      size_t begin = (r->next + ring_capacity - r->count) % ring_capacity;
+      for(size_t i = 0; i < r->count; i++) copy.push_back(r->records[(begin + i) % ring_capacity]);
+    }
+
+    separate();
+    out += R"({"name":"thread_name","ph":"M","pid":1,"tid":)" + std::to_string(tid) +
+           R"(,"args":{"name":"thread )" + std::to_string(tid) + R"("}})";
+
+    for(const auto &rec: copy) {
+      separate();
+      out += R"({"name":")";
+      append_escaped(out, rec.name);
+      out += R"(","ph":"X","pid":1,"tid":)" + std::to_string(tid) + R"(,"ts":)";
+      append_micros(out, rec.start.time_since_epoch());
+      out += R"(,"dur":)";
+      append_micros(out, rec.duration);
+      if(rec.detail_size != 0) {
+        out += R"(,"args":{"detail":")";
+        append_escaped(out, std::string_view(rec.detail.data(), rec.detail_size));
+        out += R"("})";
+      }
+      out += '}';
+    }
+  }
+
+  out += "]}";
+  return out;
+}
+
+bool tracing::dump_to_file(const std::string &path) {
+  std::ofstream strm(path, std::ios::trunc);
+  if(!strm) return false;
+  strm << dump_chrome_json();
+  return static_cast<bool>(strm);
+}
\ No newline at end of file